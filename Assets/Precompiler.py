@@ -1,13 +1,21 @@
+import argparse
 import os
 import subprocess
 
-compiler_path = "C:\\VulkanSDK\\1.3.280.0\\Bin\\glslc.exe"
+# meson compile runs this with the glslc it found, see the root meson.build
+parser = argparse.ArgumentParser(description="Compiles the shaders in Shaders into PrecompiledShaders")
+parser.add_argument("--compiler", default=os.path.join(os.environ.get("VULKAN_SDK", ""), "Bin", "glslc"), help="path to glslc")
+parser.add_argument("--stamp", help="file touched after a successful run, the output of the meson target")
+arguments = parser.parse_args()
+
+compiler_path = arguments.compiler
 compiled_shader_postfix = ".spv"
 
 # Function to compile shader files
 def compile_shader(shader_file, compiled_shader_output):
     # Replace this command with your actual shell command for compiling shaders
-    compile_command = f"\"{compiler_path}\" \"{shader_file}\" -o \"{compiled_shader_output}\""
+    # subgroup operations need SPIR-V 1.3+, the device is created with Vulkan 1.2
+    compile_command = f"\"{compiler_path}\" --target-env=vulkan1.2 \"{shader_file}\" -o \"{compiled_shader_output}\""
     print("Start compiling shader: " + shader_file)
     result = subprocess.Popen(compile_command, shell=True, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
     std_out, std_err = result.communicate()
@@ -22,6 +30,18 @@ shaders_folder = os.path.join(os.path.dirname(__file__), "Shaders")
 
 # Path to the PrecompiledShaders folder
 precompiled_folder = os.path.join(os.path.dirname(__file__), "PrecompiledShaders")
+os.makedirs(precompiled_folder, exist_ok=True)
+
+# Shaders include .glsl files from the whole tree, a change to any of them recompiles every shader
+def newest_include_mtime(folder_path):
+    newest = 0.0
+    for root, _, files in os.walk(folder_path):
+        for file in files:
+            if os.path.splitext(file)[1] == '.glsl':
+                newest = max(newest, os.path.getmtime(os.path.join(root, file)))
+    return newest
+
+include_mtime = newest_include_mtime(shaders_folder)
 
 def compile_shaders_in_folder(folder_path):
     for shader_file in os.listdir(folder_path):
@@ -40,10 +60,10 @@ def compile_shaders_in_folder(folder_path):
         # Check if the shader file exists in PrecompiledShaders folder
         if os.path.exists(precompiled_shader_path):
             # Compare modification times
-            shader_mtime = os.path.getmtime(shader_path)
+            shader_mtime = max(os.path.getmtime(shader_path), include_mtime)
             precompiled_mtime = os.path.getmtime(precompiled_shader_path)
 
-            # If shader file is newer than precompiled shader, compile it
+            # If shader file or an include is newer than precompiled shader, compile it
             if shader_mtime > precompiled_mtime:
                 compile_shader(shader_path, precompiled_shader_path)
                 print(f"Compiled {shader_file}")
@@ -56,4 +76,8 @@ def compile_shaders_in_folder(folder_path):
 
 
 compile_shaders_in_folder(shaders_folder)
-print("Compilation complete")
\ No newline at end of file
+print("Compilation complete")
+
+if arguments.stamp:
+    with open(arguments.stamp, "w") as stamp:
+        stamp.write("")
\ No newline at end of file
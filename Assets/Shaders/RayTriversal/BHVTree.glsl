@@ -3,6 +3,7 @@
 
 #include "Common.glsl"
 #include "../RenderPass/VertexInput.glsl"
+#include "../RenderPass/Specialization.glsl"
 
 //Requiers BHVNodes binding 5
 
@@ -34,7 +35,7 @@ bool hitBHVTree(uint nodeIndex, ray ray, float tMin, inout float tMax, inout Hit
         return false;
     }
 
-    uint nodeQueue[64];
+    uint nodeQueue[MAX_STACK_DEPTH];
     nodeQueue[0] = nodeIndex;
     uint quelenght = 1;
 
@@ -43,6 +44,7 @@ bool hitBHVTree(uint nodeIndex, ray ray, float tMin, inout float tMax, inout Hit
         root = nodes[nodeQueue[quelenght - 1]];
         rootAABB = AABB(root.aabbMin, root.aabbMax);
         quelenght--;
+        CountNodeVisit();
 
         if (!hitAABB(rootAABB, ray, bhvTMin, bhvTMax) || bhvTMin > tMax) 
         {
@@ -90,9 +92,50 @@ bool hitBHVTree(uint nodeIndex, ray ray, float tMin, inout float tMax, inout Hit
     return hit;
 }
 
+// Any hit traversal: returns on the first triangle in [tMin, tMax]. Children are pushed in node order,
+// the distance ordering of hitBHVTree only pays off when the closest hit shrinks tMax
+bool occludedBHVTree(uint nodeIndex, ray ray, float tMin, float tMax)
+{
+    uint nodeQueue[MAX_STACK_DEPTH];
+    nodeQueue[0] = nodeIndex;
+    uint quelenght = 1;
+
+    while(quelenght > 0)
+    {
+        BHVNode node = nodes[nodeQueue[--quelenght]];
+        CountNodeVisit();
+
+        float nodeTStart = 0;
+        float nodeTEnd = 0;
+        if (!hitAABB(AABB(node.aabbMin, node.aabbMax), ray, nodeTStart, nodeTEnd) || nodeTStart > tMax) 
+            continue;
+
+        if (node.indeciesCount > 0) 
+        {
+            for(int i = 0; i < node.indeciesCount; i+= 3)
+            {
+                if (occludedTriangle(node.nextIndex + i, ray, tMin, tMax))
+                    return true;
+            }
+
+            continue;
+        }
+
+        nodeQueue[quelenght++] = node.nextIndex + 1;
+        nodeQueue[quelenght++] = node.nextIndex;
+    }
+
+    return false;
+}
+
 bool TreverseScene(ray ray, float tMin, inout float tMax, inout HitResult hitResult) 
 {
     return hitBHVTree(0, ray, tMin, tMax, hitResult);
 }
 
+bool Occluded(ray ray, float tMin, float tMax)
+{
+    return occludedBHVTree(0, ray, tMin, tMax);
+}
+
 #endif // BHV_TREE_H
\ No newline at end of file
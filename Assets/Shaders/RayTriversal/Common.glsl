@@ -2,6 +2,7 @@
 #define COMMON_H
 
 #include "../RenderPass/VertexInput.glsl"
+#include "TraversalStats.glsl"
 
 struct AABB {
     vec3 aabbMin;
@@ -67,6 +68,8 @@ bool hitSphere(sphere sphere, ray ray, float tMin, inout float tMax, inout HitRe
 
 bool hitTriangle(triangle tri, ray ray, float tMin, inout float tMax, inout HitResult hitResult) 
 {
+    CountTriangleTest();
+
     vec3 v0v1 = tri.v1 - tri.v0;
     vec3 v0v2 = tri.v2 - tri.v0;
     vec3 pVec = cross(ray.direction, v0v2);
@@ -103,11 +106,56 @@ bool hitTriangle(triangle tri, ray ray, float tMin, inout float tMax, inout HitR
     return true;
 }
 
+// Any hit variant of hitTriangle, only fetches the positions and fills no HitResult
+bool occludedTriangle(uint startIndex, ray ray, float tMin, float tMax)
+{
+    CountTriangleTest();
+
+    vec3 v0, v1, v2;
+    getTrianglePositions(startIndex, v0, v1, v2);
+
+    vec3 v0v1 = v1 - v0;
+    vec3 v0v2 = v2 - v0;
+    vec3 pVec = cross(ray.direction, v0v2);
+    float det = dot(v0v1, pVec);
+    if(abs(det) < epsilon) 
+        return false;
+
+    float invDet = 1 / det;
+    vec3 tVec = ray.origin - v0;
+    float u = dot(tVec, pVec) * invDet;
+    vec3 qVec = cross(tVec, v0v1);
+    float v = dot(ray.direction, qVec) * invDet;
+    if(u < 0.0 || v < 0.0 || (u + v) > 1.0) 
+        return false;
+
+    float t = dot(v0v2, qVec) * invDet;
+    return t >= tMin && t <= tMax;
+}
+
+bool occludedSphere(sphere sphere, ray ray, float tMin, float tMax)
+{
+    vec3 origin = sphere.center - ray.origin;
+    float a = dot(ray.direction, ray.direction);
+    float h = dot(origin, ray.direction);
+    float c = dot(origin, origin) - sphere.radius * sphere.radius;
+
+    float discriminant = h * h - a * c;
+    if(discriminant < 0) 
+        return false;
+
+    float sqrtDiscriminant = sqrt(discriminant);
+    float t0 = (h - sqrtDiscriminant) / a;
+    float t1 = (h + sqrtDiscriminant) / a;
+    return (t0 >= tMin && t0 <= tMax) || (t1 >= tMin && t1 <= tMax);
+}
+
 bool hitAABB(AABB aabb, ray ray, inout float tStart, inout float tEnd) 
 {
     // if(ray.direction.x == 0 && (ray.origin.x < aabb.aabbMin.x || ray.origin.x > aabb.aabbMax.x)) return false;
     // if(ray.direction.y == 0 && (ray.origin.y < aabb.aabbMin.y || ray.origin.y > aabb.aabbMax.y)) return false;
     // if(ray.direction.z == 0 && (ray.origin.z < aabb.aabbMin.z || ray.origin.z > aabb.aabbMax.z)) return false;
+    CountAabbTest();
 
     vec3 t0 = (aabb.aabbMin - ray.origin) * ray.invDirection;
     vec3 t1 = (aabb.aabbMax - ray.origin) * ray.invDirection;
@@ -4,6 +4,7 @@
 #include "Common.glsl"
 #include "../RenderPass/VertexInput.glsl"
 #include "../RenderPass/SceneData.glsl"
+#include "../RenderPass/Specialization.glsl"
 
 //Requiers KdNodes binding 5
 
@@ -38,7 +39,7 @@ bool hitKdTree(uint nodeIndex, ray ray, float tMin, inout float tMax, inout HitR
     if(tStart > tMax)
         return false;
 
-    KdNodeProcess nodeQueue[64];
+    KdNodeProcess nodeQueue[MAX_STACK_DEPTH];
     nodeQueue[0] = KdNodeProcess(nodeIndex, tStart, tEnd);
     uint quelenght = 1;
 
@@ -56,6 +57,8 @@ bool hitKdTree(uint nodeIndex, ray ray, float tMin, inout float tMax, inout HitR
         if(tStart > tMax)
             break;
 
+        CountNodeVisit();
+
         if (node.indeciesCount > 0) {
             for(int i = 0; i < node.indeciesCount; i+= 3)
             {
@@ -96,9 +99,74 @@ bool hitKdTree(uint nodeIndex, ray ray, float tMin, inout float tMax, inout HitR
     return hit;
 }
 
+// Any hit traversal: returns on the first triangle in [tMin, tMax]. Triangles overlapping several leaves
+// may be hit outside the current leaf, that is still an occluder so no leaf interval check is needed
+bool occludedKdTree(uint nodeIndex, ray ray, float tMin, float tMax) 
+{
+    float tStart = tMin;
+    float tEnd = tMax;
+
+    AABB rootAABB = AABB(sceneData.aabbMin, sceneData.aabbMax);
+    if(!hitAABB(rootAABB, ray, tStart, tEnd) || tStart > tMax) 
+        return false;
+
+    KdNodeProcess nodeQueue[MAX_STACK_DEPTH];
+    nodeQueue[0] = KdNodeProcess(nodeIndex, tStart, tEnd);
+    uint quelenght = 1;
+
+    while(quelenght > 0)
+    {
+        KdNodeProcess currentProcess = nodeQueue[--quelenght];
+        KdNode node = nodes[currentProcess.nodeIndex];
+        tStart = currentProcess.tStart;
+        tEnd = min(currentProcess.tEnd, tMax);
+        if(tStart > tEnd)
+            continue;
+
+        CountNodeVisit();
+
+        if (node.indeciesCount > 0) 
+        {
+            for(int i = 0; i < node.indeciesCount; i+= 3)
+            {
+                if (occludedTriangle(node.nextIndex + i, ray, tMin, tMax))
+                    return true;
+            }
+
+            continue;
+        }
+
+        float t = (node.split - ray.origin[node.flags]) * ray.invDirection[node.flags];
+        bool leftToRightOrder = (ray.origin[node.flags] < node.split) || (ray.origin[node.flags] == node.split && ray.direction[node.flags] <= 0);
+        uint nearChild = leftToRightOrder ? node.nextIndex : node.nextIndex + 1;
+        uint farChild = leftToRightOrder ? node.nextIndex + 1 : node.nextIndex;
+
+        if(t > tEnd || t <= 0)
+        {
+            nodeQueue[quelenght++] = KdNodeProcess(nearChild, tStart, tEnd);
+        }
+        else if(t < tStart)
+        {
+            nodeQueue[quelenght++] = KdNodeProcess(farChild, tStart, tEnd);
+        }
+        else
+        {
+            nodeQueue[quelenght++] = KdNodeProcess(farChild, t, tEnd);
+            nodeQueue[quelenght++] = KdNodeProcess(nearChild, tStart, t);
+        }
+    }
+
+    return false;
+}
+
 bool TreverseScene(ray ray, float tMin, inout float tMax, inout HitResult hitResult) 
 {
     return hitKdTree(0, ray, tMin, tMax, hitResult);
 }
 
+bool Occluded(ray ray, float tMin, float tMax)
+{
+    return occludedKdTree(0, ray, tMin, tMax);
+}
+
 #endif //KD_TREE_H
\ No newline at end of file
@@ -28,4 +28,21 @@ bool TreverseScene(ray ray, float tMin, inout float tMax, inout HitResult hitRes
     return hit;
 }
 
+bool Occluded(ray ray, float tMin, float tMax)
+{
+    float tStart = tMin;
+    float tEnd = tMax;
+    AABB rootAABB = AABB(sceneData.aabbMin, sceneData.aabbMax);
+    if(!hitAABB(rootAABB, ray, tStart, tEnd) || tStart > tMax) 
+        return false;
+
+    for(int i = 0; i < indecies.length(); i+= 3)
+    {
+        if (occludedTriangle(i, ray, tMin, tMax))
+            return true;
+    }
+
+    return false;
+}
+
 #endif // SIMPLE_LOOP_H
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef TRAVERSAL_STATS_H
+#define TRAVERSAL_STATS_H
+
+#include "../RenderPass/Specialization.glsl"
+
+// Traversal cost of the current pixel summed over all samples and bounces.
+// TRAVERSAL_STATS is a specialization constant, the counting is removed from regular permutations.
+uint gNodeVisits = 0;
+uint gAabbTests = 0;
+uint gTriangleTests = 0;
+
+void CountNodeVisit()
+{
+    if(TRAVERSAL_STATS != 0)
+        gNodeVisits++;
+}
+
+void CountAabbTest()
+{
+    if(TRAVERSAL_STATS != 0)
+        gAabbTests++;
+}
+
+void CountTriangleTest()
+{
+    if(TRAVERSAL_STATS != 0)
+        gTriangleTests++;
+}
+
+#endif // TRAVERSAL_STATS_H
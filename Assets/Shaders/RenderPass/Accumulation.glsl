@@ -0,0 +1,84 @@
+#ifndef ACCUMULATION_H
+#define ACCUMULATION_H
+
+// Accumulation storage of the ray tracing pass, selected by ACCUMULATION_FORMAT of Specialization.glsl.
+// 0 keeps the sums of the frames in rgba32f.
+// 1 keeps their running mean in rgba16f, which stays in half range where long sums would not, and stores the rounding error
+// of every store in an rgba8_snorm compensation image. The next frame adds it back before accumulating, Kahan summation across frames.
+// Both formats hold rgb color and the squared frame luminance in alpha. Must match Accumulation.hpp on the host side
+
+#include "../Utils/random.glsl"
+
+layout(binding = 1, rgba32f) uniform image2D accumulationTexture;
+layout(binding = 23, rgba16f) uniform image2D halfAccumulationImage;
+// rounding error of halfAccumulationImage in units of its half precision ulp
+layout(binding = 24, rgba8_snorm) uniform image2D accumulationCompensationImage;
+
+// accumulated frames of each pixel, the accumulation of a pixel is reprojected together with its count
+layout(binding = 19, r32ui) uniform uimage2D accumulationCountImage;
+// copies of the accumulation images of the previous frame, written before frames with camera motion
+layout(binding = 20, rgba32f) uniform readonly image2D previousAccumulationImage;
+layout(binding = 22, r32ui) uniform readonly uimage2D previousAccumulationCountImage;
+layout(binding = 25, rgba16f) uniform readonly image2D previousHalfAccumulationImage;
+layout(binding = 26, rgba8_snorm) uniform readonly image2D previousAccumulationCompensationImage;
+
+#define ACCUMULATION_FORMAT_FLOAT32 0
+#define ACCUMULATION_FORMAT_HALF_COMPENSATED 1
+
+#define HALF_MIN_NORMAL 6.103515625e-5
+#define HALF_MAX 65504.0
+
+// Distance to the next half float, the subnormal spacing below the normal range
+vec4 GetHalfUlp(vec4 value)
+{
+    return exp2(floor(log2(max(abs(value), vec4(HALF_MIN_NORMAL)))) - 10.0);
+}
+
+vec4 RoundToHalf(vec4 value)
+{
+    return vec4(unpackHalf2x16(packHalf2x16(value.xy)), unpackHalf2x16(packHalf2x16(value.zw)));
+}
+
+vec4 DecodeCompensatedMean(vec4 mean, vec4 compensation)
+{
+    return mean + compensation * GetHalfUlp(mean);
+}
+
+// Sums of the frameCount frames accumulated into the pixel
+vec4 LoadAccumulation(ivec2 coord, uint frameCount)
+{
+    if(ACCUMULATION_FORMAT == ACCUMULATION_FORMAT_FLOAT32)
+        return imageLoad(accumulationTexture, coord);
+
+    return DecodeCompensatedMean(imageLoad(halfAccumulationImage, coord), imageLoad(accumulationCompensationImage, coord)) * float(frameCount);
+}
+
+vec4 LoadPreviousAccumulation(ivec2 coord, uint frameCount)
+{
+    if(ACCUMULATION_FORMAT == ACCUMULATION_FORMAT_FLOAT32)
+        return imageLoad(previousAccumulationImage, coord);
+
+    return DecodeCompensatedMean(imageLoad(previousHalfAccumulationImage, coord), imageLoad(previousAccumulationCompensationImage, coord)) * float(frameCount);
+}
+
+void StoreAccumulation(ivec2 coord, vec4 accumulated, uint frameCount)
+{
+    if(ACCUMULATION_FORMAT == ACCUMULATION_FORMAT_FLOAT32)
+    {
+        imageStore(accumulationTexture, coord, accumulated);
+        return;
+    }
+
+    //the mean is rounded here so the image store is exact and the compensation holds the whole error
+    vec4 mean = min(accumulated / float(frameCount), vec4(HALF_MAX));
+    vec4 storedMean = RoundToHalf(mean);
+    imageStore(halfAccumulationImage, coord, storedMean);
+
+    //increments of long accumulations are smaller than the snorm steps, rounding them to nearest would drop them every frame.
+    //Dithered rounding keeps the compensation unbiased
+    vec4 compensation = clamp((mean - storedMean) / GetHalfUlp(storedMean), -1.0, 1.0);
+    vec4 dither = vec4(hash3(), hash1());
+    imageStore(accumulationCompensationImage, coord, floor(compensation * 127.0 + dither) / 127.0);
+}
+
+#endif // ACCUMULATION_H
@@ -0,0 +1,30 @@
+#ifndef ADAPTIVE_SAMPLING_H
+#define ADAPTIVE_SAMPLING_H
+
+// Tiles are the workgroups of the ray tracing pass. Converged tiles are left out of the indirect dispatch
+// that AdaptiveTiles.comp writes, until the accumulation restarts.
+
+#define TILE_CONVERGED_BIT 0x80000000u
+
+layout(binding = 10, std430) buffer AdaptiveTileStates{
+    // indirect dispatch of the ray tracing pass, x is the active tile count
+    uvec4 dispatchArgs;
+    // accumulated frames of the tile, TILE_CONVERGED_BIT once its error is below the threshold
+    uint tileStates[];
+};
+
+layout(binding = 11, std430) buffer AdaptiveActiveTiles{
+    uint activeTiles[];
+};
+
+uint GetTileFrameCount(uint tileState)
+{
+    return tileState & ~TILE_CONVERGED_BIT;
+}
+
+bool IsTileConverged(uint tileState)
+{
+    return (tileState & TILE_CONVERGED_BIT) != 0;
+}
+
+#endif // ADAPTIVE_SAMPLING_H
@@ -0,0 +1,67 @@
+#ifndef DENOISE_H
+#define DENOISE_H
+
+// Edge-aware a-trous wavelet filter, "Edge-Avoiding A-Trous Wavelet Transform for fast Global Illumination Filtering" (Dammertz et al. 2010),
+// with the variance guided luminance weight of SVGF (Schied et al. 2017).
+// The ray tracing pass writes the G-buffer and the noisy frame, DenoiseAtrous.comp filters the illumination without the albedo
+// and DenoiseResolve.comp blends the result with the reprojected previous frame.
+// Constants must match Denoiser.hpp on the host side
+
+#include "SceneData.glsl"
+#include "../Utils/color.glsl"
+
+// xyz first hit normal, w hit distance along the camera ray, 0 for the sky
+layout(binding = 12, rgba32f) uniform image2D gBufferImage;
+// first hit albedo, white for the sky
+layout(binding = 13, rgba8) uniform image2D albedoImage;
+// rgb frame color, a variance of its mean luminance. Negative for pixels with fewer than DENOISE_TEMPORAL_VARIANCE_FRAMES frames,
+// their frame counts differ once the accumulation is reprojected
+layout(binding = 14, rgba16f) uniform image2D denoiseInputImage;
+// iterations alternate between the two, rgb illumination, a its variance
+layout(binding = 15, rgba16f) uniform image2D denoisePingImage;
+layout(binding = 16, rgba16f) uniform image2D denoisePongImage;
+// rgb stabilized color, a hit distance. Written for this frame slot, the history of the previous slot is read
+layout(binding = 17, rgba16f) uniform image2D denoiseHistoryImage;
+layout(binding = 18, rgba16f) uniform image2D previousHistoryImage;
+
+layout(push_constant) uniform DenoisePushConstants{
+    // the a-trous step is 1 << iteration
+    uint iteration;
+    uint iterationCount;
+    // 0 when the previous history image does not hold the previous frame
+    uint historyValid;
+} denoisePass;
+
+#define DENOISE_SIGMA_NORMAL 128.0
+#define DENOISE_SIGMA_DEPTH 0.02
+#define DENOISE_SIGMA_LUMINANCE 4.0
+// dark albedo would blow up the demodulated noise
+#define DENOISE_MIN_ALBEDO 0.01
+// fewer accumulated frames estimate the variance from the neighbourhood
+#define DENOISE_TEMPORAL_VARIANCE_FRAMES 4
+#define DENOISE_HISTORY_WEIGHT 0.8
+#define DENOISE_HISTORY_DEPTH_TOLERANCE 0.05
+
+vec3 DemodulateAlbedo(vec3 color, vec3 albedo)
+{
+    return color / max(albedo, vec3(DENOISE_MIN_ALBEDO));
+}
+
+vec3 RemodulateAlbedo(vec3 illumination, vec3 albedo)
+{
+    return illumination * max(albedo, vec3(DENOISE_MIN_ALBEDO));
+}
+
+// Edge stopping weight of a filter tap, center is a surface. Sky and surfaces never mix
+float DenoiseEdgeWeight(vec4 centerGBuffer, vec4 sampleGBuffer, float centerLuminance, float sampleLuminance, float luminanceScale, float step)
+{
+    if(sampleGBuffer.w == 0.0)
+        return 0.0;
+
+    float normalWeight = pow(max(dot(centerGBuffer.xyz, sampleGBuffer.xyz), 0.0), DENOISE_SIGMA_NORMAL);
+    float depthWeight = exp(-abs(centerGBuffer.w - sampleGBuffer.w) / (DENOISE_SIGMA_DEPTH * centerGBuffer.w * step + 1e-4));
+    float luminanceWeight = exp(-abs(centerLuminance - sampleLuminance) / luminanceScale);
+    return normalWeight * depthWeight * luminanceWeight;
+}
+
+#endif // DENOISE_H
@@ -0,0 +1,51 @@
+#ifndef LIGHT_SAMPLING_H
+#define LIGHT_SAMPLING_H
+
+#include "../Utils/constants.glsl"
+#include "../Utils/color.glsl"
+#include "SceneData.glsl"
+
+// Radiance of the sky gradient seen in direction
+vec3 SkyRadiance(vec3 direction)
+{
+    float a = 0.5 * (normalize(direction).y + 1.0);
+    return (1.0 - a * vec3(1) + a * sceneData.color);
+}
+
+// The sky luminance is linear in the direction y, so its pdf is (1 + k * y) / 4pi.
+// k is clamped so directions with a black sky keep a non zero pdf
+float SkyPdfSlope()
+{
+    float zenith = Luminance(sceneData.color);
+    return clamp((zenith - 1.0) / (zenith + 1.0), -0.95, 0.95);
+}
+
+// Solid angle pdf of SampleSky, direction is normalized
+float SkyPdf(vec3 direction)
+{
+    return (1.0 + SkyPdfSlope() * direction.y) / (4.0 * PI);
+}
+
+// Samples a direction proportional to the sky luminance by inverting the quadratic cdf of y
+vec3 SampleSky(vec2 u, out float pdf)
+{
+    float k = SkyPdfSlope();
+    //stable root of k * y^2 + 2 * y + c = 0, exact for k = 0 too
+    float c = 2.0 - k - 4.0 * u.x;
+    float y = clamp(-c / (1.0 + sqrt(max(1.0 - k * c, 0.0))), -1.0, 1.0);
+    float r = sqrt(max(0.0, 1.0 - y * y));
+    float phi = 2.0 * PI * u.y;
+
+    pdf = (1.0 + k * y) / (4.0 * PI);
+    return vec3(r * cos(phi), y, r * sin(phi));
+}
+
+// Multiple importance sampling weight of the strategy with pdfA, "Optimally Combining Sampling Techniques" (Veach 1995)
+float PowerHeuristic(float pdfA, float pdfB)
+{
+    float a = pdfA * pdfA;
+    float b = pdfB * pdfB;
+    return a / max(a + b, 1e-20);
+}
+
+#endif // LIGHT_SAMPLING_H
@@ -1,11 +1,26 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "SceneData.glsl"
+#include "../Utils/color.glsl"
 
 layout (location = 0) in vec2 inUV;
 
 layout (location = 0) out vec4 outColor;
 
 layout(binding = 0) uniform sampler2D texSampler;
+//Written by the ray tracing pass while a heatmap view is active
+layout(binding = 1, rgba32ui) uniform readonly uimage2D traversalStats;
 
 void main() {
-    outColor = texture(texSampler, inUV);
-}
\ No newline at end of file
+    if(sceneData.debugView == DEBUG_VIEW_SHADED)
+    {
+        outColor = texture(texSampler, inUV);
+        return;
+    }
+
+    ivec2 size = imageSize(traversalStats);
+    ivec2 coord = min(ivec2(inUV * size), size - 1);
+    uint count = imageLoad(traversalStats, coord)[sceneData.debugView - 1];
+    outColor = vec4(HeatmapColor(count / sceneData.heatmapMax), 1);
+}
@@ -3,6 +3,13 @@
 #include "../Utils/color.glsl"
 #include "VertexInput.glsl"
 #include "SceneData.glsl"
+#include "Specialization.glsl"
+#include "Sampler.glsl"
+#include "AdaptiveSampling.glsl"
+#include "LightSampling.glsl"
+#include "Denoise.glsl"
+#include "Reprojection.glsl"
+#include "Accumulation.glsl"
 
 #if defined(USE_BVH)
 #include "../RayTriversal/BHVTree.glsl"
@@ -12,11 +19,8 @@
 #include "../RayTriversal/SimpleLoop.glsl"
 #endif
 
-layout (local_size_x = 32, local_size_y = 32, local_size_z = 1) in;
-
 //Ray tracing results
 layout(binding = 0, rgba8) uniform writeonly image2D resultImage;
-layout(binding = 1, rgba32f) uniform image2D accumulationTexture;
 
 struct Material
 {
@@ -28,6 +32,28 @@ layout(binding = 6, std140) readonly buffer MaterialsBuffer{
     Material materials[];
 };
 
+//Rays traced this frame, reset by the host before every dispatch
+layout(binding = 7, std430) buffer RayCounter{
+    uint rayCount;
+};
+
+//Per pixel traversal cost: nodes, AABB tests, triangle tests, rays. Only written by TRAVERSAL_STATS permutations
+layout(binding = 8, rgba32ui) uniform writeonly uimage2D traversalStatsImage;
+
+uint gRayCount = 0;
+
+// first hit of the last traced sample, written to the G-buffer of the denoiser and the reprojection
+vec3 gFirstHitNormal = vec3(0);
+float gFirstHitDistance = 0.0;
+vec3 gFirstHitAlbedo = vec3(1);
+
+// Analytic spheres traced next to the scene mesh
+const sphere spheres[1] = sphere[1](
+    sphere(vec3(0,-100.5, -1), 100, 0)
+    // sphere(vec3(1.8, 0.0, -0.1), 0.5, 0),
+    // sphere(vec3(-1.8, 0.0, -0.1), 0.5, 2)
+);
+
 vec3 ray_refract(vec3 rayDirection, vec3 surfaceNormal, float etai_over_etat) {
     float cos_theta = min(dot(-rayDirection, surfaceNormal), 1.0);
     vec3 r_out_parallel = etai_over_etat * (rayDirection + cos_theta * surfaceNormal);
@@ -42,13 +68,19 @@ float reflectance(float cosine, float refraction_index) {
     return r0 + (1.0-r0)*pow((1.0 - cosine),5);
 }
 
-void Scater(HitResult hit, inout ray ray, inout vec3 attenuation)
+// With fuzz 1 Scater samples the normal plus a unit sphere direction, a cosine distribution with pdf cos / pi.
+// That is the only material with a known pdf, so light sampling is limited to it
+bool IsDiffuse(Material material)
+{
+    return material.fuzz == 1.0;
+}
+
+void Scater(HitResult hit, Material material, inout ray ray, inout vec3 attenuation)
 {
-    Material material = materials[hit.materialFlag];
     attenuation *= material.albedo;
     ray.origin = hit.hitPoint + hit.normal * 0.01;
     vec3 reflected = material.fuzz < 1 ? normalize(reflect(ray.direction, hit.normal)) : hit.normal;
-    ray.direction = reflected + material.fuzz * randomUnitVector();
+    ray.direction = reflected + material.fuzz * SampleUnitSphere(Sample2D());
     if(dot(ray.direction, hit.normal) < 0.0001) 
         ray.direction = hit.normal;
     
@@ -95,9 +127,47 @@ void Scater(HitResult hit, inout ray ray, inout vec3 attenuation)
     // }
 }
 
+// Survival probability proportional to the path throughput. The lower bound keeps the weight of survivors finite,
+// must match GetRouletteSurvivalProbability on the host side
+float RouletteSurvivalProbability(vec3 throughput)
+{
+    return clamp(max(throughput.r, max(throughput.g, throughput.b)), 0.05, 1.0);
+}
+
+bool SceneOccluded(ray shadowRay)
+{
+    const float tMin = 0.001;
+    for(int i = 0; i < spheres.length(); i++)
+    {
+        if(occludedSphere(spheres[i], shadowRay, tMin, infinity))
+            return true;
+    }
+
+    return Occluded(shadowRay, tMin, infinity);
+}
+
+// Sky light reaching a diffuse hit through one shadow ray, weighted against BSDF sampling.
+// Returns radiance * cosine / pi / pdf, the lambertian BRDF without the albedo
+vec3 SampleSkyLight(HitResult hit)
+{
+    float lightPdf;
+    vec3 direction = SampleSky(Sample2D(), lightPdf);
+    float cosine = dot(direction, hit.normal);
+    if(cosine <= 0.0)
+        return vec3(0);
+
+    gRayCount++;
+    ray shadowRay = ray(hit.hitPoint + hit.normal * 0.01, direction, 1.0 / direction);
+    if(SceneOccluded(shadowRay))
+        return vec3(0);
+
+    float bsdfPdf = cosine / PI;
+    return SkyRadiance(direction) * bsdfPdf / lightPdf * PowerHeuristic(lightPdf, bsdfPdf);
+}
+
 vec3 DefocusDiscSample()
 {
-    return inUnitDisk() * vec3(sceneData.defoucsDiskU, sceneData.defoucsDiskV, 0.0);
+    return SampleUnitDisk(Sample2D()) * vec3(sceneData.defoucsDiskU, sceneData.defoucsDiskV, 0.0);
 }
 
 vec3 GetRayDirection(vec2 screenCord)
@@ -109,20 +179,16 @@ vec3 GetRayDirection(vec2 screenCord)
 
 vec3 TraceRay(ray ray)
 {
-    sphere spheres[1];
-
-    spheres[0] = sphere(vec3(0,-100.5, -1), 100, 0);
-    // spheres[1] = sphere(vec3(1.8, 0.0, -0.1), 0.5, 0);
-    // spheres[2] = sphere(vec3(-1.8, 0.0, -0.1), 0.5, 2);
-    
-    
-    uint maxBounces = sceneData.maxBounces;
+    uint maxBounces = MAX_BOUNCES > 0 ? MAX_BOUNCES : sceneData.maxBounces;
 
     vec3 finalColor = vec3(0);
     vec3 color = vec3(1);
+    //solid angle pdf of the last bounce if the sky it reaches was also light sampled, 0 otherwise
+    float bsdfPdf = 0.0;
         
     for(int d = 0; d < maxBounces; d++) 
     {
+        gRayCount++;
         const float tMin = 0.001;
         float tMax = infinity;
 
@@ -146,16 +212,40 @@ vec3 TraceRay(ray ray)
             closestHit = currentHit;
         }
 
+        if(d == 0)
+        {
+            gFirstHitNormal = hit ? closestHit.normal : vec3(0);
+            gFirstHitDistance = hit ? closestHit.hitDistance : 0.0;
+            gFirstHitAlbedo = hit ? materials[closestHit.materialFlag].albedo : vec3(1);
+        }
+
         if (hit) 
         {
-            Scater(closestHit, ray, color);
+            Material material = materials[closestHit.materialFlag];
+            //the last bounce has no BSDF continuation to share the sky with, the MIS weights need both strategies
+            bool lightSampled = NEXT_EVENT_ESTIMATION != 0 && IsDiffuse(material) && d + 1 < maxBounces;
+            if(lightSampled)
+            {
+                finalColor += color * material.albedo * SampleSkyLight(closestHit);
+            }
+
+            Scater(closestHit, material, ray, color);
+            bsdfPdf = lightSampled ? max(dot(normalize(ray.direction), closestHit.normal), 0.0) / PI : 0.0;
+
+            //terminated paths contribute nothing, survivors are weighted up by the inverse probability so the estimate stays unbiased
+            if(sceneData.rouletteMinBounce != 0 && d + 1 >= sceneData.rouletteMinBounce)
+            {
+                float survival = RouletteSurvivalProbability(color);
+                if(hash1() >= survival)
+                    break;
+                color /= survival;
+            }
         }
         else 
         {
             vec3 unitDir = normalize(ray.direction);
-            float a = 0.5 * (unitDir.y + 1.0);
-            vec3 skyColor =  (1.0 - a * vec3(1) + a * sceneData.color);
-            finalColor = color * skyColor;
+            float weight = bsdfPdf > 0.0 ? PowerHeuristic(bsdfPdf, SkyPdf(unitDir)) : 1.0;
+            finalColor += color * SkyRadiance(unitDir) * weight;
             break;
         }        
     }
@@ -163,18 +253,78 @@ vec3 TraceRay(ray ray)
 }
 
 
-void main() 
+// Tile of this workgroup, the adaptive indirect dispatch only launches the active tiles
+uvec2 GetWorkgroupTile(out uint tileIndex)
+{
+    if(ADAPTIVE_SAMPLING == 0)
+    {
+        tileIndex = 0;
+        return gl_WorkGroupID.xy;
+    }
+
+    tileIndex = activeTiles[gl_WorkGroupID.x];
+    return uvec2(tileIndex % sceneData.adaptiveTileCountX, tileIndex / sceneData.adaptiveTileCountX);
+}
+
+// Standard error of the mean luminance relative to the mean, dark pixels are judged on their absolute error
+float RelativeError(vec4 accumulated, uint frameCount)
+{
+    if(frameCount < 2)
+        return infinity;
+
+    float n = float(frameCount);
+    float mean = Luminance(accumulated.rgb) / n;
+    float meanVariance = max(accumulated.a / n - mean * mean, 0.0) / (n - 1.0);
+    return sqrt(meanVariance) / max(mean, 0.05);
+}
+
+// Accumulated sums of the previous frame at the position the first hit had in it, zero when the surface was not visible there.
+// historyLength returns the frames in the sums
+vec4 LoadReprojectedHistory(ivec2 coord, vec2 size, out uint historyLength)
+{
+    historyLength = 0;
+    ivec2 previousCoord;
+    if(!FindReprojectedHistory(coord, size, gFirstHitNormal, gFirstHitDistance, previousCoord))
+        return vec4(0);
+
+    historyLength = imageLoad(previousAccumulationCountImage, previousCoord).r;
+    vec4 history = LoadPreviousAccumulation(previousCoord, historyLength);
+
+    //capping the history lets view dependent shading the reprojection cannot follow fade out,
+    //the sums are scaled with the count so their mean stays the same
+    if(historyLength > sceneData.reprojectionMaxHistory)
+    {
+        history *= float(sceneData.reprojectionMaxHistory) / float(historyLength);
+        historyLength = sceneData.reprojectionMaxHistory;
+    }
+
+    return history;
+}
+
+// Traces the samples of this frame and adds them to the accumulated history.
+// frameCount counts the accumulated frames including this one, REPROJECTION permutations track it per pixel instead.
+// Returns the relative standard error of the accumulated mean luminance.
+float TracePixel(ivec2 textureCoord, uint frameCount, bool useHistory, bool storeHistory)
 {
     vec2 imageSize = vec2(imageSize(resultImage));
-    ivec2 textureCoord = ivec2(gl_GlobalInvocationID.xy);
-    
-    //calculate uv coords
-    vec2 uv = textureCoord / imageSize.xy;
-    vec2 screenCord = uv * 2 - 1;
-    screenCord.y *= -1;
-    
+
+    bool reprojectHistory = false;
+    if(REPROJECTION != 0)
+    {
+        //a moving camera finds the history after tracing, at the previous position of the first hit
+        reprojectHistory = sceneData.useAccumulationTexture != 0 && sceneData.reprojectHistory != 0;
+        useHistory = sceneData.useAccumulationTexture != 0 && !reprojectHistory;
+        frameCount = useHistory ? imageLoad(accumulationCountImage, textureCoord).r + 1 : 1;
+        storeHistory = true;
+    }
+
     // modify random seed
-    gState *= floatBitsToUint(uv.y * uv.x / 1000) * textureCoord.x * sceneData.frameIndex;
+    gState = pcg(HashCombine(uint(textureCoord.y) * uint(imageSize.x) + uint(textureCoord.x), sceneData.frameIndex));
+
+    //accumulated frames continue the sequence of the pixel under one scramble, like the CPU sampler in LowDiscrepancy.hpp.
+    //reprojected frames stay on it too, so the history they merge into never mixes two scrambles. only single frames reseed
+    uint sampleBase = (frameCount - 1) * SAMPLES_PER_PIXEL;
+    uint sampleSeed = sceneData.useAccumulationTexture != 0 ? 0 : sceneData.frameIndex;
 
     vec3 origin = sceneData.camInvView[3].xyz;
 
@@ -184,31 +334,111 @@ void main()
     // }
 
     //anti aliasing
-    uint samplesPerPixel = 1;
-    float influence = 0.0025;
+    uint samplesPerPixel = SAMPLES_PER_PIXEL;
     vec3 frameColor = vec3(0);    
     for(int i = 0; i < samplesPerPixel; i++) {
-        vec3 dir = GetRayDirection(screenCord) + influence * hash3();
+        InitSampler(textureCoord, sampleBase + i, sampleSeed);
+
+        //jitter inside the pixel
+        vec2 uv = (vec2(textureCoord) + Sample2D()) / imageSize.xy;
+        vec2 screenCord = uv * 2 - 1;
+        screenCord.y *= -1;
+
+        vec3 dir = GetRayDirection(screenCord);
         vec3 invDir = 1.0 / dir;
         ray ray = ray(origin, dir, invDir);
         frameColor += TraceRay(ray);
     }
     frameColor /= samplesPerPixel;
 
-    vec3 color = frameColor.rgb;
-    int useAcc = int(sceneData.useAccumulationTexture);
-    int firstAcc = int(sceneData.accumFrameIndex != 0);
-
-    vec3 currentColor = frameColor + useAcc * imageLoad(accumulationTexture, ivec2(gl_GlobalInvocationID.xy)).rgb;
+    //rgb sums the frame colors, alpha the squared frame luminance for the variance estimate
+    float luminance = Luminance(frameColor);
+    vec4 history = useHistory ? LoadAccumulation(textureCoord, frameCount - 1) : vec4(0);
+    if(reprojectHistory)
+    {
+        uint historyLength;
+        history = LoadReprojectedHistory(textureCoord, imageSize, historyLength);
+        frameCount = historyLength + 1;
+    }
+    vec4 accumulated = vec4(frameColor, luminance * luminance) + history;
 
-    if(firstAcc == 1)
+    if(storeHistory)
     {
-        imageStore(accumulationTexture, ivec2(gl_GlobalInvocationID.xy), vec4(currentColor, 1));
+        StoreAccumulation(textureCoord, accumulated, frameCount);
+    }
+    if(REPROJECTION != 0)
+    {
+        imageStore(accumulationCountImage, textureCoord, uvec4(frameCount));
+    }
+    if(DENOISER != 0 || REPROJECTION != 0)
+    {
+        imageStore(gBufferImage, textureCoord, vec4(gFirstHitNormal, gFirstHitDistance));
     }
         
-    color = currentColor.rgb / (useAcc * sceneData.accumFrameIndex + 1);
-    color = gamma_correction(color);
-    color = clamp(color, 0, 1);
+    vec3 color = accumulated.rgb / frameCount;
+    if(DENOISER != 0)
+    {
+        //the resolve pass of the denoiser writes the result image, short accumulations flag their variance as missing
+        float mean = Luminance(color);
+        float meanVariance = frameCount >= DENOISE_TEMPORAL_VARIANCE_FRAMES ? max(accumulated.a / frameCount - mean * mean, 0.0) / (frameCount - 1) : -1.0;
+        imageStore(denoiseInputImage, textureCoord, vec4(color, meanVariance));
+        imageStore(albedoImage, textureCoord, vec4(gFirstHitAlbedo, 1));
+    }
+    else
+    {
+        color = gamma_correction(color);
+        color = clamp(color, 0, 1);
+        imageStore(resultImage, textureCoord, vec4(color.rgb, 1));
+    }
+
+    if(TRAVERSAL_STATS != 0)
+    {
+        imageStore(traversalStatsImage, textureCoord, uvec4(gNodeVisits, gAabbTests, gTriangleTests, gRayCount));
+    }
+
+    //one atomic per subgroup instead of one per pixel
+    uint subgroupRays = subgroupAdd(gRayCount);
+    if(subgroupElect())
+        atomicAdd(rayCount, subgroupRays);
 
-    imageStore(resultImage, textureCoord, vec4(color.rgb, 1));
-}
\ No newline at end of file
+    return RelativeError(accumulated, frameCount);
+}
+
+// max relative error of the pixels of the tile as float bits, positive floats order like their bits
+shared uint sTileError;
+
+void main() 
+{
+    uint tileIndex;
+    ivec2 textureCoord = GetPixelCoord(GetWorkgroupTile(tileIndex));
+    //the workgroup size is a specialization constant and does not have to divide the image size
+    bool inside = all(lessThan(textureCoord, imageSize(resultImage)));
+
+    if(ADAPTIVE_SAMPLING == 0)
+    {
+        if(!inside)
+            return;
+
+        //the first frame of an accumulation starts from its own sample, so restarts never read images of another format or size
+        uint useAccumulation = sceneData.useAccumulationTexture;
+        TracePixel(textureCoord, useAccumulation * sceneData.accumFrameIndex + 1, useAccumulation != 0 && sceneData.accumFrameIndex != 0, true);
+        return;
+    }
+
+    //every pixel of the tile has the same frame count, the workgroup is the only writer of its tile state
+    bool useHistory = sceneData.useAccumulationTexture != 0;
+    uint frameCount = useHistory ? GetTileFrameCount(tileStates[tileIndex]) + 1 : 1;
+    if(gl_LocalInvocationIndex == 0)
+        sTileError = 0;
+    barrier();
+
+    float error = inside ? TracePixel(textureCoord, frameCount, useHistory, true) : 0.0;
+    atomicMax(sTileError, floatBitsToUint(error));
+    barrier();
+
+    if(gl_LocalInvocationIndex == 0)
+    {
+        bool converged = frameCount >= sceneData.adaptiveMinFrames && uintBitsToFloat(sTileError) <= sceneData.adaptiveThreshold;
+        tileStates[tileIndex] = frameCount | (converged ? TILE_CONVERGED_BIT : 0u);
+    }
+}
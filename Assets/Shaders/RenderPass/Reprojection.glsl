@@ -0,0 +1,67 @@
+#ifndef REPROJECTION_H
+#define REPROJECTION_H
+
+#include "SceneData.glsl"
+
+// copy of the g-buffer of the previous frame, written before frames with camera motion. The accumulation copies are in Accumulation.glsl
+layout(binding = 21, rgba32f) uniform readonly image2D previousGBufferImage;
+
+// relative difference between the reprojected and the stored hit distance that still counts as the same surface
+const float REPROJECTION_DEPTH_TOLERANCE = 0.05;
+const float REPROJECTION_MIN_NORMAL_DOT = 0.9;
+// the sky has no hit position, it is reprojected from a point this far along the view ray
+const float REPROJECTION_SKY_DISTANCE = 10000.0;
+
+// World position at hitDistance along the camera ray through the center of the pixel
+vec3 GetFirstHitPosition(ivec2 coord, vec2 size, float hitDistance)
+{
+    vec2 screenCord = (vec2(coord) + 0.5) / size * 2 - 1;
+    screenCord.y *= -1;
+
+    vec4 target = sceneData.camInvProjection * vec4(screenCord, 1.0, 1.0);
+    vec3 direction = normalize(vec3(sceneData.camInvView * vec4(normalize(target.xyz / target.w), 0.0)));
+    return sceneData.camInvView[3].xyz + direction * hitDistance;
+}
+
+// Pixel coordinate of worldPosition in the previous frame and its distance to the previous camera.
+// Returns false when the position was outside the previous view
+bool ReprojectToPreviousFrame(vec3 worldPosition, vec2 size, out vec2 previousPixel, out float previousDistance)
+{
+    vec4 viewPosition = sceneData.prevCamView * vec4(worldPosition, 1.0);
+    vec4 clipPosition = sceneData.prevCamProjection * viewPosition;
+    if(clipPosition.w <= 0.0)
+        return false;
+
+    vec2 screenCord = clipPosition.xy / clipPosition.w;
+    screenCord.y *= -1;
+
+    previousPixel = (screenCord * 0.5 + 0.5) * size;
+    previousDistance = length(viewPosition.xyz);
+    return all(greaterThanEqual(previousPixel, vec2(0))) && all(lessThan(previousPixel, size));
+}
+
+// True when the previous g-buffer texel holds the surface hit in this frame
+bool IsReprojectionValid(vec3 normal, float hitDistance, vec4 previousGBuffer, float expectedDistance)
+{
+    //the sky only matches the sky
+    if(hitDistance == 0.0 || previousGBuffer.w == 0.0)
+        return hitDistance == previousGBuffer.w;
+
+    return abs(previousGBuffer.w - expectedDistance) < REPROJECTION_DEPTH_TOLERANCE * expectedDistance &&
+        dot(normal, previousGBuffer.xyz) > REPROJECTION_MIN_NORMAL_DOT;
+}
+
+// Texel of the previous frame that saw the first hit of this pixel, false when the surface was not visible there
+bool FindReprojectedHistory(ivec2 coord, vec2 size, vec3 normal, float hitDistance, out ivec2 previousCoord)
+{
+    vec3 position = GetFirstHitPosition(coord, size, hitDistance > 0.0 ? hitDistance : REPROJECTION_SKY_DISTANCE);
+    vec2 previousPixel;
+    float expectedDistance;
+    if(!ReprojectToPreviousFrame(position, size, previousPixel, expectedDistance))
+        return false;
+
+    previousCoord = ivec2(previousPixel);
+    return IsReprojectionValid(normal, hitDistance, imageLoad(previousGBufferImage, previousCoord), expectedDistance);
+}
+
+#endif // REPROJECTION_H
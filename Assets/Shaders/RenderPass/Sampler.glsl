@@ -0,0 +1,96 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "../Utils/random.glsl"
+#include "Specialization.glsl"
+
+// Must match TracerUtils::Math::LowDiscrepancy on the host side
+#define SOBOL_DIMENSIONS 2
+#define SOBOL_BITS 32
+#define BLUE_NOISE_SIZE 64
+
+// Written once by the host
+layout(binding = 9, std430) readonly buffer SamplerTables{
+    uint sobolDirections[SOBOL_DIMENSIONS * SOBOL_BITS];
+    // two 16 bit blue noise channels per texel
+    uint blueNoise[BLUE_NOISE_SIZE * BLUE_NOISE_SIZE];
+};
+
+ivec2 gSamplePixel;
+uint gSampleIndex;
+uint gSampleSeed;
+uint gSampleDimension;
+
+uint HashCombine(uint seed, uint value)
+{
+    return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+}
+
+// Random permutation in which every bit only depends on the bits below it
+uint LaineKarrasPermutation(uint x, uint seed)
+{
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+// Owen scrambling of a 32 bit fixed point value, "Practical Hash-based Owen Scrambling" (Burley 2020)
+uint NestedUniformScramble(uint x, uint seed)
+{
+    x = bitfieldReverse(x);
+    x = LaineKarrasPermutation(x, seed);
+    return bitfieldReverse(x);
+}
+
+uint SobolSample(uint index, uint dimension)
+{
+    uint result = 0;
+    for(uint bit = 0; index != 0; bit++, index >>= 1)
+    {
+        if((index & 1u) != 0)
+            result ^= sobolDirections[dimension * SOBOL_BITS + bit];
+    }
+    return result;
+}
+
+// sampleIndex counts the samples of the pixel since the accumulation started,
+// seed changes the sequence of frames that are not accumulated
+void InitSampler(ivec2 pixel, uint sampleIndex, uint seed)
+{
+    gSamplePixel = pixel;
+    gSampleIndex = sampleIndex;
+    gSampleSeed = seed;
+    gSampleDimension = 0;
+}
+
+// Next two dimensions of the current sample
+vec2 Sample2D()
+{
+    if(SAMPLER == SAMPLER_PCG)
+        return hash2();
+
+    //every dimension pair is its own shuffled and scrambled 2D Sobol sequence, so pairs stay uncorrelated
+    uint dimensionSeed = pcg(HashCombine(gSampleSeed, gSampleDimension));
+    uint index = NestedUniformScramble(gSampleIndex, dimensionSeed);
+    uvec2 sobol = uvec2(SobolSample(index, 0), SobolSample(index, 1));
+    sobol.x = NestedUniformScramble(sobol.x, pcg(dimensionSeed ^ 0x5bd1e995u));
+    sobol.y = NestedUniformScramble(sobol.y, pcg(dimensionSeed + 0x68e31da4u));
+    vec2 u = vec2(sobol >> 8) * (1.0 / 16777216.0);
+
+    //blue noise Cranley-Patterson rotation spreads the error of neighbouring pixels as blue noise,
+    //an R2 offset per pair keeps the rotations of different dimensions apart
+    float pair = float(gSampleDimension / 2);
+    ivec2 noiseOffset = ivec2(fract(vec2(0.7548776662, 0.5698402910) * pair) * BLUE_NOISE_SIZE);
+    noiseOffset += ivec2(uvec2(pcg(gSampleSeed)) >> uvec2(0, 16));
+    ivec2 texel = (gSamplePixel + noiseOffset) & (BLUE_NOISE_SIZE - 1);
+    uint noise = blueNoise[texel.y * BLUE_NOISE_SIZE + texel.x];
+    vec2 rotation = vec2(noise & 0xffffu, noise >> 16) * (1.0 / 65536.0);
+
+    gSampleDimension += 2;
+    return fract(u + rotation);
+}
+
+#endif // SAMPLER_H
@@ -16,8 +16,39 @@ layout(binding = 2, std140) uniform SceneData{
     float defoucsDiskU;
     float defoucsDiskV;
 
+    uint directTriangleFetch;
+    uint compactVertices;
+
     vec3 aabbMin;
     vec3 aabbMax;
+
+    uint debugView;
+    float heatmapMax;
+
+    // adaptive sampling, tiles are the workgroups of the ray tracing pass
+    uint adaptiveTileCountX;
+    uint adaptiveTileCount;
+    float adaptiveThreshold;
+    uint adaptiveMinFrames;
+
+    // russian roulette starts after this bounce, 0 traces every path to the bounce limit
+    uint rouletteMinBounce;
+
+    // camera of the previous frame, used to reproject history
+    mat4 prevCamProjection;
+    mat4 prevCamView;
+
+    // 1 when the camera moved since the previous frame and the accumulation is reprojected
+    uint reprojectHistory;
+    // reprojected history is capped to this many frames
+    uint reprojectionMaxHistory;
 } sceneData;
 
+// debugView values, the heatmaps show one channel of the traversal stats image
+#define DEBUG_VIEW_SHADED 0
+#define DEBUG_VIEW_NODES 1
+#define DEBUG_VIEW_AABB_TESTS 2
+#define DEBUG_VIEW_TRIANGLE_TESTS 3
+#define DEBUG_VIEW_RAYS 4
+
 #endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef SPECIALIZATION_H
+#define SPECIALIZATION_H
+
+// Pipeline specialization constants, ids must match RaytracePermutation on the host side
+
+layout (local_size_x_id = 0, local_size_y_id = 1, local_size_z = 1) in;
+
+// traversal stack size of BVH and Kd tree
+layout (constant_id = 2) const uint MAX_STACK_DEPTH = 64;
+// 0 reads the bounce count from the scene data
+layout (constant_id = 3) const uint MAX_BOUNCES = 0;
+layout (constant_id = 4) const uint SAMPLES_PER_PIXEL = 1;
+// 0 - row major pixels inside a workgroup, 1 - Morton order, requires power of two workgroup sizes
+layout (constant_id = 5) const uint PIXEL_MAPPING = 0;
+// 1 - count nodes, AABB and triangle tests per pixel into the traversal stats image
+layout (constant_id = 6) const uint TRAVERSAL_STATS = 0;
+// 0 - PCG white noise, 1 - Owen scrambled Sobol with blue noise rotation
+layout (constant_id = 7) const uint SAMPLER = 1;
+// 1 - trace only the tiles of the active tile list with an indirect dispatch, see AdaptiveSampling.glsl
+layout (constant_id = 8) const uint ADAPTIVE_SAMPLING = 0;
+// 1 - sample the sky at diffuse hits with a shadow ray and combine it with BSDF sampling through MIS, see LightSampling.glsl
+layout (constant_id = 9) const uint NEXT_EVENT_ESTIMATION = 1;
+// 1 - write the G-buffer and the noisy frame for the denoiser instead of the result image, see Denoise.glsl
+layout (constant_id = 10) const uint DENOISER = 0;
+// 1 - track the accumulated frames per pixel and reproject the accumulation when the camera moves, see Reprojection.glsl
+layout (constant_id = 11) const uint REPROJECTION = 0;
+// 0 - rgba32f sums, 1 - rgba16f running mean with Kahan compensation, see Accumulation.glsl
+layout (constant_id = 12) const uint ACCUMULATION_FORMAT = 0;
+
+#define PIXEL_MAPPING_LINEAR 0
+#define PIXEL_MAPPING_MORTON 1
+
+#define SAMPLER_PCG 0
+#define SAMPLER_SOBOL_BLUE_NOISE 1
+
+uint CompactBits(uint x)
+{
+    x &= 0x55555555;
+    x = (x | (x >> 1)) & 0x33333333;
+    x = (x | (x >> 2)) & 0x0f0f0f0f;
+    x = (x | (x >> 4)) & 0x00ff00ff;
+    x = (x | (x >> 8)) & 0x0000ffff;
+    return x;
+}
+
+// Pixel of this invocation in the workgroup tile. Morton mapping walks square tiles of the workgroup in Z order,
+// so neighbouring invocations of a subgroup trace neighbouring pixels and follow similar BVH paths.
+ivec2 GetPixelCoord(uvec2 workgroupTile)
+{
+    if(PIXEL_MAPPING == PIXEL_MAPPING_LINEAR)
+        return ivec2(workgroupTile * gl_WorkGroupSize.xy + gl_LocalInvocationID.xy);
+
+    uvec2 groupSize = gl_WorkGroupSize.xy;
+    uint tileSize = min(groupSize.x, groupSize.y);
+    uint tileIndex = gl_LocalInvocationIndex / (tileSize * tileSize);
+    uint tileLocal = gl_LocalInvocationIndex % (tileSize * tileSize);
+
+    uvec2 local = uvec2(CompactBits(tileLocal), CompactBits(tileLocal >> 1));
+    local += groupSize.x >= groupSize.y ? uvec2(tileIndex * tileSize, 0) : uvec2(0, tileIndex * tileSize);
+
+    return ivec2(workgroupTile * groupSize + local);
+}
+
+#endif // SPECIALIZATION_H
\ No newline at end of file
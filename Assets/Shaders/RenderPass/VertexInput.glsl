@@ -1,6 +1,8 @@
 #ifndef VERTEX_INPUT
 #define VERTEX_INPUT
 
+#include "SceneData.glsl"
+
 struct triangle {
     vec3 v0;
     vec3 v1;
@@ -18,23 +20,97 @@ struct vertex {
     uint materialFlag;
 };
 
+// Mirrors CompactTracerVertex: octahedral normal, half precision uv, 16 bit material index
+struct compactVertex {
+    float positionX;
+    float positionY;
+    float positionZ;
+    uint normal;
+    uint uv;
+    uint materialFlag;
+};
+
 layout(binding = 3, std140) readonly buffer Triangles{
     vertex vertecies[];
 };
 
+// Aliases binding 3 when the scene was uploaded with the compact vertex format
+layout(binding = 3, std430) readonly buffer CompactTriangles{
+    compactVertex compactVertecies[];
+};
+
 layout(binding = 4) readonly buffer Indecies{
     uint indecies[];
 };
 
+vec3 decodeOctahedralNormal(uint packedNormal)
+{
+    vec2 f = unpackSnorm2x16(packedNormal);
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 getVertexPosition(uint vertexIndex)
+{
+    if(sceneData.compactVertices != 0)
+    {
+        compactVertex v = compactVertecies[vertexIndex];
+        return vec3(v.positionX, v.positionY, v.positionZ);
+    }
+
+    return vertecies[vertexIndex].position;
+}
+
+vec3 getVertexNormal(uint vertexIndex)
+{
+    if(sceneData.compactVertices != 0)
+    {
+        return decodeOctahedralNormal(compactVertecies[vertexIndex].normal);
+    }
+
+    return vertecies[vertexIndex].normal;
+}
+
+uint getVertexMaterial(uint vertexIndex)
+{
+    if(sceneData.compactVertices != 0)
+    {
+        return compactVertecies[vertexIndex].materialFlag & 0xFFFF;
+    }
+
+    return vertecies[vertexIndex].materialFlag;
+}
+
+uint getVertexIndex(uint index)
+{
+    // Leaf ordered BVH stores every triangle as three consecutive vertices
+    return sceneData.directTriangleFetch != 0 ? index : indecies[index];
+}
+
+// Positions only, for any hit queries that need no normal or material
+void getTrianglePositions(uint startIndex, out vec3 v0, out vec3 v1, out vec3 v2)
+{
+    v0 = getVertexPosition(getVertexIndex(startIndex));
+    v1 = getVertexPosition(getVertexIndex(startIndex + 1));
+    v2 = getVertexPosition(getVertexIndex(startIndex + 2));
+}
+
 triangle getTriangle(uint startIndex) {
+    uint i0 = getVertexIndex(startIndex);
+    uint i1 = getVertexIndex(startIndex + 1);
+    uint i2 = getVertexIndex(startIndex + 2);
+
     return triangle(
-        vertecies[indecies[startIndex]].position,
-        vertecies[indecies[startIndex + 1]].position,
-        vertecies[indecies[startIndex + 2]].position,
-        vertecies[indecies[startIndex]].normal,
-        vertecies[indecies[startIndex + 1]].normal,
-        vertecies[indecies[startIndex + 2]].normal,
-        vertecies[indecies[startIndex]].materialFlag
+        getVertexPosition(i0),
+        getVertexPosition(i1),
+        getVertexPosition(i2),
+        getVertexNormal(i0),
+        getVertexNormal(i1),
+        getVertexNormal(i2),
+        getVertexMaterial(i0)
     );
 }
 
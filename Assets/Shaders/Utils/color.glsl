@@ -13,4 +13,17 @@ vec3 gamma_correction(vec3 linearColor)
                 gamma_correction(linearColor.z));
 }
 
+// Rec. 709 luminance of a linear color
+float Luminance(vec3 linearColor)
+{
+    return dot(linearColor, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// blue - cyan - green - yellow - red ramp, t in [0, 1]
+vec3 HeatmapColor(float t)
+{
+    t = clamp(t, 0.0, 1.0);
+    return clamp(vec3(4.0 * t - 2.0, min(4.0 * t, 4.0 - 4.0 * t), 2.0 - 4.0 * t), 0.0, 1.0);
+}
+
 #endif // COLOR_H
\ No newline at end of file
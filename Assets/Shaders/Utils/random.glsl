@@ -1,14 +1,20 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
+#include "constants.glsl"
+
 uint gState = 78213298; // global state
 
-uint pcg_hash() {
-    uint state = gState * uint(747796405) + uint(2891336453);
+uint pcg(uint value) {
+    uint state = value * uint(747796405) + uint(2891336453);
     uint word = ((state >> ((state >> 28) + 4)) ^ state) * uint(277803737);
     return (word >> 22) ^ word;
 }
 
+uint pcg_hash() {
+    return pcg(gState);
+}
+
 float hash1() {
     gState = pcg_hash();
     return float(gState) / float(uint(0xffffffff));
@@ -30,22 +36,31 @@ vec3 hash3(float min, float max) {
     return hash3() * (max - min) + min;
 }
 
+// Closed form mappings of uniform [0, 1) samples, every sample is used and no invocation loops
+
+vec3 SampleUnitSphere(vec2 u) {
+    float z = 1.0 - 2.0 * u.x;
+    float r = sqrt(max(0.0, 1.0 - z * z));
+    float phi = 2.0 * PI * u.y;
+    return vec3(r * cos(phi), r * sin(phi), z);
+}
+
+vec3 SampleUnitDisk(vec2 u) {
+    float r = sqrt(u.x);
+    float theta = 2.0 * PI * u.y;
+    return vec3(r * cos(theta), r * sin(theta), 0);
+}
+
 vec3 inUnitSphere(){
-    while(true) {
-        vec3 p = hash3(-1, 1);
-        if(dot(p,p) < 1) return p;
-    }
+    return SampleUnitSphere(hash2()) * pow(hash1(), 1.0 / 3.0);
 }
 
 vec3 inUnitDisk() {
-    while(true) {
-        vec3 p = vec3(hash1(-1, 1), hash1(-1, 1), 0);
-        if(dot(p,p) < 1) return p;
-    }
+    return SampleUnitDisk(hash2());
 }
 
 vec3 randomUnitVector() {
-    return normalize(inUnitSphere());
+    return SampleUnitSphere(hash2());
 }
 
 #endif // RANDOM_H
\ No newline at end of file
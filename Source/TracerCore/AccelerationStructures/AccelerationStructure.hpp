@@ -3,6 +3,10 @@
 #include <VulkanDevice.hpp>
 #include <Models/TracerVertex.hpp>
 #include <Resources/VulkanBuffer.hpp>
+#include <Math/Ray.hpp>
+
+#include <vector>
+#include <glm/glm.hpp>
 
 namespace TracerCore::AccelerationStructures {
 
@@ -17,10 +21,31 @@ namespace TracerCore::AccelerationStructures {
 
         inline uint32_t GetIndeciesCount() const { return _indeciesCount; }
 
+        /// @brief True if the vertex buffer was rewritten in leaf order and triangles can be fetched without the index buffer.
+        inline bool IsLeafOrdered() const { return _leafOrdered; }
+
+        /// @brief Any hit query on the CPU side of the structure, same traversal as Occluded in the shaders.
+        /// @param trianglePositions three positions per entry of the uploaded index buffer, see TracerScene::Occluded
+        /// @return true on the first triangle hit in [tMin, tMax]
+        virtual bool Occluded(const TracerUtils::Math::Ray& ray, float tMin, float tMax, const std::vector<glm::vec3>& trianglePositions) const = 0;
+
     protected:
+        /// @brief Tests count indices starting at startIndex, three per triangle.
+        static inline bool OccludedByLeaf(const TracerUtils::Math::Ray& ray, const std::vector<glm::vec3>& trianglePositions, uint32_t startIndex, uint32_t count, float tMin, float tMax)
+        {
+            for (uint32_t i = 0; i < count; i += 3)
+            {
+                const glm::vec3* triangle = &trianglePositions[startIndex + i];
+                if(TracerUtils::Math::OccludedByTriangle(ray, triangle[0], triangle[1], triangle[2], tMin, tMax))
+                    return true;
+            }
+            return false;
+        }
+
         VulkanDevice& _device;
 
         uint32_t _indeciesCount = 0;
+        bool _leafOrdered = false;
     };
     
 
@@ -1,18 +1,23 @@
 #include "BHVTree.hpp"
+#include <Resources/UploadManager.hpp>
 
 #include <iostream>
 
+#include <tracy/Tracy.hpp>
+
 namespace TracerCore::AccelerationStructures
 {
-    BHVTree::BHVTree(VulkanDevice &_device, AccHeruishitcType accHeruishitcType, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices) : 
+    BHVTree::BHVTree(VulkanDevice &_device, AccHeruishitcType accHeruishitcType, bool reorderLeafTriangles, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices) : 
         AccelerationStructure(_device, vertices, indices), _accHeruishitcType(accHeruishitcType)
     {
+        ZoneScoped;
         std::cout << "Building BHV Tree, Heruishitc " << (int) _accHeruishitcType << std::endl;
 
         std::vector<uint32_t> indicesCopy;
         indicesCopy.insert(indicesCopy.begin(), indices.begin(), indices.end()); 
 
         std::vector<glm::vec3> centroids;
+        centroids.reserve(indicesCopy.size() / 3);
         for (size_t i = 0; i < indicesCopy.size(); i+=3)
         {
             glm::vec3 centroid = (vertices[indicesCopy[i]].Position + vertices[indicesCopy[i + 1]].Position + vertices[indicesCopy[i + 2]].Position) * 0.333333f;
@@ -27,17 +32,17 @@ namespace TracerCore::AccelerationStructures
         InsertNode(rootNode, vertices, indicesCopy);
         SubdivideNode(0, centroids, vertices, indicesCopy, 1);
 
-        _nodesBuffer = Resources::VulkanBuffer::CreateBuffer(_device, sizeof(BHVNode) * _nodes.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        _indeciesBuffer = Resources::VulkanBuffer::CreateBuffer(_device, sizeof(uint32_t) * indicesCopy.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        void* data;
-        _nodesBuffer->MapMemory(sizeof(BHVNode) * _nodes.size(), 0, &data);
-        memcpy(data, _nodes.data(), sizeof(BHVNode) * _nodes.size());
-        _nodesBuffer->UnmapMemory();
+        if(reorderLeafTriangles)
+        {
+            ReorderLeafTriangles(vertices, indicesCopy);
+            indices = indicesCopy;
+        }
 
-        _indeciesBuffer->MapMemory(sizeof(uint32_t) * indicesCopy.size(), 0, &data);
-        memcpy(data, indicesCopy.data(), sizeof(uint32_t) * indicesCopy.size());
-        _indeciesBuffer->UnmapMemory();
+        Resources::UploadManager& uploadManager = _device.GetUploadManager();
+        _nodesBuffer = uploadManager.CreateDeviceLocalBuffer(_nodes.data(), sizeof(BHVNode) * _nodes.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Resources::MemoryCategory::AccelerationStructure);
+        //leaf ordered triangles are fetched without the identity index buffer, a single index keeps the binding valid
+        size_t uploadedIndexCount = _leafOrdered ? 1 : indicesCopy.size();
+        _indeciesBuffer = uploadManager.CreateDeviceLocalBuffer(indicesCopy.data(), sizeof(uint32_t) * uploadedIndexCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Resources::MemoryCategory::AccelerationStructure);
 
         _indeciesCount = indicesCopy.size();
     }
@@ -46,6 +51,37 @@ namespace TracerCore::AccelerationStructures
     {
     }
 
+    bool BHVTree::Occluded(const TracerUtils::Math::Ray &ray, float tMin, float tMax, const std::vector<glm::vec3>& trianglePositions) const
+    {
+        //children in node order like occludedBHVTree, the first hit ends the query so ordering by distance does not pay off.
+        //The build stops at depth 32, so one pending sibling per level always fits
+        uint32_t nodeStack[64];
+        nodeStack[0] = 0;
+        uint32_t stackSize = 1;
+
+        while (stackSize > 0)
+        {
+            const BHVNode& node = _nodes[nodeStack[--stackSize]];
+
+            float tStart = 0.0f;
+            float tEnd = 0.0f;
+            if(!TracerUtils::Math::IntersectAabb(ray, node.aabbMin, node.aabbMax, tStart, tEnd) || tStart > tMax)
+                continue;
+
+            if(node.indeciesCount > 0)
+            {
+                if(OccludedByLeaf(ray, trianglePositions, node.nextIndex, node.indeciesCount, tMin, tMax))
+                    return true;
+                continue;
+            }
+
+            nodeStack[stackSize++] = node.nextIndex + 1;
+            nodeStack[stackSize++] = node.nextIndex;
+        }
+
+        return false;
+    }
+
     void BHVTree::InsertNode(BHVNode &node, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices)
     {
         node.aabbMax = glm::vec3(-FLT_MAX);
@@ -63,7 +99,27 @@ namespace TracerCore::AccelerationStructures
         _nodes.push_back(node);
     }
 
-    void BHVTree::SubdivideNode(uint32_t parentNodeIndex, std::vector<glm::vec3> allCentroids, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices, uint32_t depth)
+    void BHVTree::ReorderLeafTriangles(std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices)
+    {
+        ZoneScoped;
+
+        // Leaves already own contiguous index ranges, so writing the referenced vertices out in index order
+        // turns every leaf into a contiguous triangle range and makes the index buffer an identity mapping.
+        std::vector<TracerUtils::Models::TracerVertex> leafOrderedVertices;
+        leafOrderedVertices.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            leafOrderedVertices.push_back(vertices[indices[i]]);
+            indices[i] = i;
+        }
+
+        std::cout << "BHV leaf reorder: " << vertices.size() << " -> " << leafOrderedVertices.size() << " vertices" << std::endl;
+
+        vertices = std::move(leafOrderedVertices);
+        _leafOrdered = true;
+    }
+
+    void BHVTree::SubdivideNode(uint32_t parentNodeIndex, std::vector<glm::vec3>& allCentroids, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices, uint32_t depth)
     {
         if(depth > 32)
             return;
@@ -123,7 +179,7 @@ namespace TracerCore::AccelerationStructures
         SubdivideNode(rightIndexId, allCentroids, vertices, indices, depth + 1);
     }
 
-    bool BHVTree::FindBestSplitPosition(const BHVNode& node, std::vector<glm::vec3> allCentroids, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices, float& bestCost, uint32_t& bestSplitAxis, float& bestSplitPos)
+    bool BHVTree::FindBestSplitPosition(const BHVNode& node, const std::vector<glm::vec3>& allCentroids, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices, float& bestCost, uint32_t& bestSplitAxis, float& bestSplitPos)
     {
         bestSplitAxis = 0;
         bestCost = FLT_MAX;
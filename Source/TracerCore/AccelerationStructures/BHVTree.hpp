@@ -32,7 +32,7 @@ namespace TracerCore::AccelerationStructures
     class BHVTree : public AccelerationStructure 
     {
         public:
-            BHVTree(VulkanDevice& _device, AccHeruishitcType accHeruishitcType, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices);
+            BHVTree(VulkanDevice& _device, AccHeruishitcType accHeruishitcType, bool reorderLeafTriangles, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices);
             ~BHVTree() override;
 
             BHVTree(const BHVTree&) = delete;
@@ -40,11 +40,16 @@ namespace TracerCore::AccelerationStructures
 
             inline const Resources::VulkanBuffer* GetNodesBuffer() const override { return _nodesBuffer.get(); }
             inline virtual const Resources::VulkanBuffer* GetIndicesBuffer() const override { return _indeciesBuffer.get(); }
+
+            bool Occluded(const TracerUtils::Math::Ray& ray, float tMin, float tMax, const std::vector<glm::vec3>& trianglePositions) const override;
         private:
+            /// @brief Rewrites vertices in leaf order so each leaf references a contiguous triangle range without index indirection.
+            void ReorderLeafTriangles(std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices);
+
             void InsertNode(BHVNode& node, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices);
-            void SubdivideNode(uint32_t parentNodeIndex, std::vector<glm::vec3> allCentroids, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices, uint32_t depth);
+            void SubdivideNode(uint32_t parentNodeIndex, std::vector<glm::vec3>& allCentroids, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices, uint32_t depth);
 
-            bool FindBestSplitPosition(const BHVNode& node, std::vector<glm::vec3> allCentroids, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices, float& bestCost, uint32_t& bestSplitAxis, float& bestSplitPos);
+            bool FindBestSplitPosition(const BHVNode& node, const std::vector<glm::vec3>& allCentroids, std::vector<TracerUtils::Models::TracerVertex>& vertices, std::vector<uint32_t>& indices, float& bestCost, uint32_t& bestSplitAxis, float& bestSplitPos);
             float CalculateSAHNodeCost(const BHVNode& node);
 
             const AccHeruishitcType _accHeruishitcType;
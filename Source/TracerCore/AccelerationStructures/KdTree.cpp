@@ -1,4 +1,5 @@
 #include "KdTree.hpp"
+#include <Resources/UploadManager.hpp>
 #include <algorithm>
 #include "iostream"
 
@@ -34,17 +35,9 @@ namespace TracerCore::AccelerationStructures
             _indices[i] = indices[_indices[i]];
         }
 
-        _nodesBuffer = Resources::VulkanBuffer::CreateBuffer(_device, sizeof(KdNode) * _nodes.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        _indecieBuffer = Resources::VulkanBuffer::CreateBuffer(_device, sizeof(uint32_t) * _indices.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        void* data;
-        _nodesBuffer->MapMemory(sizeof(KdNode) * _nodes.size(), 0, &data);
-        memcpy(data, _nodes.data(), sizeof(KdNode) * _nodes.size());
-        _nodesBuffer->UnmapMemory();
-
-        _indecieBuffer->MapMemory(sizeof(uint32_t) * _indices.size(), 0, &data);
-        memcpy(data, _indices.data(), sizeof(uint32_t) * _indices.size());
-        _indecieBuffer->UnmapMemory();
+        Resources::UploadManager& uploadManager = _device.GetUploadManager();
+        _nodesBuffer = uploadManager.CreateDeviceLocalBuffer(_nodes.data(), sizeof(KdNode) * _nodes.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Resources::MemoryCategory::AccelerationStructure);
+        _indecieBuffer = uploadManager.CreateDeviceLocalBuffer(_indices.data(), sizeof(uint32_t) * _indices.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Resources::MemoryCategory::AccelerationStructure);
 
         _indeciesCount = _indices.size();
         _indices.clear();
@@ -54,6 +47,65 @@ namespace TracerCore::AccelerationStructures
     {
     }
 
+    bool KdTree::Occluded(const TracerUtils::Math::Ray &ray, float tMin, float tMax, const std::vector<glm::vec3>& trianglePositions) const
+    {
+        struct NodeInterval
+        {
+            uint32_t nodeIndex;
+            float tStart;
+            float tEnd;
+        };
+
+        float tStart = tMin;
+        float tEnd = tMax;
+        if(!TracerUtils::Math::IntersectAabb(ray, _rootBounds.aabbMin, _rootBounds.aabbMax, tStart, tEnd) || tStart > tMax)
+            return false;
+
+        //same front to back order as occludedKdTree, triangles that overlap several leaves count as occluders anywhere in [tMin, tMax]
+        std::vector<NodeInterval> stack;
+        stack.push_back({0, tStart, tEnd});
+        while (!stack.empty())
+        {
+            NodeInterval interval = stack.back();
+            stack.pop_back();
+
+            const KdNode& node = _nodes[interval.nodeIndex];
+            tStart = interval.tStart;
+            tEnd = std::min(interval.tEnd, tMax);
+            if(tStart > tEnd)
+                continue;
+
+            if(node.indeciesCount > 0)
+            {
+                if(OccludedByLeaf(ray, trianglePositions, node.nextIndex, node.indeciesCount, tMin, tMax))
+                    return true;
+                continue;
+            }
+
+            uint32_t axis = node.flags;
+            float t = (node.split - ray.Origin[axis]) * ray.InvDirection[axis];
+            bool leftToRightOrder = ray.Origin[axis] < node.split || (ray.Origin[axis] == node.split && ray.Direction[axis] <= 0.0f);
+            uint32_t nearChild = leftToRightOrder ? node.nextIndex : node.nextIndex + 1;
+            uint32_t farChild = leftToRightOrder ? node.nextIndex + 1 : node.nextIndex;
+
+            if(t > tEnd || t <= 0.0f)
+            {
+                stack.push_back({nearChild, tStart, tEnd});
+            }
+            else if(t < tStart)
+            {
+                stack.push_back({farChild, tStart, tEnd});
+            }
+            else
+            {
+                stack.push_back({farChild, t, tEnd});
+                stack.push_back({nearChild, tStart, t});
+            }
+        }
+
+        return false;
+    }
+
     void KdTree::BuildTree(
         int nodeIndex, 
         const KdTreeBounds &nodeBounds, 
@@ -73,6 +73,8 @@ namespace TracerCore::AccelerationStructures
         inline const glm::vec3& GetAABBMin() const { return _rootBounds.aabbMin; }
         inline const glm::vec3& GetAABBMax() const { return _rootBounds.aabbMax; }
 
+        bool Occluded(const TracerUtils::Math::Ray& ray, float tMin, float tMax, const std::vector<glm::vec3>& trianglePositions) const override;
+
     private:
         void BuildTree(
             int nodeIndex, 
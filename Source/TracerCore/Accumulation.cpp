@@ -0,0 +1,107 @@
+#include "Accumulation.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "Tracer.hpp"
+
+namespace TracerCore
+{
+    // smallest normal half float, the spacing of the subnormals below it is fixed
+    static constexpr float HALF_MIN_NORMAL = 6.103515625e-5f;
+
+    /// @brief Same as GetHalfUlp in Accumulation.glsl.
+    static float GetHalfUlp(float value)
+    {
+        return std::exp2(std::floor(std::log2(std::max(std::abs(value), HALF_MIN_NORMAL))) - 10.0f);
+    }
+
+    uint32_t GetAccumulationBytesPerPixel(AccumulationFormat format)
+    {
+        switch (format)
+        {
+        case AccumulationFormat::AccumulationFormat_HalfCompensated:
+            //rgba16f mean and rgba8 compensation
+            return 2 * (8 + 4);
+        default:
+            return 2 * 16;
+        }
+    }
+
+    std::vector<float> DecodeCompensatedMean(const std::vector<float> &mean, const std::vector<float> &compensation)
+    {
+        assert(mean.size() == compensation.size() && "Compensation image does not match the mean image");
+
+        std::vector<float> decoded(mean.size());
+        for (size_t i = 0; i < mean.size(); i++)
+        {
+            decoded[i] = mean[i] + compensation[i] * GetHalfUlp(mean[i]);
+        }
+        return decoded;
+    }
+
+    const char *GetAccumulationFormatName(AccumulationFormat format)
+    {
+        switch (format)
+        {
+        case AccumulationFormat::AccumulationFormat_HalfCompensated: return "half";
+        default: return "float";
+        }
+    }
+
+    bool ParseAccumulationFormatName(const std::string &name, AccumulationFormat &format)
+    {
+        if(name == "float")
+            format = AccumulationFormat::AccumulationFormat_Float32;
+        else if(name == "half")
+            format = AccumulationFormat::AccumulationFormat_HalfCompensated;
+        else
+            return false;
+
+        return true;
+    }
+
+    void Tracer::RunAccumulationCheck()
+    {
+        const uint64_t reference4kPixels = 3840ull * 2160ull;
+        uint32_t frameCount = _settings.FrameCount;
+        uint64_t pixelCount = static_cast<uint64_t>(_settings.Width) * _settings.Height;
+
+        //the image error needs the accumulation without filters and tiles
+        _sceneData.AdaptiveSampling = false;
+        _sceneData.Denoiser = false;
+
+        auto render = [&](AccumulationFormat format, uint32_t renderFrameCount)
+        {
+            _sceneData.AccumulationFormat = static_cast<int>(format);
+            return RenderAccumulated(renderFrameCount);
+        };
+
+        _sceneData.AccumulationFormat = static_cast<int>(AccumulationFormat::AccumulationFormat_Float32);
+        std::vector<float> reference = RenderReference(frameCount);
+
+        //both formats trace the same frame indices and with that the same samples, the difference is the storage alone
+        RenderTimings floatTimings = render(AccumulationFormat::AccumulationFormat_Float32, frameCount);
+        std::vector<float> floatImage = ReadAccumulatedImage(frameCount);
+
+        RenderTimings halfTimings = render(AccumulationFormat::AccumulationFormat_HalfCompensated, frameCount);
+        std::vector<float> halfImage = ReadAccumulatedImage(frameCount);
+        Resources::Texture2D::SaveTextureToFile(_settings.OutputPath, _computeTextures[_lastTracedFrameIndex].get(), _device);
+
+        auto toMegabytes = [](AccumulationFormat format, uint64_t pixels)
+        {
+            return GetAccumulationBytesPerPixel(format) * pixels / (1024.0 * 1024.0);
+        };
+
+        std::cout << "Accumulation check " << _settings.Width << "x" << _settings.Height << ", " << frameCount << " frames" << std::endl;
+        std::cout << "  half against float rmse " << ComputeImageRmse(halfImage, floatImage) << ", float against reference rmse " << ComputeImageRmse(floatImage, reference) << std::endl;
+        std::cout << "  GPU trace avg " << floatTimings.GpuTraceAvgMs << " ms float, " << halfTimings.GpuTraceAvgMs << " ms half" << std::endl;
+        std::cout << "  accumulation traffic per frame " << toMegabytes(AccumulationFormat::AccumulationFormat_Float32, pixelCount) << " MB float, "
+            << toMegabytes(AccumulationFormat::AccumulationFormat_HalfCompensated, pixelCount) << " MB half, at 3840x2160 "
+            << toMegabytes(AccumulationFormat::AccumulationFormat_Float32, reference4kPixels) << " MB float, "
+            << toMegabytes(AccumulationFormat::AccumulationFormat_HalfCompensated, reference4kPixels) << " MB half" << std::endl;
+        std::cout << "Half accumulation result saved to " << _settings.OutputPath << std::endl;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "RaytracePermutation.hpp"
+
+namespace TracerCore
+{
+    /// @brief Bytes the ray tracing pass reads and writes per pixel and frame to accumulate in the format, both directions counted.
+    /// Frame counts, reprojection copies and the result image are the same for every format and not included.
+    uint32_t GetAccumulationBytesPerPixel(AccumulationFormat format);
+
+    /// @brief Same as DecodeCompensatedMean in Accumulation.glsl, mean and compensation are rgba texels in row order.
+    /// Returns the compensated mean of every texel.
+    std::vector<float> DecodeCompensatedMean(const std::vector<float>& mean, const std::vector<float>& compensation);
+
+    const char* GetAccumulationFormatName(AccumulationFormat format);
+    /// @brief Parses the names of GetAccumulationFormatName, returns false for unknown names.
+    bool ParseAccumulationFormatName(const std::string& name, AccumulationFormat& format);
+}
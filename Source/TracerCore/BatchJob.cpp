@@ -0,0 +1,292 @@
+#include "BatchJob.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <tracy/Tracy.hpp>
+
+#include "Tracer.hpp"
+#include "TracerIO.hpp"
+
+namespace TracerCore
+{
+    static std::runtime_error BatchFileError(const std::string& filePath, uint32_t lineNumber, const std::string& message)
+    {
+        return std::runtime_error("failed to parse batch file " + filePath + " line " + std::to_string(lineNumber) + ": " + message + "!");
+    }
+
+    static void ValidateJob(const BatchJob& job, const std::string& filePath)
+    {
+        if(job.Cameras.empty())
+            throw std::runtime_error("batch job " + job.Name + " in " + filePath + " has no camera!");
+
+        if(job.Width == 0 || job.Height == 0 || job.Samples == 0 || job.SamplesPerFrame == 0)
+            throw std::runtime_error("batch job " + job.Name + " in " + filePath + " has an empty size or sample budget!");
+    }
+
+    std::vector<BatchJob> LoadBatchFile(const std::string &filePath)
+    {
+        std::ifstream file{filePath};
+        if(!file.is_open())
+            throw std::runtime_error("failed to open batch file " + filePath + "!");
+
+        std::vector<BatchJob> jobs;
+        BatchJob job;
+        bool hasJob = false;
+
+        std::string line;
+        uint32_t lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream stream{line};
+            std::string key;
+            if(!(stream >> key))
+                continue;
+
+            if(key == "job")
+            {
+                if(hasJob)
+                {
+                    ValidateJob(job, filePath);
+                    jobs.push_back(job);
+                }
+
+                hasJob = true;
+                job.Cameras.clear();
+                job.OutputPrefix.clear();
+                if(!(stream >> job.Name))
+                    throw BatchFileError(filePath, lineNumber, "job without name");
+
+                continue;
+            }
+
+            if(!hasJob)
+                throw BatchFileError(filePath, lineNumber, key + " before the first job");
+
+            bool valid = true;
+            if(key == "model")
+            {
+                valid = static_cast<bool>(stream >> job.ModelPath);
+            }
+            else if(key == "acc")
+            {
+                std::string name;
+                valid = stream >> name && ParseAccStructureName(name, job.AccStructureType, job.AccHeruishitcType);
+            }
+            else if(key == "size")
+            {
+                valid = stream >> job.Width >> job.Height && job.Width > 0 && job.Height > 0;
+            }
+            else if(key == "samples")
+            {
+                valid = stream >> job.Samples && job.Samples > 0;
+            }
+            else if(key == "spp")
+            {
+                valid = stream >> job.SamplesPerFrame && job.SamplesPerFrame > 0;
+            }
+            else if(key == "bounces")
+            {
+                valid = static_cast<bool>(stream >> job.Bounces);
+            }
+            else if(key == "camera")
+            {
+                CameraPose pose;
+                valid = static_cast<bool>(stream >> pose.Position.x >> pose.Position.y >> pose.Position.z >> pose.Target.x >> pose.Target.y >> pose.Target.z);
+                float fov;
+                if(stream >> fov)
+                {
+                    pose.Fov = fov;
+                }
+                job.Cameras.push_back(pose);
+            }
+            else if(key == "output")
+            {
+                valid = static_cast<bool>(stream >> job.OutputPrefix);
+            }
+            else
+            {
+                throw BatchFileError(filePath, lineNumber, "unknown setting " + key);
+            }
+
+            if(!valid)
+                throw BatchFileError(filePath, lineNumber, "invalid value of " + key);
+        }
+
+        if(hasJob)
+        {
+            ValidateJob(job, filePath);
+            jobs.push_back(job);
+        }
+
+        for (auto& parsedJob : jobs)
+        {
+            if(parsedJob.OutputPrefix.empty())
+            {
+                parsedJob.OutputPrefix = parsedJob.Name;
+            }
+        }
+
+        std::cout << "Loaded " << jobs.size() << " batch jobs from " << filePath << std::endl;
+        return jobs;
+    }
+
+    void SaveBatchReport(const std::string &filePath, const std::string &deviceName, const std::vector<BatchJobResult> &results)
+    {
+        using TracerUtils::IOHelpers;
+
+        std::ofstream file{filePath, std::ios::trunc};
+        if(!file.is_open())
+        {
+            std::cout << "Unable to write batch report to " << filePath << std::endl;
+            return;
+        }
+
+        file << "{\n";
+        file << "  \"device\": " << IOHelpers::ToJsonString(deviceName) << ",\n";
+        file << "  \"jobs\": [\n";
+        for (size_t jobIndex = 0; jobIndex < results.size(); jobIndex++)
+        {
+            const BatchJobResult& result = results[jobIndex];
+            const BatchJob& job = result.Job;
+
+            file << "    {\n";
+            file << "      \"name\": " << IOHelpers::ToJsonString(job.Name) << ",\n";
+            file << "      \"model\": " << IOHelpers::ToJsonString(job.ModelPath) << ",\n";
+            file << "      \"acc\": \"" << GetAccStructureName(job.AccStructureType, job.AccHeruishitcType) << "\",\n";
+            file << "      \"width\": " << job.Width << ",\n";
+            file << "      \"height\": " << job.Height << ",\n";
+            file << "      \"samples\": " << job.GetFrameCount() * job.SamplesPerFrame << ",\n";
+            file << "      \"samplesPerFrame\": " << job.SamplesPerFrame << ",\n";
+            file << "      \"bounces\": " << job.Bounces << ",\n";
+            file << "      \"sceneBuildMs\": " << result.SceneBuildMs << ",\n";
+            file << "      \"renders\": [\n";
+
+            for (size_t renderIndex = 0; renderIndex < result.Timings.size(); renderIndex++)
+            {
+                const RenderTimings& timings = result.Timings[renderIndex];
+                file << "        {"
+                    << "\"image\": " << IOHelpers::ToJsonString(result.ImagePaths[renderIndex]) << ", "
+                    << "\"frames\": " << timings.FrameCount << ", "
+                    << "\"renderMs\": " << timings.RenderMs << ", "
+                    << "\"gpuTraceAvgMs\": " << timings.GpuTraceAvgMs << ", "
+                    << "\"rays\": " << timings.RayCount << ", "
+                    << "\"mraysPerSecond\": " << timings.GetMRaysPerSecond() << "}"
+                    << (renderIndex + 1 < result.Timings.size() ? ",\n" : "\n");
+            }
+
+            file << "      ]\n";
+            file << "    }" << (jobIndex + 1 < results.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n";
+        file << "}\n";
+
+        std::cout << "Batch report saved to " << filePath << std::endl;
+    }
+
+    bool ParseAccStructureName(const std::string &name, AccStructureType &accStructureType, AccHeruishitcType &accHeruishitcType)
+    {
+        if(name == "bvh")
+        {
+            accStructureType = AccStructureType::AccStructure_BVH;
+            accHeruishitcType = AccHeruishitcType::AccHeruishitc_SAH;
+        }
+        else if(name == "bvh-primitive")
+        {
+            accStructureType = AccStructureType::AccStructure_BVH;
+            accHeruishitcType = AccHeruishitcType::AccHeruishitc_Primitive;
+        }
+        else if(name == "kd")
+        {
+            accStructureType = AccStructureType::AccStructure_KdTree;
+            accHeruishitcType = AccHeruishitcType::AccHeruishitc_SAH;
+        }
+        else if(name == "kd-primitive")
+        {
+            accStructureType = AccStructureType::AccStructure_KdTree;
+            accHeruishitcType = AccHeruishitcType::AccHeruishitc_Primitive;
+        }
+        else if(name == "none")
+        {
+            accStructureType = AccStructureType::AccStructure_None;
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    const char *GetAccStructureName(AccStructureType accStructureType, AccHeruishitcType accHeruishitcType)
+    {
+        bool sah = accHeruishitcType == AccHeruishitcType::AccHeruishitc_SAH;
+        switch (accStructureType)
+        {
+        case AccStructureType::AccStructure_BVH: return sah ? "bvh" : "bvh-primitive";
+        case AccStructureType::AccStructure_KdTree: return sah ? "kd" : "kd-primitive";
+        default: return "none";
+        }
+    }
+
+    void Tracer::RunBatch()
+    {
+        std::vector<BatchJob> jobs = LoadBatchFile(_settings.BatchFile);
+
+        //jobs sharing a scene are rendered back to back, every scene is built once
+        std::stable_sort(jobs.begin(), jobs.end(), [](const BatchJob& a, const BatchJob& b)
+        {
+            return std::tie(a.ModelPath, a.AccStructureType, a.AccHeruishitcType) < std::tie(b.ModelPath, b.AccStructureType, b.AccHeruishitcType);
+        });
+
+        std::vector<BatchJobResult> results;
+        const BatchJob* previousJob = nullptr;
+        for (const auto& job : jobs)
+        {
+            ZoneScopedN("BatchJob");
+            BatchJobResult result;
+            result.Job = job;
+
+            if(previousJob == nullptr || !previousJob->SharesScene(job))
+            {
+                result.SceneBuildMs = SwitchScene(job.ModelPath, job.AccStructureType, job.AccHeruishitcType);
+            }
+            previousJob = &job;
+
+            ResizeRenderTargets(job.Width, job.Height);
+
+            RaytracePermutation permutation = _raytracePermutation;
+            permutation.SamplesPerPixel = job.SamplesPerFrame;
+            SetRaytracePermutation(permutation);
+            _frameStats.bounceCount = job.Bounces;
+
+            for (size_t cameraIndex = 0; cameraIndex < job.Cameras.size(); cameraIndex++)
+            {
+                const CameraPose& pose = job.Cameras[cameraIndex];
+                _camera.SetProjection(glm::radians(pose.Fov), job.Width / (float) job.Height, 0.1f, 150.0f);
+                _camera.SetParameters(pose.Position, glm::normalize(pose.Target - pose.Position));
+
+                RenderTimings timings = RenderAccumulated(job.GetFrameCount());
+                std::string imagePath = job.OutputPrefix + "_" + std::to_string(cameraIndex) + ".png";
+                Resources::Texture2D::SaveTextureToFile(imagePath, _computeTextures[_lastTracedFrameIndex].get(), _device);
+
+                std::cout << "Job " << job.Name << " camera " << cameraIndex << ": " << timings.RenderMs << " ms, "
+                    << timings.GetMRaysPerSecond() << " Mrays/s, saved to " << imagePath << std::endl;
+
+                result.ImagePaths.push_back(imagePath);
+                result.Timings.push_back(timings);
+            }
+
+            results.push_back(std::move(result));
+        }
+
+        SaveBatchReport(_settings.ReportPath.empty() ? "BatchReport.json" : _settings.ReportPath, _device.Properties.deviceName, results);
+    }
+}
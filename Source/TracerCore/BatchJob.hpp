@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "TracerScene.hpp"
+
+namespace TracerCore
+{
+    struct CameraPose
+    {
+        glm::vec3 Position;
+        glm::vec3 Target;
+        // vertical field of view in degrees
+        float Fov = 95.0f;
+    };
+
+    /// @brief One offline render of a batch file, rendered once per camera pose.
+    struct BatchJob
+    {
+        std::string Name;
+        std::string ModelPath = "Models\\suzanne.fbx";
+        AccStructureType AccStructureType = AccStructureType::AccStructure_BVH;
+        AccHeruishitcType AccHeruishitcType = AccHeruishitcType::AccHeruishitc_SAH;
+        uint32_t Width = 1024;
+        uint32_t Height = 1024;
+        // accumulated samples per pixel, traced SamplesPerFrame at a time
+        uint32_t Samples = 256;
+        uint32_t SamplesPerFrame = 1;
+        uint32_t Bounces = 16;
+        std::vector<CameraPose> Cameras;
+        // images are written to <OutputPrefix>_<camera index>.png
+        std::string OutputPrefix;
+
+        /// @brief Samples are rounded up to whole frames, every image gets the same budget.
+        inline uint32_t GetFrameCount() const { return (Samples + SamplesPerFrame - 1) / SamplesPerFrame; }
+
+        /// @brief Jobs with the same scene key share one scene build.
+        inline bool SharesScene(const BatchJob& other) const
+        {
+            return ModelPath == other.ModelPath && AccStructureType == other.AccStructureType && AccHeruishitcType == other.AccHeruishitcType;
+        }
+    };
+
+    /// @brief Timings of an accumulated offscreen render.
+    struct RenderTimings
+    {
+        uint32_t FrameCount = 0;
+        float RenderMs = 0.0f;
+        // average of the frames with a GPU timestamp, 0 without timestamp support
+        float GpuTraceAvgMs = 0.0f;
+        // trace pass time of every frame with a GPU timestamp
+        std::vector<float> GpuTraceMs;
+        uint64_t RayCount = 0;
+
+        inline float GetMRaysPerSecond() const { return RenderMs > 0.0f ? RayCount / (RenderMs * 1000.0f) : 0.0f; }
+    };
+
+    struct BatchJobResult
+    {
+        BatchJob Job;
+        // 0 when the scene of the previous job was reused
+        float SceneBuildMs = 0.0f;
+        std::vector<std::string> ImagePaths;
+        std::vector<RenderTimings> Timings;
+    };
+
+    /// @brief Reads a batch file. One setting per line, # starts a comment:
+    ///   job <name>                          starts a job, it inherits every setting except the cameras from the previous job
+    ///   model <path>                        model path relative to the asset folder
+    ///   acc bvh|bvh-primitive|kd|kd-primitive|none
+    ///   size <width> <height>
+    ///   samples <count>                     accumulated samples per pixel
+    ///   spp <count>                         samples per pixel traced in one frame
+    ///   bounces <count>
+    ///   camera <px py pz> <tx ty tz> [fov]  position, target and vertical field of view in degrees
+    ///   output <prefix>                     defaults to the job name
+    std::vector<BatchJob> LoadBatchFile(const std::string& filePath);
+
+    /// @brief Writes the results and timings of a batch run as JSON.
+    void SaveBatchReport(const std::string& filePath, const std::string& deviceName, const std::vector<BatchJobResult>& results);
+
+    bool ParseAccStructureName(const std::string& name, AccStructureType& accStructureType, AccHeruishitcType& accHeruishitcType);
+    const char* GetAccStructureName(AccStructureType accStructureType, AccHeruishitcType accHeruishitcType);
+}
@@ -0,0 +1,188 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+#include <tracy/Tracy.hpp>
+
+#include "Tracer.hpp"
+#include "TracerIO.hpp"
+#include "../TracerUtils/Math/RandomHelper.hpp"
+
+namespace TracerCore
+{
+    const std::vector<BenchmarkScene>& BenchmarkConfig::GetScenes()
+    {
+        //orbits around every bundled model, the suzanne path follows the old camera animation
+        static const std::vector<BenchmarkScene> scenes = {
+            {"Models\\suzanne.fbx", {
+                {glm::vec3(2.2f, 0.3f, 0.3f), glm::vec3(0.0f)},
+                {glm::vec3(0.0f, 0.6f, -2.8f), glm::vec3(0.0f)},
+                {glm::vec3(0.0f, 2.2f, 0.0f), glm::vec3(0.0f, 0.0f, 0.01f)},
+                {glm::vec3(-1.7f, 0.5f, 2.5f), glm::vec3(0.0f)},
+                {glm::vec3(0.0f, 0.4f, 2.8f), glm::vec3(0.0f)},
+            }},
+            {"Models\\teapot.fbx", {
+                {glm::vec3(2.0f, 1.0f, 2.0f), glm::vec3(0.0f)},
+                {glm::vec3(-2.5f, 0.5f, 0.5f), glm::vec3(0.0f)},
+                {glm::vec3(0.5f, 0.2f, -1.4f), glm::vec3(0.3f, 0.0f, 0.0f)},
+            }},
+            {"Models\\Cow.fbx", {
+                {glm::vec3(0.0f, 0.8f, 2.5f), glm::vec3(0.0f)},
+                {glm::vec3(2.5f, 0.5f, 0.0f), glm::vec3(0.0f)},
+                {glm::vec3(-1.2f, 0.3f, -1.2f), glm::vec3(0.0f)},
+            }},
+            {"Models\\Croissant.fbx", {
+                {glm::vec3(1.5f, 1.5f, 1.5f), glm::vec3(0.0f)},
+                {glm::vec3(-2.5f, 0.4f, 0.0f), glm::vec3(0.0f)},
+            }},
+            {"Models\\cube.fbx", {
+                {glm::vec3(2.0f, 1.5f, 2.5f), glm::vec3(0.0f)},
+                {glm::vec3(0.0f, 0.2f, 1.6f), glm::vec3(0.0f)},
+            }},
+        };
+        return scenes;
+    }
+
+    const std::vector<std::pair<AccStructureType, AccHeruishitcType>>& BenchmarkConfig::GetAccStructures()
+    {
+        static const std::vector<std::pair<AccStructureType, AccHeruishitcType>> accStructures = {
+            {AccStructureType::AccStructure_BVH, AccHeruishitcType::AccHeruishitc_SAH},
+            {AccStructureType::AccStructure_KdTree, AccHeruishitcType::AccHeruishitc_SAH},
+            {AccStructureType::AccStructure_None, AccHeruishitcType::AccHeruishitc_SAH},
+        };
+        return accStructures;
+    }
+
+    CameraPose BenchmarkConfig::GetCameraPose(const BenchmarkWaypoint &waypoint, const glm::vec3 &aabbMin, const glm::vec3 &aabbMax)
+    {
+        glm::vec3 center = (aabbMin + aabbMax) * 0.5f;
+        float radius = std::max(glm::length(aabbMax - aabbMin) * 0.5f, 0.001f);
+
+        CameraPose pose;
+        pose.Position = center + waypoint.Position * radius;
+        pose.Target = center + waypoint.Target * radius;
+        return pose;
+    }
+
+    float BenchmarkRecord::GetMRaysPerSecond() const
+    {
+        float gpuMs = std::accumulate(FrameMs.begin(), FrameMs.end(), 0.0f);
+        return gpuMs > 0.0f ? RayCount / (gpuMs * 1000.0f) : 0.0f;
+    }
+
+    float BenchmarkRecord::GetFrameMsPercentile(float percentile) const
+    {
+        if(FrameMs.empty())
+            return 0.0f;
+
+        std::vector<float> sorted = FrameMs;
+        std::sort(sorted.begin(), sorted.end());
+        size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0f * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    void SaveBenchmarkReport(const std::string &filePath, const std::string &label, const std::string &deviceName, uint32_t width, uint32_t height, const std::vector<BenchmarkRecord> &records)
+    {
+        using TracerUtils::IOHelpers;
+
+        std::ofstream file{filePath, std::ios::trunc};
+        if(!file.is_open())
+        {
+            std::cout << "Unable to write benchmark report to " << filePath << std::endl;
+            return;
+        }
+
+        file << "{\n";
+        file << "  \"label\": " << IOHelpers::ToJsonString(label) << ",\n";
+        file << "  \"device\": " << IOHelpers::ToJsonString(deviceName) << ",\n";
+        file << "  \"width\": " << width << ",\n";
+        file << "  \"height\": " << height << ",\n";
+        file << "  \"seed\": " << BenchmarkConfig::SEED << ",\n";
+        file << "  \"framesPerWaypoint\": " << BenchmarkConfig::FRAMES_PER_WAYPOINT << ",\n";
+        file << "  \"records\": [\n";
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            const BenchmarkRecord& record = records[i];
+            file << "    {"
+                << "\"model\": " << IOHelpers::ToJsonString(record.ModelPath) << ", "
+                << "\"acc\": \"" << GetAccStructureName(record.AccStructureType, record.AccHeruishitcType) << "\", "
+                << "\"triangles\": " << record.TriangleCount << ", "
+                << "\"frames\": " << record.FrameMs.size() << ", "
+                << "\"rays\": " << record.RayCount << ", "
+                << "\"mraysPerSecond\": " << record.GetMRaysPerSecond() << ", "
+                << "\"msP50\": " << record.GetFrameMsPercentile(50.0f) << ", "
+                << "\"msP90\": " << record.GetFrameMsPercentile(90.0f) << ", "
+                << "\"msP99\": " << record.GetFrameMsPercentile(99.0f) << ", "
+                << "\"msMax\": " << record.GetFrameMsPercentile(100.0f) << ", "
+                << "\"sceneBuildMs\": " << record.SceneBuildMs << ", "
+                << "\"sceneBytes\": " << record.SceneBytes << ", "
+                << "\"accStructureBytes\": " << record.AccStructureBytes << "}"
+                << (i + 1 < records.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n";
+        file << "}\n";
+
+        std::cout << "Benchmark report saved to " << filePath << std::endl;
+    }
+
+    void Tracer::RunBenchmark()
+    {
+        //CPU frame times include submission and fence waits, only GPU timestamps are comparable between runs
+        if(!_gpuProfiler.IsSupported())
+            throw std::runtime_error("failed to run benchmark, the compute queue has no timestamp support!");
+
+        std::cout << "Benchmark " << _settings.Width << "x" << _settings.Height << ", seed " << BenchmarkConfig::SEED
+            << ", " << BenchmarkConfig::FRAMES_PER_WAYPOINT << " frames per waypoint" << std::endl;
+
+        std::vector<BenchmarkRecord> records;
+        for (const auto& scene : BenchmarkConfig::GetScenes())
+        {
+            for (const auto& [accStructureType, accHeruishitcType] : BenchmarkConfig::GetAccStructures())
+            {
+                ZoneScopedN("BenchmarkRecord");
+                BenchmarkRecord record;
+                record.ModelPath = scene.ModelPath;
+                record.AccStructureType = accStructureType;
+                record.AccHeruishitcType = accHeruishitcType;
+
+                //the materials are random, every variant and every run gets the same ones
+                TracerUtils::Math::TracerRandom::SetSeed(BenchmarkConfig::SEED);
+                record.SceneBuildMs = SwitchScene(scene.ModelPath, accStructureType, accHeruishitcType);
+                record.TriangleCount = _frameStats.TriCount;
+                record.SceneBytes = _device.GetMemoryAllocator().GetCategoryUsage(Resources::MemoryCategory::Scene);
+                record.AccStructureBytes = _device.GetMemoryAllocator().GetCategoryUsage(Resources::MemoryCategory::AccelerationStructure);
+
+                for (size_t i = 0; i < scene.Waypoints.size(); i++)
+                {
+                    CameraPose pose = BenchmarkConfig::GetCameraPose(scene.Waypoints[i], _scene.GetAABBMin(), _scene.GetAABBMax());
+                    _camera.SetProjection(glm::radians(pose.Fov), _settings.Width / (float) _settings.Height, 0.1f, 150.0f);
+                    _camera.SetParameters(pose.Position, glm::normalize(pose.Target - pose.Position));
+
+                    //pipeline variants and caches settle before the first measured frame
+                    if(i == 0)
+                    {
+                        RenderAccumulated(BenchmarkConfig::WARMUP_FRAMES);
+                    }
+
+                    RenderTimings timings = RenderAccumulated(BenchmarkConfig::FRAMES_PER_WAYPOINT);
+                    record.RayCount += timings.RayCount;
+                    record.FrameMs.insert(record.FrameMs.end(), timings.GpuTraceMs.begin(), timings.GpuTraceMs.end());
+                }
+
+                std::cout << scene.ModelPath << " " << GetAccStructureName(accStructureType, accHeruishitcType) << ": "
+                    << record.GetMRaysPerSecond() << " Mrays/s, p50 " << record.GetFrameMsPercentile(50.0f)
+                    << " ms, p99 " << record.GetFrameMsPercentile(99.0f) << " ms, build " << record.SceneBuildMs << " ms" << std::endl;
+
+                records.push_back(std::move(record));
+            }
+        }
+
+        SaveBenchmarkReport(_settings.ReportPath.empty() ? "Benchmark.json" : _settings.ReportPath, _settings.BenchmarkLabel,
+            _device.Properties.deviceName, _settings.Width, _settings.Height, records);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BatchJob.hpp"
+
+namespace TracerCore
+{
+    /// @brief Camera waypoint in scene bounds space, the origin is the center of the scene AABB and 1 is half of its diagonal.
+    struct BenchmarkWaypoint
+    {
+        glm::vec3 Position;
+        glm::vec3 Target;
+    };
+
+    struct BenchmarkScene
+    {
+        const char* ModelPath;
+        std::vector<BenchmarkWaypoint> Waypoints;
+    };
+
+    /// @brief Fixed benchmark settings, changing any of them makes reports of different commits incomparable.
+    struct BenchmarkConfig
+    {
+        // seed of the random scene materials
+        static constexpr uint32_t SEED = 1337;
+        static constexpr uint32_t WARMUP_FRAMES = 8;
+        static constexpr uint32_t FRAMES_PER_WAYPOINT = 32;
+
+        static const std::vector<BenchmarkScene>& GetScenes();
+        static const std::vector<std::pair<AccStructureType, AccHeruishitcType>>& GetAccStructures();
+
+        /// @brief Resolves a waypoint against the bounds of the loaded scene.
+        static CameraPose GetCameraPose(const BenchmarkWaypoint& waypoint, const glm::vec3& aabbMin, const glm::vec3& aabbMax);
+    };
+
+    /// @brief Results of one scene and acceleration structure pair.
+    struct BenchmarkRecord
+    {
+        std::string ModelPath;
+        AccStructureType AccStructureType;
+        AccHeruishitcType AccHeruishitcType;
+        uint32_t TriangleCount = 0;
+        float SceneBuildMs = 0.0f;
+        uint64_t SceneBytes = 0;
+        uint64_t AccStructureBytes = 0;
+        uint64_t RayCount = 0;
+        // GPU trace pass time of every measured frame
+        std::vector<float> FrameMs;
+
+        /// @brief Rays per second of GPU trace time.
+        float GetMRaysPerSecond() const;
+        /// @param percentile in [0, 100], nearest rank
+        float GetFrameMsPercentile(float percentile) const;
+    };
+
+    /// @brief Writes the records as JSON, one record per line so reports of two commits diff line by line.
+    void SaveBenchmarkReport(const std::string& filePath, const std::string& label, const std::string& deviceName, uint32_t width, uint32_t height, const std::vector<BenchmarkRecord>& records);
+}
@@ -0,0 +1,181 @@
+#include "Denoiser.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "Tracer.hpp"
+
+namespace TracerCore
+{
+    static float Luminance(const glm::vec3& color)
+    {
+        return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    }
+
+    static float RoundToHalf(float value)
+    {
+        return glm::unpackHalf1x16(glm::packHalf1x16(value));
+    }
+
+    static glm::vec4 LoadTexel(const std::vector<float>& image, uint32_t width, int x, int y)
+    {
+        size_t index = (static_cast<size_t>(y) * width + x) * 4;
+        return glm::vec4(image[index], image[index + 1], image[index + 2], image[index + 3]);
+    }
+
+    /// @brief Same as DenoiseEdgeWeight in Denoise.glsl.
+    static float EdgeWeight(const glm::vec4& centerGBuffer, const glm::vec4& sampleGBuffer, float centerLuminance, float sampleLuminance, float luminanceScale, float step)
+    {
+        if(sampleGBuffer.w == 0.0f)
+            return 0.0f;
+
+        float normalWeight = std::pow(std::max(glm::dot(glm::vec3(centerGBuffer), glm::vec3(sampleGBuffer)), 0.0f), DENOISE_SIGMA_NORMAL);
+        float depthWeight = std::exp(-std::abs(centerGBuffer.w - sampleGBuffer.w) / (DENOISE_SIGMA_DEPTH * centerGBuffer.w * step + 1e-4f));
+        float luminanceWeight = std::exp(-std::abs(centerLuminance - sampleLuminance) / luminanceScale);
+        return normalWeight * depthWeight * luminanceWeight;
+    }
+
+    std::vector<float> FilterIlluminationReference(const DenoiseInput &input, uint32_t iterationCount)
+    {
+        assert(input.Frame.size() == static_cast<size_t>(input.Width) * input.Height * 4 && "Denoise input does not match its size");
+
+        const float kernelWeights[3] = {3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+        int width = static_cast<int>(input.Width);
+        int height = static_cast<int>(input.Height);
+
+        //iteration 0 of the GPU demodulates while loading, the frame is demodulated up front here
+        std::vector<float> source(input.Frame.size());
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                glm::vec4 frame = LoadTexel(input.Frame, input.Width, x, y);
+                glm::vec3 albedo = glm::vec3(LoadTexel(input.Albedo, input.Width, x, y));
+                float albedoLuminance = std::max(Luminance(albedo), DENOISE_MIN_ALBEDO);
+                glm::vec3 illumination = glm::vec3(frame) / glm::max(albedo, glm::vec3(DENOISE_MIN_ALBEDO));
+
+                size_t index = (static_cast<size_t>(y) * width + x) * 4;
+                source[index] = illumination.r;
+                source[index + 1] = illumination.g;
+                source[index + 2] = illumination.b;
+                source[index + 3] = frame.a / (albedoLuminance * albedoLuminance);
+            }
+        }
+
+        std::vector<float> destination(source.size());
+        for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+        {
+            int step = 1 << iteration;
+
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    size_t index = (static_cast<size_t>(y) * width + x) * 4;
+                    glm::vec4 center = LoadTexel(source, input.Width, x, y);
+                    glm::vec4 centerGBuffer = LoadTexel(input.GBuffer, input.Width, x, y);
+                    glm::vec4 filtered = center;
+
+                    if(centerGBuffer.w != 0.0f)
+                    {
+                        bool spatialVariance = iteration == 0 && center.a < 0.0f;
+                        float variance = 0.0f;
+                        float luminanceMean = 0.0f;
+                        float luminanceSquaredMean = 0.0f;
+                        for (int offsetY = -1; offsetY <= 1; offsetY++)
+                        {
+                            for (int offsetX = -1; offsetX <= 1; offsetX++)
+                            {
+                                float weight = (offsetX == 0 ? 0.5f : 0.25f) * (offsetY == 0 ? 0.5f : 0.25f);
+                                glm::vec4 texel = LoadTexel(source, input.Width, std::clamp(x + offsetX, 0, width - 1), std::clamp(y + offsetY, 0, height - 1));
+                                float luminance = Luminance(glm::vec3(texel));
+                                variance += weight * std::max(texel.a, 0.0f);
+                                luminanceMean += weight * luminance;
+                                luminanceSquaredMean += weight * luminance * luminance;
+                            }
+                        }
+
+                        float centerVariance = spatialVariance ? std::max(luminanceSquaredMean - luminanceMean * luminanceMean, 0.0f) : variance;
+                        float centerLuminance = Luminance(glm::vec3(center));
+                        float luminanceScale = DENOISE_SIGMA_LUMINANCE * std::sqrt(centerVariance) + 1e-4f;
+
+                        glm::vec3 colorSum(0.0f);
+                        float varianceSum = 0.0f;
+                        float weightSum = 0.0f;
+                        for (int offsetY = -2; offsetY <= 2; offsetY++)
+                        {
+                            for (int offsetX = -2; offsetX <= 2; offsetX++)
+                            {
+                                int sampleX = x + offsetX * step;
+                                int sampleY = y + offsetY * step;
+                                if(sampleX < 0 || sampleY < 0 || sampleX >= width || sampleY >= height)
+                                    continue;
+
+                                bool isCenter = offsetX == 0 && offsetY == 0;
+                                glm::vec4 texel = LoadTexel(source, input.Width, sampleX, sampleY);
+                                float weight = kernelWeights[std::abs(offsetX)] * kernelWeights[std::abs(offsetY)];
+                                if(!isCenter)
+                                {
+                                    weight *= EdgeWeight(centerGBuffer, LoadTexel(input.GBuffer, input.Width, sampleX, sampleY), centerLuminance, Luminance(glm::vec3(texel)), luminanceScale, static_cast<float>(step));
+                                }
+
+                                colorSum += weight * glm::vec3(texel);
+                                varianceSum += weight * weight * (spatialVariance ? centerVariance : std::max(texel.a, 0.0f));
+                                weightSum += weight;
+                            }
+                        }
+
+                        filtered = glm::vec4(colorSum / weightSum, varianceSum / (weightSum * weightSum));
+                    }
+
+                    for (int channel = 0; channel < 4; channel++)
+                    {
+                        destination[index + channel] = RoundToHalf(filtered[channel]);
+                    }
+                }
+            }
+
+            std::swap(source, destination);
+        }
+
+        return source;
+    }
+
+    void Tracer::RunDenoiseCheck()
+    {
+        uint32_t frameCount = _settings.FrameCount;
+        uint32_t iterationCount = std::clamp<uint32_t>(_sceneData.DenoiseIterations, 1, DENOISE_MAX_ITERATIONS);
+
+        //the reference is accumulated without the filter, so it does not share its bias
+        _sceneData.Denoiser = false;
+        std::vector<float> reference = RenderReference(frameCount);
+
+        _sceneData.Denoiser = true;
+        RenderTimings timings = RenderAccumulated(frameCount);
+        Resources::Texture2D::SaveTextureToFile(_settings.OutputPath, _computeTextures[_lastTracedFrameIndex].get(), _device);
+
+        DenoiseInput input;
+        input.Width = _gBufferTexture->GetWidth();
+        input.Height = _gBufferTexture->GetHeight();
+        input.Frame = ReadTexture(_denoiseInputTexture.get());
+        input.GBuffer = ReadTexture(_gBufferTexture.get());
+        input.Albedo = ReadTexture(_albedoTexture.get());
+
+        //the last iteration wrote the first image for odd iteration counts
+        std::vector<float> gpuIllumination = ReadTexture(_denoiseTextures[(iterationCount - 1) % 2].get());
+        std::vector<float> cpuIllumination = FilterIlluminationReference(input, iterationCount);
+        //the history image of the last frame holds the denoised color before gamma
+        std::vector<float> denoised = ReadTexture(_denoiseHistoryTextures[_lastTracedFrameIndex].get());
+
+        std::cout << "Denoise check " << input.Width << "x" << input.Height << ", " << frameCount << " frames, " << iterationCount << " iterations" << std::endl;
+        std::cout << "  GPU against CPU reference illumination rmse " << ComputeImageRmse(gpuIllumination, cpuIllumination) << std::endl;
+        std::cout << "  noisy rmse " << ComputeImageRmse(input.Frame, reference) << ", denoised rmse " << ComputeImageRmse(denoised, reference) << std::endl;
+        std::cout << "  GPU denoise avg " << _gpuProfiler.GetStatistics(GpuPass::GpuPass_Denoise).AvgMs << " ms, trace avg " << timings.GpuTraceAvgMs << " ms" << std::endl;
+        std::cout << "Denoised result saved to " << _settings.OutputPath << std::endl;
+    }
+}
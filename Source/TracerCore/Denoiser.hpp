@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace TracerCore
+{
+    // filter constants of the a-trous denoiser, must match Denoise.glsl
+    constexpr float DENOISE_SIGMA_NORMAL = 128.0f;
+    constexpr float DENOISE_SIGMA_DEPTH = 0.02f;
+    constexpr float DENOISE_SIGMA_LUMINANCE = 4.0f;
+    constexpr float DENOISE_MIN_ALBEDO = 0.01f;
+    constexpr uint32_t DENOISE_TEMPORAL_VARIANCE_FRAMES = 4;
+    constexpr uint32_t DENOISE_MAX_ITERATIONS = 8;
+
+    /// @brief Push constants of DenoiseAtrous.comp and DenoiseResolve.comp.
+    struct DenoisePushConstants
+    {
+        // the a-trous step is 1 << Iteration
+        uint32_t Iteration = 0;
+        uint32_t IterationCount = 0;
+        // 0 when the previous history image does not hold the previous frame
+        uint32_t HistoryValid = 0;
+    };
+
+    /// @brief Denoiser inputs written by the ray tracing pass, rgba texels in row order.
+    struct DenoiseInput
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        // rgb frame color, a variance of its mean luminance. Negative below DENOISE_TEMPORAL_VARIANCE_FRAMES accumulated frames
+        std::vector<float> Frame;
+        // xyz first hit normal, w hit distance, 0 for the sky
+        std::vector<float> GBuffer;
+        std::vector<float> Albedo;
+    };
+
+    /// @brief CPU reference of the DenoiseAtrous.comp iterations, for checking the GPU passes.
+    /// Returns the filtered illumination without the albedo, alpha holds its variance. Intermediate images are rounded to half floats like the GPU images.
+    std::vector<float> FilterIlluminationReference(const DenoiseInput& input, uint32_t iterationCount);
+}
@@ -0,0 +1,130 @@
+#include "GpuProfiler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace TracerCore
+{
+    void GpuPassStatistics::AddSample(float elapsedMs)
+    {
+        LastMs = elapsedMs;
+
+        if(SampleCount < HISTORY_SIZE)
+        {
+            History[SampleCount++] = elapsedMs;
+        }
+        else
+        {
+            History[HistoryOffset] = elapsedMs;
+            HistoryOffset = (HistoryOffset + 1) % HISTORY_SIZE;
+        }
+
+        std::array<float, HISTORY_SIZE> sorted;
+        std::copy(History.begin(), History.begin() + SampleCount, sorted.begin());
+        std::sort(sorted.begin(), sorted.begin() + SampleCount);
+
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < SampleCount; i++)
+        {
+            sum += sorted[i];
+        }
+
+        MinMs = sorted[0];
+        AvgMs = sum / SampleCount;
+        P99Ms = sorted[std::min(SampleCount - 1, (SampleCount * 99) / 100)];
+    }
+
+    GpuProfiler::GpuProfiler(VulkanDevice &device, uint32_t slotCount) :
+        _device(device), _timestamps(device, slotCount, static_cast<uint32_t>(GpuPass::GpuPass_Count))
+    {
+#ifdef TRACY_ENABLE
+        _graphicsTracyContext = CreateTracyContext(_device.GetGraphicsQueue(), _device.getCommandPool());
+        TracyVkContextName(_graphicsTracyContext, "Graphics", 8);
+
+        if(_device.HasDedicatedComputeQueue())
+        {
+            _computeTracyContext = CreateTracyContext(_device.GetComputeQueue(), _device.GetComputeCommandPool());
+            TracyVkContextName(_computeTracyContext, "Compute", 7);
+        }
+        else
+        {
+            _computeTracyContext = _graphicsTracyContext;
+        }
+#endif
+    }
+
+    GpuProfiler::~GpuProfiler()
+    {
+#ifdef TRACY_ENABLE
+        if(_computeTracyContext != _graphicsTracyContext)
+        {
+            TracyVkDestroy(_computeTracyContext);
+        }
+        TracyVkDestroy(_graphicsTracyContext);
+#endif
+    }
+
+    void GpuProfiler::ResetPass(VkCommandBuffer commandBuffer, uint32_t slot, GpuPass pass)
+    {
+        _timestamps.Reset(commandBuffer, slot, static_cast<uint32_t>(pass));
+    }
+
+    void GpuProfiler::BeginPass(VkCommandBuffer commandBuffer, uint32_t slot, GpuPass pass)
+    {
+        //waits for the preceding commands, so work of the previous frame on the same queue is not counted
+        _timestamps.WriteBegin(commandBuffer, slot, static_cast<uint32_t>(pass), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    }
+
+    void GpuProfiler::EndPass(VkCommandBuffer commandBuffer, uint32_t slot, GpuPass pass)
+    {
+        _timestamps.WriteEnd(commandBuffer, slot, static_cast<uint32_t>(pass), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+
+    bool GpuProfiler::CollectSlot(uint32_t slot)
+    {
+        bool traceCollected = false;
+        for (uint32_t pass = 0; pass < static_cast<uint32_t>(GpuPass::GpuPass_Count); pass++)
+        {
+            float elapsedMs;
+            if(!_timestamps.TryGetElapsedMs(slot, pass, elapsedMs))
+                continue;
+
+            _statistics[pass].AddSample(elapsedMs);
+            traceCollected |= pass == static_cast<uint32_t>(GpuPass::GpuPass_Trace);
+        }
+
+        return traceCollected;
+    }
+
+    const char *GpuProfiler::GetPassName(GpuPass pass)
+    {
+        switch (pass)
+        {
+        case GpuPass::GpuPass_Trace: return "Trace";
+        case GpuPass::GpuPass_Denoise: return "Denoise";
+        case GpuPass::GpuPass_OnScreen: return "On screen";
+        case GpuPass::GpuPass_UI: return "UI";
+        default: return "Unknown";
+        }
+    }
+
+    TracyVkCtx GpuProfiler::CreateTracyContext(VkQueue queue, VkCommandPool commandPool)
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = commandPool;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        if(vkAllocateCommandBuffers(_device.GetVkDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate profiler command buffer!");
+        }
+
+        //Tracy submits calibration work on this command buffer and waits for it
+        TracyVkCtx context = TracyVkContext(_device.GetPhysicalDevice(), _device.GetVkDevice(), queue, commandBuffer);
+
+        vkFreeCommandBuffers(_device.GetVkDevice(), commandPool, 1, &commandBuffer);
+        return context;
+    }
+}
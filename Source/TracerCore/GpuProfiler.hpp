@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <vulkan/vulkan.h>
+#include <tracy/TracyVulkan.hpp>
+
+#include "VulkanDevice.hpp"
+#include "GpuTimestampPool.hpp"
+
+namespace TracerCore
+{
+    enum class GpuPass : uint32_t
+    {
+        GpuPass_Trace,
+        GpuPass_Denoise,
+        GpuPass_OnScreen,
+        GpuPass_UI,
+        GpuPass_Count
+    };
+
+    /// @brief Rolling window of GPU pass timings.
+    struct GpuPassStatistics
+    {
+        static constexpr uint32_t HISTORY_SIZE = 240;
+
+        // ring buffer, HistoryOffset is the oldest sample
+        std::array<float, HISTORY_SIZE> History{};
+        uint32_t HistoryOffset = 0;
+        uint32_t SampleCount = 0;
+
+        float LastMs = 0.0f;
+        float MinMs = 0.0f;
+        float AvgMs = 0.0f;
+        float P99Ms = 0.0f;
+
+        void AddSample(float elapsedMs);
+    };
+
+    /// @brief GPU timestamps around the passes of a frame. Results of a frame slot are read once its fence has signaled, so reading never stalls.
+    /// With tracy_enable the passes are also exported as Tracy Vulkan zones.
+    class GpuProfiler
+    {
+    public:
+        GpuProfiler(VulkanDevice& device, uint32_t slotCount);
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler &operator=(const GpuProfiler&) = delete;
+
+        /// @brief Must be recorded outside of a render pass, before BeginPass of the same pass.
+        void ResetPass(VkCommandBuffer commandBuffer, uint32_t slot, GpuPass pass);
+        void BeginPass(VkCommandBuffer commandBuffer, uint32_t slot, GpuPass pass);
+        void EndPass(VkCommandBuffer commandBuffer, uint32_t slot, GpuPass pass);
+
+        /// @brief Reads the finished timings of the slot into the statistics.
+        /// @return true when a new trace pass timing was read.
+        bool CollectSlot(uint32_t slot);
+
+        /// @brief Tracy context of the queue the command buffer is submitted to, nullptr without tracy_enable.
+        inline TracyVkCtx GetTracyContext(bool computeQueue) const { return computeQueue ? _computeTracyContext : _graphicsTracyContext; }
+
+        inline const GpuPassStatistics& GetStatistics(GpuPass pass) const { return _statistics[static_cast<uint32_t>(pass)]; }
+        inline bool IsSupported() const { return _timestamps.IsSupported(); }
+
+        static const char* GetPassName(GpuPass pass);
+
+    private:
+        TracyVkCtx CreateTracyContext(VkQueue queue, VkCommandPool commandPool);
+
+        VulkanDevice& _device;
+        GpuTimestampPool _timestamps;
+        std::array<GpuPassStatistics, static_cast<uint32_t>(GpuPass::GpuPass_Count)> _statistics;
+
+        TracyVkCtx _graphicsTracyContext = nullptr;
+        TracyVkCtx _computeTracyContext = nullptr;
+    };
+}
@@ -0,0 +1,93 @@
+#include "GpuTimestampPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <stdexcept>
+
+namespace TracerCore
+{
+    GpuTimestampPool::GpuTimestampPool(VulkanDevice &device, uint32_t slotCount, uint32_t passCount) : 
+        _device(device), _passCount(passCount), _written(slotCount * passCount, false)
+    {
+        _timestampPeriod = _device.Properties.limits.timestampPeriod;
+
+        //ray tracing commands are recorded either on the compute or on the graphics queue, both have to support timestamps
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(_device.GetPhysicalDevice(), &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(_device.GetPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+
+        const QueueFamilyIndices& indices = _device.GetQueueFamilyIndices();
+        uint32_t validBits = std::min(queueFamilies[indices.GraphicsFamily].timestampValidBits, queueFamilies[indices.ComputeFamily].timestampValidBits);
+        _supported = validBits > 0 && _timestampPeriod > 0.0f;
+        _timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+        if(!_supported)
+        {
+            std::cout << "GPU timestamps are not supported by the ray tracing queue" << std::endl;
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = slotCount * passCount * 2;
+
+        if(vkCreateQueryPool(_device.GetVkDevice(), &queryPoolInfo, nullptr, &_queryPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+    }
+
+    GpuTimestampPool::~GpuTimestampPool()
+    {
+        if(_queryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(_device.GetVkDevice(), _queryPool, nullptr);
+        }
+    }
+
+    void GpuTimestampPool::Reset(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t pass)
+    {
+        if(!_supported)
+            return;
+
+        vkCmdResetQueryPool(commandBuffer, _queryPool, GetQueryIndex(slot, pass), 2);
+    }
+
+    void GpuTimestampPool::WriteBegin(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t pass, VkPipelineStageFlagBits stage)
+    {
+        if(!_supported)
+            return;
+
+        vkCmdWriteTimestamp(commandBuffer, stage, _queryPool, GetQueryIndex(slot, pass));
+    }
+
+    void GpuTimestampPool::WriteEnd(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t pass, VkPipelineStageFlagBits stage)
+    {
+        if(!_supported)
+            return;
+
+        vkCmdWriteTimestamp(commandBuffer, stage, _queryPool, GetQueryIndex(slot, pass) + 1);
+        _written[slot * _passCount + pass] = true;
+    }
+
+    bool GpuTimestampPool::TryGetElapsedMs(uint32_t slot, uint32_t pass, float &elapsedMs)
+    {
+        if(!_supported || !_written[slot * _passCount + pass])
+            return false;
+
+        std::array<uint64_t, 2> timestamps;
+        VkResult result = vkGetQueryPoolResults(_device.GetVkDevice(), _queryPool, GetQueryIndex(slot, pass), 2,
+            sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+        if(result != VK_SUCCESS)
+            return false;
+
+        _written[slot * _passCount + pass] = false;
+        uint64_t ticks = (timestamps[1] - timestamps[0]) & _timestampMask;
+        elapsedMs = static_cast<float>(ticks) * _timestampPeriod / 1000000.0f;
+        return true;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VulkanDevice.hpp"
+
+namespace TracerCore
+{
+    /// @brief Pair of GPU timestamps per pass and slot (frame in flight), measures the time between WriteBegin and WriteEnd.
+    class GpuTimestampPool
+    {
+    public:
+        GpuTimestampPool(VulkanDevice& device, uint32_t slotCount, uint32_t passCount = 1);
+        ~GpuTimestampPool();
+
+        GpuTimestampPool(const GpuTimestampPool&) = delete;
+        GpuTimestampPool &operator=(const GpuTimestampPool&) = delete;
+
+        /// @brief Resets the queries of the pass. Must be recorded outside of a render pass before WriteBegin.
+        void Reset(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t pass);
+        void WriteBegin(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t pass, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        void WriteEnd(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t pass, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        /// @brief Reads the last measurement of the slot without waiting, every measurement is returned once.
+        /// @return false when timestamps are unsupported, nothing new was written or the GPU has not finished the slot.
+        bool TryGetElapsedMs(uint32_t slot, uint32_t pass, float& elapsedMs);
+
+        inline bool IsSupported() const { return _supported; }
+
+    private:
+        inline uint32_t GetQueryIndex(uint32_t slot, uint32_t pass) const { return (slot * _passCount + pass) * 2; }
+
+        VulkanDevice& _device;
+        uint32_t _passCount;
+
+        VkQueryPool _queryPool = VK_NULL_HANDLE;
+        std::vector<bool> _written;
+        float _timestampPeriod;
+        uint64_t _timestampMask;
+        bool _supported;
+    };
+}
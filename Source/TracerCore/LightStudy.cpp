@@ -0,0 +1,124 @@
+#include "LightStudy.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "Tracer.hpp"
+#include "TracerIO.hpp"
+#include "../TracerUtils/Math/RandomHelper.hpp"
+
+namespace TracerCore
+{
+    static void PrintRun(const char* name, const LightStudyRun& run)
+    {
+        std::cout << "  " << name << ": " << run.FrameCount << " frames, " << run.TraceMs << " ms, rmse " << run.Rmse << std::endl;
+    }
+
+    void LightStudyResult::Print() const
+    {
+        std::cout << "Light study (" << ModelPath << ")" << std::endl;
+        PrintRun("bsdf", Bsdf);
+        PrintRun("nee", Nee);
+        PrintRun("nee equal time", NeeEqualTime);
+        std::cout << "  equal time error ratio " << GetEqualTimeErrorRatio() << std::endl;
+    }
+
+    static void WriteRun(std::ofstream& file, const LightStudyRun& run)
+    {
+        file << "{\"frames\": " << run.FrameCount << ", \"traceMs\": " << run.TraceMs << ", \"rmse\": " << run.Rmse << "}";
+    }
+
+    void SaveLightStudyReport(const std::string &filePath, const std::string &deviceName, uint32_t width, uint32_t height, const std::vector<LightStudyResult> &results)
+    {
+        std::ofstream file{filePath, std::ios::trunc};
+        if(!file.is_open())
+        {
+            std::cout << "Unable to write light study report to " << filePath << std::endl;
+            return;
+        }
+
+        file << "{\n";
+        file << "  \"device\": " << TracerUtils::IOHelpers::ToJsonString(deviceName) << ",\n";
+        file << "  \"width\": " << width << ",\n";
+        file << "  \"height\": " << height << ",\n";
+        file << "  \"scenes\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const LightStudyResult& result = results[i];
+            file << "    {\"model\": " << TracerUtils::IOHelpers::ToJsonString(result.ModelPath) << ", \"bsdf\": ";
+            WriteRun(file, result.Bsdf);
+            file << ", \"nee\": ";
+            WriteRun(file, result.Nee);
+            file << ", \"neeEqualTime\": ";
+            WriteRun(file, result.NeeEqualTime);
+            file << ", \"equalTimeErrorRatio\": " << result.GetEqualTimeErrorRatio() << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n";
+        file << "}\n";
+
+        std::cout << "Light study saved to " << filePath << std::endl;
+    }
+
+    void Tracer::RunLightStudy()
+    {
+        //equal time needs comparable GPU times, CPU frame times include submission and fence waits
+        if(!_gpuProfiler.IsSupported())
+            throw std::runtime_error("failed to run light study, the compute queue has no timestamp support!");
+
+        uint32_t budget = _settings.FrameCount;
+
+        //the image error needs the same frame count in every pixel
+        _sceneData.AdaptiveSampling = false;
+
+        auto usePermutation = [&](bool nextEventEstimation, SamplerType sampler)
+        {
+            RaytracePermutation permutation = _raytracePermutation;
+            permutation.NextEventEstimation = nextEventEstimation;
+            permutation.Sampler = sampler;
+            SetRaytracePermutation(permutation);
+        };
+
+        std::vector<LightStudyResult> results;
+        for (const auto& scene : BenchmarkConfig::GetScenes())
+        {
+            TracerUtils::Math::TracerRandom::SetSeed(BenchmarkConfig::SEED);
+            SwitchScene(scene.ModelPath, AccStructureType::AccStructure_BVH, AccHeruishitcType::AccHeruishitc_SAH);
+
+            CameraPose pose = BenchmarkConfig::GetCameraPose(scene.Waypoints.front(), _scene.GetAABBMin(), _scene.GetAABBMax());
+            _camera.SetProjection(glm::radians(pose.Fov), _settings.Width / (float) _settings.Height, 0.1f, 150.0f);
+            _camera.SetParameters(pose.Position, glm::normalize(pose.Target - pose.Position));
+
+            //PCG keeps the reference independent of the Sobol sequence of the measured renders
+            usePermutation(true, SamplerType::Sampler_Pcg);
+            std::vector<float> reference = RenderReference(budget, scene.ModelPath);
+
+            auto measure = [&](bool nextEventEstimation, uint32_t frameCount)
+            {
+                usePermutation(nextEventEstimation, SamplerType::Sampler_SobolBlueNoise);
+                RenderTimings timings = RenderAccumulated(frameCount);
+                LightStudyRun run;
+                run.FrameCount = frameCount;
+                run.TraceMs = timings.GpuTraceAvgMs * frameCount;
+                run.Rmse = ComputeImageRmse(ReadAccumulatedImage(frameCount), reference);
+                return run;
+            };
+
+            LightStudyResult result;
+            result.ModelPath = scene.ModelPath;
+            result.Bsdf = measure(false, budget);
+            result.Nee = measure(true, budget);
+
+            float neeFrameMs = result.Nee.TraceMs / budget;
+            uint32_t equalTimeFrames = neeFrameMs > 0.0f ? static_cast<uint32_t>(result.Bsdf.TraceMs / neeFrameMs) : budget;
+            result.NeeEqualTime = measure(true, std::max(equalTimeFrames, 1u));
+
+            result.Print();
+            results.push_back(std::move(result));
+        }
+
+        SaveLightStudyReport(_settings.ReportPath.empty() ? "LightStudy.json" : _settings.ReportPath, _device.Properties.deviceName, 
+            _settings.Width, _settings.Height, results);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TracerCore
+{
+    /// @brief One accumulated render of the light study.
+    struct LightStudyRun
+    {
+        uint32_t FrameCount = 0;
+        // GPU trace pass time of all frames
+        float TraceMs = 0.0f;
+        double Rmse = 0.0;
+    };
+
+    /// @brief BSDF sampling against sky light sampling with MIS on one scene, the reference is a long light sampled PCG render.
+    struct LightStudyResult
+    {
+        std::string ModelPath;
+        LightStudyRun Bsdf;
+        LightStudyRun Nee;
+        // light sampling with as many frames as fit into the trace time of Bsdf
+        LightStudyRun NeeEqualTime;
+
+        /// @brief Below 1 when light sampling has less error at the same GPU time.
+        inline double GetEqualTimeErrorRatio() const { return Bsdf.Rmse > 0.0 ? NeeEqualTime.Rmse / Bsdf.Rmse : 0.0; }
+
+        void Print() const;
+    };
+
+    void SaveLightStudyReport(const std::string& filePath, const std::string& deviceName, uint32_t width, uint32_t height, const std::vector<LightStudyResult>& results);
+}
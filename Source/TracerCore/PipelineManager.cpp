@@ -4,6 +4,9 @@
 #include "TracerIO.hpp"
 
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
 #include <assert.h>
 
 namespace TracerCore
@@ -82,21 +85,129 @@ namespace TracerCore
     PipelineManager::PipelineManager(VulkanDevice &device) :
         _device(device)
     {
+        CreatePipelineCache();
     }
 
     PipelineManager::~PipelineManager()
     {
+        SavePipelineCache();
+
+        for (const auto& [path, shaderModule] : _shaderModules)
+        {
+            vkDestroyShaderModule(_device.GetVkDevice(), shaderModule, nullptr);
+        }
+        _shaderModules.clear();
+
+        vkDestroyPipelineCache(_device.GetVkDevice(), _pipelineCache, nullptr);
+    }
+
+    void PipelineManager::CreatePipelineCache()
+    {
+        std::vector<char> initialData;
+        bool cacheLoaded = ReadPipelineCacheFile(initialData);
+
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = cacheLoaded ? initialData.size() : 0;
+        cacheInfo.pInitialData = cacheLoaded ? initialData.data() : nullptr;
+
+        if(vkCreatePipelineCache(_device.GetVkDevice(), &cacheInfo, nullptr, &_pipelineCache) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+
+        std::cout << "Pipeline cache: " << (cacheLoaded ? "loaded " + std::to_string(initialData.size() / 1024) + " KB" : "cold start") << std::endl;
+    }
+
+    bool PipelineManager::ReadPipelineCacheFile(std::vector<char>& data) const
+    {
+        std::ifstream file{PIPELINE_CACHE_PATH, std::ios::binary};
+        if(!file.is_open())
+        {
+            return false;
+        }
+
+        PipelineCacheFileHeader header{};
+        if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        {
+            return false;
+        }
+
+        //a cache from another GPU or driver is rejected by the driver anyway, skip it early
+        const VkPhysicalDeviceProperties& properties = _device.Properties;
+        if(header.Magic != PIPELINE_CACHE_MAGIC ||
+            header.VendorID != properties.vendorID ||
+            header.DeviceID != properties.deviceID ||
+            header.DriverVersion != properties.driverVersion ||
+            memcmp(header.PipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            std::cout << "Pipeline cache was created by another device or driver, discarding it" << std::endl;
+            return false;
+        }
+
+        //a truncated or corrupted file would size the allocation from garbage, the data has to fill the rest of the file exactly
+        std::streamoff dataStart = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streamoff remaining = file.tellg() - dataStart;
+        if(header.DataSize == 0 || dataStart < 0 || remaining != static_cast<std::streamoff>(header.DataSize))
+        {
+            std::cout << "Pipeline cache file size does not match its header, discarding it" << std::endl;
+            return false;
+        }
+        file.seekg(dataStart);
+
+        data.resize(header.DataSize);
+        if(!file.read(data.data(), header.DataSize))
+        {
+            data.clear();
+            return false;
+        }
+        return true;
+    }
+
+    void PipelineManager::SavePipelineCache() const
+    {
+        size_t dataSize = 0;
+        if(vkGetPipelineCacheData(_device.GetVkDevice(), _pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        {
+            return;
+        }
+
+        std::vector<char> data(dataSize);
+        if(vkGetPipelineCacheData(_device.GetVkDevice(), _pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+        {
+            return;
+        }
+
+        const VkPhysicalDeviceProperties& properties = _device.Properties;
+        PipelineCacheFileHeader header{};
+        header.Magic = PIPELINE_CACHE_MAGIC;
+        header.VendorID = properties.vendorID;
+        header.DeviceID = properties.deviceID;
+        header.DriverVersion = properties.driverVersion;
+        memcpy(header.PipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+        header.DataSize = dataSize;
+
+        std::ofstream file{PIPELINE_CACHE_PATH, std::ios::binary | std::ios::trunc};
+        if(!file.is_open())
+        {
+            std::cout << "Unable to write pipeline cache to " << PIPELINE_CACHE_PATH << std::endl;
+            return;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), dataSize);
     }
 
-    void PipelineManager::CreatePipelineLayout(const VkDescriptorSetLayout& setLayout, VkPipelineLayout *pipelineLayout)
+    void PipelineManager::CreatePipelineLayout(const VkDescriptorSetLayout& setLayout, VkPipelineLayout *pipelineLayout, const std::vector<VkPushConstantRange>& pushConstantRanges)
     {
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutInfo.setLayoutCount = 1; // Optional
         pipelineLayoutInfo.pSetLayouts = &setLayout; // Optional
-        pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-        pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
+        pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+        pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
         if(vkCreatePipelineLayout(_device.GetVkDevice(), &pipelineLayoutInfo, nullptr, pipelineLayout) != VK_SUCCESS) 
         {
             throw std::runtime_error("failed to create pipeline layout!");
@@ -111,16 +222,10 @@ namespace TracerCore
         assert(config.RenderPass != VK_NULL_HANDLE && 
             "Cannot create graphics pipeline! No render pass provided in PipelineConfiguration");
 
-        auto vertexShaderCode = TracerUtils::IOHelpers::ReadFile(vertexShaderPath);
-        auto fragmentShaderCode = TracerUtils::IOHelpers::ReadFile(fragmentShaderPath);
-
-        VkShaderModule vertexShaderModule;
-        VkShaderModule fragmentShaderModule;
-
         VkPipelineShaderStageCreateInfo shaderStages[] = { {}, {} };
 
-        CreatePipleineStage(vertexShaderCode.get(), VK_SHADER_STAGE_VERTEX_BIT, &vertexShaderModule, shaderStages[0]);
-        CreatePipleineStage(fragmentShaderCode.get(), VK_SHADER_STAGE_FRAGMENT_BIT, &fragmentShaderModule, shaderStages[1]);
+        CreatePipleineStage(vertexShaderPath, VK_SHADER_STAGE_VERTEX_BIT, shaderStages[0]);
+        CreatePipleineStage(fragmentShaderPath, VK_SHADER_STAGE_FRAGMENT_BIT, shaderStages[1]);
 
         //auto bindingDescription = Vertex::GetBindingDescription();
         //auto attributeDescriptions = Vertex::GetAttributeDescriptions();
@@ -155,24 +260,35 @@ namespace TracerCore
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if(vkCreateGraphicsPipelines(_device.GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, pipeline) != VK_SUCCESS){
+        if(vkCreateGraphicsPipelines(_device.GetVkDevice(), _pipelineCache, 1, &pipelineInfo, nullptr, pipeline) != VK_SUCCESS){
             throw std::runtime_error("failed to create graphics pipeline");
         }
-
-        vkDestroyShaderModule(_device.GetVkDevice(), vertexShaderModule, nullptr);
-        vkDestroyShaderModule(_device.GetVkDevice(), fragmentShaderModule, nullptr);
     }
 
-    void PipelineManager::CreateComputePipeline(const VkPipelineLayout layout, const std::string &computeShaderPath, VkPipeline* pipeline)
+    void PipelineManager::CreateComputePipeline(const VkPipelineLayout layout, const std::string &computeShaderPath, VkPipeline* pipeline, const VkSpecializationInfo* specializationInfo)
     {
         assert(layout != VK_NULL_HANDLE && 
             "Cannot create graphics pipeline! No pipeline layout provided in PipelineConfiguration");
 
-        auto computeShaderCode = TracerUtils::IOHelpers::ReadFile(computeShaderPath);
-        VkShaderModule computeShaderModule;
         VkPipelineShaderStageCreateInfo computeShaderStage;
 
-        CreatePipleineStage(computeShaderCode.get(), VK_SHADER_STAGE_COMPUTE_BIT, &computeShaderModule, computeShaderStage);
+        CreatePipleineStage(computeShaderPath, VK_SHADER_STAGE_COMPUTE_BIT, computeShaderStage);
+        computeShaderStage.pSpecializationInfo = specializationInfo;
+
+        //Vulkan ignores map entries without a matching constant, SPIR-V compiled before the constants existed would silently run with its literals
+        if(specializationInfo != nullptr)
+        {
+            const std::vector<uint32_t>& declaredIds = _shaderSpecializationIds.at(computeShaderPath);
+            for (uint32_t i = 0; i < specializationInfo->mapEntryCount; i++)
+            {
+                uint32_t constantId = specializationInfo->pMapEntries[i].constantID;
+                if(std::find(declaredIds.begin(), declaredIds.end(), constantId) == declaredIds.end())
+                {
+                    throw std::runtime_error("failed to create compute pipeline, " + computeShaderPath + " has no specialization constant " + 
+                        std::to_string(constantId) + ", recompile the shaders!");
+                }
+            }
+        }
 
         VkComputePipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
@@ -182,11 +298,26 @@ namespace TracerCore
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
         
-        if(vkCreateComputePipelines(_device.GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, pipeline) != VK_SUCCESS){
+        if(vkCreateComputePipelines(_device.GetVkDevice(), _pipelineCache, 1, &pipelineInfo, nullptr, pipeline) != VK_SUCCESS){
             throw std::runtime_error("failed to create graphics pipeline");
         }
+    }
+
+    VkShaderModule PipelineManager::GetShaderModule(const std::string &shaderPath)
+    {
+        auto cached = _shaderModules.find(shaderPath);
+        if(cached != _shaderModules.end())
+        {
+            return cached->second;
+        }
 
-        vkDestroyShaderModule(_device.GetVkDevice(), computeShaderModule, nullptr);
+        auto shaderCode = TracerUtils::IOHelpers::ReadFile(shaderPath);
+        VkShaderModule shaderModule;
+        CreateShaderModule(shaderCode.get(), &shaderModule);
+
+        _shaderModules.emplace(shaderPath, shaderModule);
+        _shaderSpecializationIds.emplace(shaderPath, ReadSpecializationIds(*shaderCode));
+        return shaderModule;
     }
 
     void PipelineManager::CreateShaderModule(const std::vector<char>* code, VkShaderModule *shaderModule)
@@ -202,13 +333,44 @@ namespace TracerCore
         }
     }
 
-    void PipelineManager::CreatePipleineStage(const std::vector<char>* code, const VkShaderStageFlagBits stage, VkShaderModule *shaderModule, VkPipelineShaderStageCreateInfo &shaderStage)
+    std::vector<uint32_t> PipelineManager::ReadSpecializationIds(const std::vector<char>& code)
     {
-        CreateShaderModule(code, shaderModule);
+        const uint32_t SPIRV_MAGIC = 0x07230203;
+        const uint32_t SPIRV_HEADER_WORDS = 5;
+        const uint32_t OP_DECORATE = 71;
+        const uint32_t DECORATION_SPEC_ID = 1;
+
+        std::vector<uint32_t> words(code.size() / sizeof(uint32_t));
+        std::memcpy(words.data(), code.data(), words.size() * sizeof(uint32_t));
 
+        std::vector<uint32_t> ids;
+        if(words.size() < SPIRV_HEADER_WORDS || words[0] != SPIRV_MAGIC)
+            return ids;
+
+        //every instruction starts with its word count in the high and its opcode in the low 16 bits
+        size_t i = SPIRV_HEADER_WORDS;
+        while(i < words.size())
+        {
+            uint32_t wordCount = words[i] >> 16;
+            uint32_t opcode = words[i] & 0xFFFF;
+            if(wordCount == 0 || i + wordCount > words.size())
+                break;
+
+            //OpDecorate <target> SpecId <id>
+            if(opcode == OP_DECORATE && wordCount >= 4 && words[i + 2] == DECORATION_SPEC_ID)
+            {
+                ids.push_back(words[i + 3]);
+            }
+            i += wordCount;
+        }
+        return ids;
+    }
+
+    void PipelineManager::CreatePipleineStage(const std::string& shaderPath, const VkShaderStageFlagBits stage, VkPipelineShaderStageCreateInfo &shaderStage)
+    {
         shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         shaderStage.stage = stage;
-        shaderStage.module = *shaderModule;
+        shaderStage.module = GetShaderModule(shaderPath);
         shaderStage.pName = "main";
         shaderStage.flags = 0;
         shaderStage.pNext = nullptr;
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 #include "VulkanDevice.hpp"
 
@@ -27,9 +28,23 @@ namespace TracerCore
         uint32_t Subpass = 0;
     };
 
+    /// @brief Prefix of the serialized pipeline cache, the driver only validates its own header so the driver version is checked here.
+    struct PipelineCacheFileHeader
+    {
+        uint32_t Magic;
+        uint32_t VendorID;
+        uint32_t DeviceID;
+        uint32_t DriverVersion;
+        uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t DataSize;
+    };
+
     class PipelineManager
     {
     public:
+        static constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x43504C54; // "TLPC"
+        static constexpr const char* PIPELINE_CACHE_PATH = "PipelineCache.bin";
+
         PipelineManager(VulkanDevice& device);
         ~PipelineManager();
 
@@ -38,19 +53,34 @@ namespace TracerCore
 
         static void GetDefaultConfiguration(PipelineConfiguration& config);
 
-        void CreatePipelineLayout(const VkDescriptorSetLayout& setLayout, VkPipelineLayout* pipelineLayout);
+        void CreatePipelineLayout(const VkDescriptorSetLayout& setLayout, VkPipelineLayout* pipelineLayout, 
+            const std::vector<VkPushConstantRange>& pushConstantRanges = {});
 
         void CreateGraphicsPipeline(const PipelineConfiguration& config, const std::string& vertexShaderPath, const std::string& fragmentShaderPath, VkPipeline* pipeline);
-        void CreateComputePipeline(const VkPipelineLayout config, const std::string& computeShaderPath, VkPipeline* pipeline);
+        void CreateComputePipeline(const VkPipelineLayout config, const std::string& computeShaderPath, VkPipeline* pipeline, 
+            const VkSpecializationInfo* specializationInfo = nullptr);
+
+        /// @brief Writes the pipeline cache to disk, so the next start skips shader compilation.
+        void SavePipelineCache() const;
 
     private:
         VulkanDevice& _device;
 
+        VkPipelineCache _pipelineCache = VK_NULL_HANDLE;
+        // shader modules by path, kept alive for the manager lifetime so permutations and recreated pipelines reuse them
+        std::unordered_map<std::string, VkShaderModule> _shaderModules;
+        // specialization constant ids each shader module declares, checked against the map entries of a pipeline
+        std::unordered_map<std::string, std::vector<uint32_t>> _shaderSpecializationIds;
+
+        void CreatePipelineCache();
+        bool ReadPipelineCacheFile(std::vector<char>& data) const;
+
+        VkShaderModule GetShaderModule(const std::string& shaderPath);
         void CreateShaderModule(const std::vector<char>* code, VkShaderModule* shaderModule);
+        static std::vector<uint32_t> ReadSpecializationIds(const std::vector<char>& code);
         void CreatePipleineStage(
-            const std::vector<char>* code, 
+            const std::string& shaderPath, 
             const VkShaderStageFlagBits stage, 
-            VkShaderModule* shaderModule, 
             VkPipelineShaderStageCreateInfo& shaderStage);
     };
 }
\ No newline at end of file
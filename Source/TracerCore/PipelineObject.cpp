@@ -27,9 +27,20 @@ namespace TracerCore
         _pipelineVariants.clear();
     }
     
+    uint32_t PipelineObject::AddPipelineVariant(VkPipeline pipeline)
+    {
+        _pipelineVariants.push_back(pipeline);
+        return static_cast<uint32_t>(_pipelineVariants.size() - 1);
+    }
+
     void PipelineObject::Bind(VkCommandBuffer commandBuffer, int imageIndex)
     {
-        vkCmdBindPipeline(commandBuffer, _bindPoint, _pipelineVariants[_pipelineVariantIndex]);
+        BindVariant(commandBuffer, imageIndex, _pipelineVariantIndex);
+    }
+
+    void PipelineObject::BindVariant(VkCommandBuffer commandBuffer, int imageIndex, uint32_t variantIndex)
+    {
+        vkCmdBindPipeline(commandBuffer, _bindPoint, _pipelineVariants[variantIndex]);
         vkCmdBindDescriptorSets(commandBuffer, _bindPoint, _pipelineLayout, 0, 1, &_descriptorSets[imageIndex], 0, nullptr);
     }
 } // namespace TracerCore
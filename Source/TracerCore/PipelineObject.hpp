@@ -25,9 +25,15 @@ namespace TracerCore
         PipelineObject operator=(const PipelineObject&) = delete;
 
         void Bind(VkCommandBuffer commandBuffer, int imageIndex);
+        /// @brief Binds another variant of the same layout without changing the selected variant.
+        void BindVariant(VkCommandBuffer commandBuffer, int imageIndex, uint32_t variantIndex);
         
         inline const std::vector<VkDescriptorSet>& GetDescriptorSets() const { return _descriptorSets; }
+        inline VkPipelineLayout GetPipelineLayout() const { return _pipelineLayout; }
         inline void SetPipelineVariantIndex(uint32_t index) { _pipelineVariantIndex = index; }
+
+        /// @brief Takes ownership of the pipeline and returns its variant index.
+        uint32_t AddPipelineVariant(VkPipeline pipeline);
     private:
         VulkanDevice& _device;
 
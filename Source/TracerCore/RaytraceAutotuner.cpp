@@ -0,0 +1,184 @@
+#include "RaytraceAutotuner.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+namespace TracerCore
+{
+    static bool IsPowerOfTwo(uint32_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    RaytraceAutotuner::RaytraceAutotuner(const VulkanDevice &device) : _device(device)
+    {
+        LoadResults();
+    }
+
+    RaytraceAutotuner::~RaytraceAutotuner()
+    {
+    }
+
+    void RaytraceAutotuner::Start(const RaytracePermutation &basePermutation)
+    {
+        static const uint32_t workgroupShapes[][2] = {
+            {8, 8}, {16, 8}, {8, 16}, {16, 16}, {32, 4}, {32, 8}, {64, 4}, {32, 16}, {32, 32}
+        };
+
+        const VkPhysicalDeviceLimits& limits = _device.Properties.limits;
+
+        _candidates.clear();
+        for (const auto& shape : workgroupShapes)
+        {
+            if(shape[0] * shape[1] > limits.maxComputeWorkGroupInvocations ||
+                shape[0] > limits.maxComputeWorkGroupSize[0] ||
+                shape[1] > limits.maxComputeWorkGroupSize[1])
+            {
+                continue;
+            }
+
+            for (PixelMapping mapping : {PixelMapping::PixelMapping_Linear, PixelMapping::PixelMapping_Morton})
+            {
+                if(mapping == PixelMapping::PixelMapping_Morton && !(IsPowerOfTwo(shape[0]) && IsPowerOfTwo(shape[1])))
+                    continue;
+
+                Candidate candidate;
+                candidate.Permutation = basePermutation;
+                candidate.Permutation.WorkgroupSizeX = shape[0];
+                candidate.Permutation.WorkgroupSizeY = shape[1];
+                candidate.Permutation.Mapping = mapping;
+                _candidates.push_back(candidate);
+            }
+        }
+
+        _currentCandidate = 0;
+        _bestPermutation = basePermutation;
+        _running = !_candidates.empty();
+
+        std::cout << "Autotune started, " << _candidates.size() << " candidates, " << WARMUP_FRAMES + MEASURED_FRAMES << " frames each" << std::endl;
+    }
+
+    bool RaytraceAutotuner::AddSample(uint32_t candidateIndex, float elapsedMs)
+    {
+        //frames recorded before the switch to the current candidate are still in flight
+        if(!_running || candidateIndex != _currentCandidate)
+            return false;
+
+        Candidate& candidate = _candidates[_currentCandidate];
+        candidate.SampleCount++;
+        if(candidate.SampleCount > WARMUP_FRAMES)
+        {
+            candidate.TotalMs += elapsedMs;
+        }
+
+        if(candidate.SampleCount < WARMUP_FRAMES + MEASURED_FRAMES)
+            return false;
+
+        _currentCandidate++;
+        if(_currentCandidate < _candidates.size())
+            return false;
+
+        Finish();
+        return true;
+    }
+
+    bool RaytraceAutotuner::ApplyBest(RaytracePermutation &permutation) const
+    {
+        for (const auto& entry : _results)
+        {
+            if(!IsCurrentDevice(entry) || entry.Traversal != permutation.Traversal)
+                continue;
+
+            permutation.WorkgroupSizeX = entry.WorkgroupSizeX;
+            permutation.WorkgroupSizeY = entry.WorkgroupSizeY;
+            permutation.Mapping = entry.Mapping;
+            return true;
+        }
+
+        return false;
+    }
+
+    void RaytraceAutotuner::Finish()
+    {
+        _running = false;
+
+        float bestMs = 0.0f;
+        std::cout << "Autotune results (average GPU trace time):" << std::endl;
+        for (const auto& candidate : _candidates)
+        {
+            float averageMs = candidate.TotalMs / MEASURED_FRAMES;
+            std::cout << "  " << std::setw(2) << candidate.Permutation.WorkgroupSizeX << "x" << std::setw(2) << candidate.Permutation.WorkgroupSizeY
+                << (candidate.Permutation.Mapping == PixelMapping::PixelMapping_Morton ? " morton " : " linear ")
+                << averageMs << " ms" << std::endl;
+
+            if(&candidate == &_candidates.front() || averageMs < bestMs)
+            {
+                bestMs = averageMs;
+                _bestPermutation = candidate.Permutation;
+            }
+        }
+
+        std::cout << "Autotune winner: " << _bestPermutation.WorkgroupSizeX << "x" << _bestPermutation.WorkgroupSizeY
+            << (_bestPermutation.Mapping == PixelMapping::PixelMapping_Morton ? " morton" : " linear") << std::endl;
+
+        TunedEntry winner;
+        winner.VendorID = _device.Properties.vendorID;
+        winner.DeviceID = _device.Properties.deviceID;
+        winner.DriverVersion = _device.Properties.driverVersion;
+        winner.Traversal = _bestPermutation.Traversal;
+        winner.WorkgroupSizeX = _bestPermutation.WorkgroupSizeX;
+        winner.WorkgroupSizeY = _bestPermutation.WorkgroupSizeY;
+        winner.Mapping = _bestPermutation.Mapping;
+
+        for (auto it = _results.begin(); it != _results.end(); )
+        {
+            it = IsCurrentDevice(*it) && it->Traversal == winner.Traversal ? _results.erase(it) : it + 1;
+        }
+        _results.push_back(winner);
+
+        SaveResults();
+    }
+
+    void RaytraceAutotuner::LoadResults()
+    {
+        std::ifstream file{RESULTS_PATH};
+        if(!file.is_open())
+            return;
+
+        // vendor device driver traversal sizeX sizeY mapping
+        TunedEntry entry;
+        uint32_t traversal, mapping;
+        while (file >> entry.VendorID >> entry.DeviceID >> entry.DriverVersion >> traversal >> entry.WorkgroupSizeX >> entry.WorkgroupSizeY >> mapping)
+        {
+            entry.Traversal = static_cast<AccStructureType>(traversal);
+            entry.Mapping = static_cast<PixelMapping>(mapping);
+            _results.push_back(entry);
+        }
+    }
+
+    void RaytraceAutotuner::SaveResults() const
+    {
+        std::ofstream file{RESULTS_PATH, std::ios::trunc};
+        if(!file.is_open())
+        {
+            std::cout << "Unable to write autotune results to " << RESULTS_PATH << std::endl;
+            return;
+        }
+
+        for (const auto& entry : _results)
+        {
+            file << entry.VendorID << " " << entry.DeviceID << " " << entry.DriverVersion << " "
+                << static_cast<uint32_t>(entry.Traversal) << " "
+                << entry.WorkgroupSizeX << " " << entry.WorkgroupSizeY << " "
+                << static_cast<uint32_t>(entry.Mapping) << "\n";
+        }
+    }
+
+    bool RaytraceAutotuner::IsCurrentDevice(const TunedEntry &entry) const
+    {
+        return entry.VendorID == _device.Properties.vendorID &&
+            entry.DeviceID == _device.Properties.deviceID &&
+            entry.DriverVersion == _device.Properties.driverVersion;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "VulkanDevice.hpp"
+#include "RaytracePermutation.hpp"
+
+namespace TracerCore
+{
+    /// @brief Benchmarks workgroup shapes and pixel mappings of the ray tracing pass with GPU timestamps.
+    /// The fastest candidate is stored per device, driver and traversal type and applied on the next start.
+    class RaytraceAutotuner
+    {
+    public:
+        static constexpr uint32_t WARMUP_FRAMES = 8;
+        static constexpr uint32_t MEASURED_FRAMES = 24;
+        static constexpr uint32_t NO_CANDIDATE = ~0u;
+        static constexpr const char* RESULTS_PATH = "RaytraceAutotune.txt";
+
+        RaytraceAutotuner(const VulkanDevice& device);
+        ~RaytraceAutotuner();
+
+        RaytraceAutotuner(const RaytraceAutotuner&) = delete;
+        RaytraceAutotuner &operator=(const RaytraceAutotuner&) = delete;
+
+        /// @brief Starts benchmarking candidates derived from basePermutation, only workgroup size and pixel mapping are changed.
+        void Start(const RaytracePermutation& basePermutation);
+
+        /// @brief Adds the GPU time of a frame that was traced with the candidate.
+        /// @return true when this sample finished the tuning, GetBestPermutation holds the winner.
+        bool AddSample(uint32_t candidateIndex, float elapsedMs);
+
+        /// @brief Replaces workgroup size and pixel mapping with the stored result for this device and traversal type.
+        /// @return false when the combination was never tuned.
+        bool ApplyBest(RaytracePermutation& permutation) const;
+
+        inline bool IsRunning() const { return _running; }
+        inline uint32_t GetCandidateIndex() const { return _running ? _currentCandidate : NO_CANDIDATE; }
+        inline const RaytracePermutation& GetCandidatePermutation() const { return _candidates[_currentCandidate].Permutation; }
+        inline const RaytracePermutation& GetBestPermutation() const { return _bestPermutation; }
+
+    private:
+        struct Candidate
+        {
+            RaytracePermutation Permutation;
+            uint32_t SampleCount = 0;
+            float TotalMs = 0.0f;
+        };
+
+        struct TunedEntry
+        {
+            uint32_t VendorID;
+            uint32_t DeviceID;
+            uint32_t DriverVersion;
+            AccStructureType Traversal;
+            uint32_t WorkgroupSizeX;
+            uint32_t WorkgroupSizeY;
+            PixelMapping Mapping;
+        };
+
+        void Finish();
+        void LoadResults();
+        void SaveResults() const;
+        bool IsCurrentDevice(const TunedEntry& entry) const;
+
+        const VulkanDevice& _device;
+
+        std::vector<Candidate> _candidates;
+        uint32_t _currentCandidate = 0;
+        bool _running = false;
+        RaytracePermutation _bestPermutation;
+
+        std::vector<TunedEntry> _results;
+    };
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <vulkan/vulkan.h>
+
+#include "TracerScene.hpp"
+
+namespace TracerCore
+{
+    enum class PixelMapping : uint32_t
+    {
+        PixelMapping_Linear = 0,
+        // Z order inside the workgroup, only valid for power of two workgroup sizes
+        PixelMapping_Morton = 1
+    };
+
+    enum class SamplerType : uint32_t
+    {
+        // white noise, one PCG state per pixel
+        Sampler_Pcg = 0,
+        // Owen scrambled Sobol sequence rotated by blue noise per pixel
+        Sampler_SobolBlueNoise = 1
+    };
+
+    enum class AccumulationFormat : uint32_t
+    {
+        // rgba32f sums of the frames
+        AccumulationFormat_Float32 = 0,
+        // rgba16f running mean with an rgba8 snorm image of its rounding error, see Accumulation.hpp
+        AccumulationFormat_HalfCompensated = 1
+    };
+
+    /// @brief One specialization of the ray tracing compute shader.
+    /// Traversal selects the shader module, the remaining fields are Vulkan specialization constants (see Specialization.glsl).
+    struct RaytracePermutation
+    {
+        static constexpr uint32_t SPECIALIZATION_CONSTANT_COUNT = 13;
+
+        AccStructureType Traversal = AccStructureType::AccStructure_BVH;
+        uint32_t WorkgroupSizeX = 32;
+        uint32_t WorkgroupSizeY = 32;
+        uint32_t MaxStackDepth = 64;
+        // 0 reads the bounce count from the frame data
+        uint32_t MaxBounces = 0;
+        uint32_t SamplesPerPixel = 1;
+        PixelMapping Mapping = PixelMapping::PixelMapping_Linear;
+        // 1 writes per pixel traversal counters into the traversal stats image
+        uint32_t TraversalStats = 0;
+        SamplerType Sampler = SamplerType::Sampler_SobolBlueNoise;
+        // 1 traces only the tiles that are not converged, with an indirect dispatch over the active tile list
+        uint32_t AdaptiveSampling = 0;
+        // 1 samples the sky at diffuse hits and combines it with BSDF sampling through MIS
+        uint32_t NextEventEstimation = 1;
+        // 1 writes the G-buffer and the noisy frame for the denoiser passes instead of the result image
+        uint32_t Denoiser = 0;
+        // 1 counts the accumulated frames per pixel and reprojects the accumulation while the camera moves
+        uint32_t Reprojection = 0;
+        // storage of the accumulation, changing it recreates the accumulation images
+        AccumulationFormat Accumulation = AccumulationFormat::AccumulationFormat_Float32;
+
+        inline bool operator==(const RaytracePermutation& other) const
+        {
+            return Traversal == other.Traversal &&
+                WorkgroupSizeX == other.WorkgroupSizeX &&
+                WorkgroupSizeY == other.WorkgroupSizeY &&
+                MaxStackDepth == other.MaxStackDepth &&
+                MaxBounces == other.MaxBounces &&
+                SamplesPerPixel == other.SamplesPerPixel &&
+                Mapping == other.Mapping &&
+                TraversalStats == other.TraversalStats &&
+                Sampler == other.Sampler &&
+                AdaptiveSampling == other.AdaptiveSampling &&
+                NextEventEstimation == other.NextEventEstimation &&
+                Denoiser == other.Denoiser &&
+                Reprojection == other.Reprojection &&
+                Accumulation == other.Accumulation;
+        }
+
+        inline bool operator!=(const RaytracePermutation& other) const { return !(*this == other); }
+
+        /// @brief The ray tracing pass stores the first hit normal and distance for the denoiser and the reprojection.
+        inline bool WritesGBuffer() const { return Denoiser != 0 || Reprojection != 0; }
+
+        inline const char* GetShaderPath() const
+        {
+            switch (Traversal)
+            {
+            case AccStructureType::AccStructure_KdTree:
+                return "PrecompiledShaders\\RaytraceKdTree.comp.spv";
+            case AccStructureType::AccStructure_None:
+                return "PrecompiledShaders\\RaytraceSimpleLoop.comp.spv";
+            default:
+                return "PrecompiledShaders\\RaytraceBHVTree.comp.spv";
+            }
+        }
+
+        /// @brief Constant values in constant_id order, referenced by GetMapEntries.
+        inline std::array<uint32_t, SPECIALIZATION_CONSTANT_COUNT> GetConstants() const
+        {
+            return {WorkgroupSizeX, WorkgroupSizeY, MaxStackDepth, MaxBounces, SamplesPerPixel, static_cast<uint32_t>(Mapping), TraversalStats, static_cast<uint32_t>(Sampler), AdaptiveSampling, NextEventEstimation, Denoiser, Reprojection, static_cast<uint32_t>(Accumulation)};
+        }
+
+        static inline std::array<VkSpecializationMapEntry, SPECIALIZATION_CONSTANT_COUNT> GetMapEntries()
+        {
+            std::array<VkSpecializationMapEntry, SPECIALIZATION_CONSTANT_COUNT> entries;
+            for (uint32_t i = 0; i < SPECIALIZATION_CONSTANT_COUNT; i++)
+            {
+                entries[i].constantID = i;
+                entries[i].offset = i * sizeof(uint32_t);
+                entries[i].size = sizeof(uint32_t);
+            }
+            return entries;
+        }
+    };
+
+    struct RaytracePermutationHash
+    {
+        inline size_t operator()(const RaytracePermutation& permutation) const
+        {
+            size_t hash = std::hash<uint32_t>()(static_cast<uint32_t>(permutation.Traversal));
+            for (uint32_t constant : permutation.GetConstants())
+            {
+                hash ^= std::hash<uint32_t>()(constant) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            }
+            return hash;
+        }
+    };
+}
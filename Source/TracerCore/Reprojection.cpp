@@ -0,0 +1,58 @@
+#include "Tracer.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+
+namespace TracerCore
+{
+    void Tracer::RunReprojectionCheck()
+    {
+        uint32_t frameCount = _settings.FrameCount;
+        float orbitDegrees = _settings.OrbitDegrees != 0.0f ? _settings.OrbitDegrees : 0.5f;
+
+        //the image error needs the accumulation without filters and tiles
+        _sceneData.AdaptiveSampling = false;
+        _sceneData.Denoiser = false;
+
+        auto resetCamera = [&]()
+        {
+            _camera.SetParameters(DEFAULT_CAMERA_POSITION, glm::normalize(DEFAULT_CAMERA_TARGET - DEFAULT_CAMERA_POSITION));
+        };
+
+        //the reference stands at the pose the orbit ends in, reached by the same rotations
+        glm::vec3 offset = DEFAULT_CAMERA_POSITION - DEFAULT_CAMERA_TARGET;
+        for (uint32_t frame = 1; frame < frameCount; frame++)
+        {
+            offset = glm::rotateY(offset, glm::radians(orbitDegrees));
+        }
+        _camera.SetParameters(DEFAULT_CAMERA_TARGET + offset, glm::normalize(-offset));
+
+        _sceneData.Reprojection = false;
+        std::vector<float> reference = RenderReference(frameCount);
+
+        //without reprojection the last frame of the orbit is a single frame
+        resetCamera();
+        RenderTimings restartTimings = RenderAccumulated(frameCount, orbitDegrees);
+        float restartRmse = ComputeImageRmse(ReadAccumulatedImage(1), reference);
+
+        resetCamera();
+        _sceneData.Reprojection = true;
+        RenderTimings reprojectTimings = RenderAccumulated(frameCount, orbitDegrees);
+        float reprojectRmse = ComputeImageRmse(ReadAccumulatedImage(frameCount), reference);
+        Resources::Texture2D::SaveTextureToFile(_settings.OutputPath, _computeTextures[_lastTracedFrameIndex].get(), _device);
+
+        std::vector<float> pixelFrameCounts = ReadTexture(_accumulationCountTexture.get());
+        double historySum = std::accumulate(pixelFrameCounts.begin(), pixelFrameCounts.end(), 0.0);
+
+        std::cout << "Reprojection check " << _settings.Width << "x" << _settings.Height << ", " << frameCount << " frames, " << orbitDegrees << " degrees per frame" << std::endl;
+        std::cout << "  restarting rmse " << restartRmse << ", reprojected rmse " << reprojectRmse << std::endl;
+        std::cout << "  reprojected frames per pixel avg " << historySum / std::max<size_t>(pixelFrameCounts.size(), 1) << " of " << frameCount << std::endl;
+        std::cout << "  GPU trace avg " << restartTimings.GpuTraceAvgMs << " ms restarting, " << reprojectTimings.GpuTraceAvgMs << " ms reprojected" << std::endl;
+        std::cout << "Reprojected result saved to " << _settings.OutputPath << std::endl;
+    }
+}
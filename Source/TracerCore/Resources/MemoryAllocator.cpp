@@ -0,0 +1,362 @@
+#include "MemoryAllocator.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace TracerCore {
+namespace Resources
+{
+    namespace
+    {
+        uint32_t GetOrder(VkDeviceSize size)
+        {
+            uint32_t order = 0;
+            while ((VkDeviceSize(1) << order) < size)
+            {
+                order++;
+            }
+            return order;
+        }
+    }
+
+    static_assert(MemoryAllocator::BLOCK_SIZE == (VkDeviceSize(1) << 26), "BLOCK_SIZE must match MAX_ORDER");
+    static_assert(MemoryAllocator::MIN_ALLOCATION_SIZE == (VkDeviceSize(1) << 8), "MIN_ALLOCATION_SIZE must match MIN_ORDER");
+
+    MemoryAllocator::MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice) :
+        _device(device)
+    {
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_memoryProperties);
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        _nonCoherentAtomSize = properties.limits.nonCoherentAtomSize;
+    }
+
+    MemoryAllocator::~MemoryAllocator()
+    {
+        for (auto& pool : _pools)
+        {
+            for (auto& block : pool.Blocks)
+            {
+                if(block->Memory == VK_NULL_HANDLE)
+                    continue;
+
+                if(block->AllocationCount > 0)
+                {
+                    std::cerr << "memory allocator: " << block->AllocationCount << " allocations leaked in memory type " << pool.MemoryTypeIndex << std::endl;
+                }
+
+                FreeDeviceMemory(block->Memory, block->MappedData != nullptr);
+            }
+        }
+        _pools.clear();
+    }
+
+    MemoryAllocation MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, MemoryCategory category)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        MemoryAllocation allocation;
+        allocation.MemoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, properties);
+        allocation.Category = category;
+
+        // buddy ranges are aligned to their own size, so rounding up to the alignment satisfies it
+        VkDeviceSize size = std::max({requirements.size, requirements.alignment, MIN_ALLOCATION_SIZE});
+        uint32_t order = GetOrder(size);
+
+        if(order > MAX_ORDER - 1)
+        {
+            // large resources get their own memory object instead of occupying most of a block
+            allocation.Dedicated = true;
+            allocation.Size = requirements.size;
+            allocation.Memory = AllocateDeviceMemory(requirements.size, allocation.MemoryTypeIndex, &allocation.MappedData);
+            _categoryUsage[static_cast<uint32_t>(category)] += allocation.Size;
+            return allocation;
+        }
+
+        allocation.Order = order;
+        allocation.Size = VkDeviceSize(1) << order;
+
+        uint32_t poolIndex = 0;
+        for (; poolIndex < _pools.size(); poolIndex++)
+        {
+            if(_pools[poolIndex].MemoryTypeIndex == allocation.MemoryTypeIndex && _pools[poolIndex].Linear == linear)
+                break;
+        }
+
+        if(poolIndex == _pools.size())
+        {
+            _pools.push_back({allocation.MemoryTypeIndex, linear, {}});
+        }
+
+        auto& pool = _pools[poolIndex];
+        allocation.PoolIndex = poolIndex;
+
+        for (uint32_t blockIndex = 0; blockIndex < pool.Blocks.size(); blockIndex++)
+        {
+            auto& block = *pool.Blocks[blockIndex];
+            if(block.Memory != VK_NULL_HANDLE && TryAllocateFromBlock(block, order, allocation.Offset))
+            {
+                allocation.BlockIndex = blockIndex;
+                allocation.Memory = block.Memory;
+                allocation.MappedData = block.MappedData != nullptr ? static_cast<char*>(block.MappedData) + allocation.Offset : nullptr;
+                block.UsedBytes += allocation.Size;
+                block.AllocationCount++;
+                _categoryUsage[static_cast<uint32_t>(category)] += allocation.Size;
+                return allocation;
+            }
+        }
+
+        // reuse a released block slot so block indices of live allocations stay stable
+        uint32_t blockIndex = 0;
+        for (; blockIndex < pool.Blocks.size(); blockIndex++)
+        {
+            if(pool.Blocks[blockIndex]->Memory == VK_NULL_HANDLE)
+                break;
+        }
+
+        if(blockIndex == pool.Blocks.size())
+        {
+            pool.Blocks.push_back(std::make_unique<BuddyBlock>());
+        }
+
+        auto& block = *pool.Blocks[blockIndex];
+        block.Memory = AllocateDeviceMemory(BLOCK_SIZE, allocation.MemoryTypeIndex, &block.MappedData);
+        block.FreeLists.back().push_back(0);
+
+        if(!TryAllocateFromBlock(block, order, allocation.Offset))
+        {
+            throw std::runtime_error("failed to sub allocate from a new memory block!");
+        }
+
+        allocation.BlockIndex = blockIndex;
+        allocation.Memory = block.Memory;
+        allocation.MappedData = block.MappedData != nullptr ? static_cast<char*>(block.MappedData) + allocation.Offset : nullptr;
+        block.UsedBytes += allocation.Size;
+        block.AllocationCount++;
+        _categoryUsage[static_cast<uint32_t>(category)] += allocation.Size;
+        return allocation;
+    }
+
+    void MemoryAllocator::Free(const MemoryAllocation& allocation)
+    {
+        if(allocation.Memory == VK_NULL_HANDLE)
+            return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _categoryUsage[static_cast<uint32_t>(allocation.Category)] -= allocation.Size;
+
+        if(allocation.Dedicated)
+        {
+            FreeDeviceMemory(allocation.Memory, allocation.MappedData != nullptr);
+            return;
+        }
+
+        auto& block = *_pools[allocation.PoolIndex].Blocks[allocation.BlockIndex];
+        FreeToBlock(block, allocation.Offset, allocation.Order);
+        block.UsedBytes -= allocation.Size;
+        block.AllocationCount--;
+
+        // keep one empty block per pool around to avoid reallocating on every scene reload
+        if(block.AllocationCount == 0)
+        {
+            auto& pool = _pools[allocation.PoolIndex];
+            uint32_t emptyBlocks = 0;
+            for (const auto& other : pool.Blocks)
+            {
+                if(other->Memory != VK_NULL_HANDLE && other->AllocationCount == 0)
+                    emptyBlocks++;
+            }
+
+            if(emptyBlocks > 1)
+            {
+                FreeDeviceMemory(block.Memory, block.MappedData != nullptr);
+                block = BuddyBlock();
+            }
+        }
+    }
+
+    void MemoryAllocator::Flush(const MemoryAllocation& allocation) const
+    {
+        if(allocation.MappedData == nullptr)
+            return;
+
+        if(_memoryProperties.memoryTypes[allocation.MemoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+            return;
+
+        // buddy ranges are at least MIN_ALLOCATION_SIZE aligned which covers nonCoherentAtomSize
+        VkMappedMemoryRange range{};
+        range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        range.memory = allocation.Memory;
+        range.offset = allocation.Offset;
+        range.size = allocation.Dedicated || allocation.Size % _nonCoherentAtomSize != 0 ? VK_WHOLE_SIZE : allocation.Size;
+        vkFlushMappedMemoryRanges(_device, 1, &range);
+    }
+
+    std::vector<MemoryPoolStats> MemoryAllocator::GetPoolStats() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::vector<MemoryPoolStats> stats;
+        for (const auto& pool : _pools)
+        {
+            MemoryPoolStats poolStats{pool.MemoryTypeIndex, pool.Linear, 0, 0, 0, 0, 0};
+            for (const auto& block : pool.Blocks)
+            {
+                if(block->Memory == VK_NULL_HANDLE)
+                    continue;
+
+                poolStats.BlockCount++;
+                poolStats.BlockBytes += BLOCK_SIZE;
+                poolStats.UsedBytes += block->UsedBytes;
+                poolStats.AllocationCount += block->AllocationCount;
+
+                for (uint32_t i = static_cast<uint32_t>(block->FreeLists.size()); i-- > 0;)
+                {
+                    if(!block->FreeLists[i].empty())
+                    {
+                        poolStats.LargestFreeRange = std::max(poolStats.LargestFreeRange, VkDeviceSize(1) << (i + MIN_ORDER));
+                        break;
+                    }
+                }
+            }
+            stats.push_back(poolStats);
+        }
+
+        return stats;
+    }
+
+    void MemoryAllocator::PrintReport() const
+    {
+        std::cout << "GPU memory: " << GetDeviceAllocationCount() << " device allocations" << std::endl;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++)
+        {
+            std::cout << "\t" << GetCategoryName(static_cast<MemoryCategory>(i)) << ": " << _categoryUsage[i] / 1024 << " KB" << std::endl;
+        }
+
+        for (const auto& pool : GetPoolStats())
+        {
+            VkDeviceSize freeBytes = pool.BlockBytes - pool.UsedBytes;
+            // 0 when all free space is one range, close to 1 when it is scattered in small pieces
+            float fragmentation = freeBytes > 0 ? 1.0f - static_cast<float>(pool.LargestFreeRange) / static_cast<float>(freeBytes) : 0.0f;
+            std::cout << "\tpool type " << pool.MemoryTypeIndex << (pool.Linear ? " linear" : " optimal")
+                << ": " << pool.BlockCount << " blocks, " << pool.AllocationCount << " allocations, "
+                << pool.UsedBytes / 1024 << " / " << pool.BlockBytes / 1024 << " KB used, fragmentation " << fragmentation << std::endl;
+        }
+    }
+
+    const char* MemoryAllocator::GetCategoryName(MemoryCategory category)
+    {
+        switch (category)
+        {
+        case MemoryCategory::Scene:
+            return "Scene";
+        case MemoryCategory::AccelerationStructure:
+            return "Acceleration structure";
+        case MemoryCategory::Textures:
+            return "Textures";
+        case MemoryCategory::FrameData:
+            return "Frame data";
+        case MemoryCategory::Staging:
+            return "Staging";
+        default:
+            return "Other";
+        }
+    }
+
+    uint32_t MemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+    {
+        for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++)
+        {
+            if ((typeFilter & (1 << i)) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+
+    VkDeviceMemory MemoryAllocator::AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mappedData)
+    {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+        VkDeviceMemory memory;
+        if (vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate device memory!");
+        }
+
+        *mappedData = nullptr;
+        if(IsHostVisible(memoryTypeIndex))
+        {
+            if (vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, mappedData) != VK_SUCCESS) {
+                throw std::runtime_error("failed to map device memory!");
+            }
+        }
+
+        _deviceAllocationCount++;
+        return memory;
+    }
+
+    void MemoryAllocator::FreeDeviceMemory(VkDeviceMemory memory, bool mapped)
+    {
+        if(mapped)
+        {
+            vkUnmapMemory(_device, memory);
+        }
+
+        vkFreeMemory(_device, memory, nullptr);
+        _deviceAllocationCount--;
+    }
+
+    bool MemoryAllocator::TryAllocateFromBlock(BuddyBlock& block, uint32_t order, VkDeviceSize& offset)
+    {
+        uint32_t level = order - MIN_ORDER;
+        uint32_t freeLevel = level;
+        while (freeLevel < block.FreeLists.size() && block.FreeLists[freeLevel].empty())
+        {
+            freeLevel++;
+        }
+
+        if(freeLevel == block.FreeLists.size())
+            return false;
+
+        offset = block.FreeLists[freeLevel].back();
+        block.FreeLists[freeLevel].pop_back();
+
+        // split down to the requested order, the upper halves become free buddies
+        while (freeLevel > level)
+        {
+            freeLevel--;
+            block.FreeLists[freeLevel].push_back(offset + (VkDeviceSize(1) << (freeLevel + MIN_ORDER)));
+        }
+
+        return true;
+    }
+
+    void MemoryAllocator::FreeToBlock(BuddyBlock& block, VkDeviceSize offset, uint32_t order)
+    {
+        uint32_t level = order - MIN_ORDER;
+        while (level + 1 < block.FreeLists.size())
+        {
+            VkDeviceSize buddy = offset ^ (VkDeviceSize(1) << (level + MIN_ORDER));
+            auto& freeList = block.FreeLists[level];
+            auto it = std::find(freeList.begin(), freeList.end(), buddy);
+            if(it == freeList.end())
+                break;
+
+            // merge with the free buddy and continue one level up
+            *it = freeList.back();
+            freeList.pop_back();
+            offset = std::min(offset, buddy);
+            level++;
+        }
+
+        block.FreeLists[level].push_back(offset);
+    }
+
+}}
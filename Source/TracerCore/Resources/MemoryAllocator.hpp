@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TracerCore {
+namespace Resources
+{
+    enum class MemoryCategory : uint32_t
+    {
+        Scene,
+        AccelerationStructure,
+        Textures,
+        FrameData,
+        Staging,
+        Other,
+        Count
+    };
+
+    /// @brief A sub range of a pooled VkDeviceMemory block, or a dedicated allocation for large resources.
+    struct MemoryAllocation
+    {
+        VkDeviceMemory Memory = VK_NULL_HANDLE;
+        VkDeviceSize Offset = 0;
+        VkDeviceSize Size = 0;
+        // persistently mapped pointer to Offset, nullptr for non host visible memory
+        void* MappedData = nullptr;
+
+        uint32_t MemoryTypeIndex = 0;
+        uint32_t PoolIndex = 0;
+        uint32_t BlockIndex = 0;
+        uint32_t Order = 0;
+        bool Dedicated = false;
+        MemoryCategory Category = MemoryCategory::Other;
+    };
+
+    struct MemoryPoolStats
+    {
+        uint32_t MemoryTypeIndex;
+        bool Linear;
+        uint32_t BlockCount;
+        VkDeviceSize BlockBytes;
+        VkDeviceSize UsedBytes;
+        VkDeviceSize LargestFreeRange;
+        uint32_t AllocationCount;
+    };
+
+    /// @brief Buddy allocator over large VkDeviceMemory blocks, one pool per memory type and tiling.
+    /// Linear resources (buffers) and optimal images live in separate pools so bufferImageGranularity never applies.
+    class MemoryAllocator
+    {
+    public:
+        static constexpr VkDeviceSize BLOCK_SIZE = 64ull * 1024 * 1024;
+        static constexpr VkDeviceSize MIN_ALLOCATION_SIZE = 256;
+
+        MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice);
+        ~MemoryAllocator();
+
+        MemoryAllocator(const MemoryAllocator&) = delete;
+        MemoryAllocator &operator=(const MemoryAllocator&) = delete;
+
+        MemoryAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, MemoryCategory category);
+        void Free(const MemoryAllocation& allocation);
+
+        /// @brief Makes host writes visible to the device for non coherent memory, no-op for coherent memory.
+        void Flush(const MemoryAllocation& allocation) const;
+
+        std::vector<MemoryPoolStats> GetPoolStats() const;
+        inline VkDeviceSize GetCategoryUsage(MemoryCategory category) const { return _categoryUsage[static_cast<uint32_t>(category)]; }
+        inline uint32_t GetDeviceAllocationCount() const { return _deviceAllocationCount; }
+
+        void PrintReport() const;
+
+        static const char* GetCategoryName(MemoryCategory category);
+
+    private:
+        static constexpr uint32_t MIN_ORDER = 8; // 2^8 = MIN_ALLOCATION_SIZE
+        static constexpr uint32_t MAX_ORDER = 26; // 2^26 = BLOCK_SIZE
+
+        struct BuddyBlock
+        {
+            VkDeviceMemory Memory = VK_NULL_HANDLE;
+            void* MappedData = nullptr;
+            VkDeviceSize UsedBytes = 0;
+            uint32_t AllocationCount = 0;
+            // free offsets per order, index 0 is MIN_ORDER
+            std::array<std::vector<VkDeviceSize>, MAX_ORDER - MIN_ORDER + 1> FreeLists;
+        };
+
+        struct MemoryPool
+        {
+            uint32_t MemoryTypeIndex;
+            bool Linear;
+            std::vector<std::unique_ptr<BuddyBlock>> Blocks;
+        };
+
+        uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+        VkDeviceMemory AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mappedData);
+        void FreeDeviceMemory(VkDeviceMemory memory, bool mapped);
+
+        bool TryAllocateFromBlock(BuddyBlock& block, uint32_t order, VkDeviceSize& offset);
+        void FreeToBlock(BuddyBlock& block, VkDeviceSize offset, uint32_t order);
+
+        inline bool IsHostVisible(uint32_t memoryTypeIndex) const
+        {
+            return _memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        }
+
+        VkDevice _device;
+        VkPhysicalDeviceMemoryProperties _memoryProperties;
+        VkDeviceSize _nonCoherentAtomSize;
+
+        std::vector<MemoryPool> _pools;
+        std::array<VkDeviceSize, static_cast<uint32_t>(MemoryCategory::Count)> _categoryUsage{};
+        uint32_t _deviceAllocationCount = 0;
+
+        mutable std::mutex _mutex;
+    };
+
+}}
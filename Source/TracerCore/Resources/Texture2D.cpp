@@ -16,7 +16,8 @@ namespace Resources
         const VkImageCreateInfo &imageInfo,
         VkMemoryPropertyFlags properties,
         VkImage &image,
-        VkDeviceMemory &imageMemory) 
+        MemoryAllocation &allocation,
+        MemoryCategory category) 
     {
         if (vkCreateImage(device.GetVkDevice(), &imageInfo, nullptr, &image) != VK_SUCCESS) {
             throw std::runtime_error("failed to create image!");
@@ -25,16 +26,10 @@ namespace Resources
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(device.GetVkDevice(), image, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = device.FindMemoryType(memRequirements.memoryTypeBits, properties);
+        bool linear = imageInfo.tiling == VK_IMAGE_TILING_LINEAR;
+        allocation = device.GetMemoryAllocator().Allocate(memRequirements, properties, linear, category);
 
-        if (vkAllocateMemory(device.GetVkDevice(), &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate image memory!");
-        }
-
-        if (vkBindImageMemory(device.GetVkDevice(), image, imageMemory, 0) != VK_SUCCESS) {
+        if (vkBindImageMemory(device.GetVkDevice(), image, allocation.Memory, allocation.Offset) != VK_SUCCESS) {
             throw std::runtime_error("failed to bind image memory!");
         }
     }
@@ -45,7 +40,7 @@ namespace Resources
         auto imageData = TracerUtils::IOHelpers::LoadImage(filePath, &texWidth, &texHeight, &texChannels, true);
         VkDeviceSize imageSize = texWidth * texHeight * 4;
 
-        auto stagingBuffer = VulkanBuffer::CreateBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        auto stagingBuffer = VulkanBuffer::CreateBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryCategory::Staging);
         void* data;
         stagingBuffer->MapMemory(imageSize, 0, &data);
             memcpy(data, imageData, static_cast<size_t>(imageSize));
@@ -64,7 +59,7 @@ namespace Resources
     void Texture2D::SaveTextureToFile(const std::string &filePath, Texture2D *texture, VulkanDevice &device)
     {
         VkDeviceSize imageSize = texture->GetWidth() * texture->GetHeight() * 4;
-        std::unique_ptr<VulkanBuffer> stagingBuffer = VulkanBuffer::CreateBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        std::unique_ptr<VulkanBuffer> stagingBuffer = VulkanBuffer::CreateBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryCategory::Staging);
         texture->CopyToBuffer(stagingBuffer.get());
 
         void* data;
@@ -80,7 +75,8 @@ namespace Resources
             VkMemoryPropertyFlags properties,
             VkImageUsageFlags usage,
             bool optimalTiling,
-            VulkanDevice& device
+            VulkanDevice& device,
+            const std::vector<uint32_t>& queueFamilies
     )
     { 
         VkImageCreateInfo imageInfo{};
@@ -99,20 +95,28 @@ namespace Resources
         imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
         imageInfo.flags = 0; // Optional
 
+        //Accessed from several queue families without ownership transfers
+        if(queueFamilies.size() > 1)
+        {
+            imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+            imageInfo.pQueueFamilyIndices = queueFamilies.data();
+        }
+
         VkImage textureImage;
-        VkDeviceMemory textureImageMemory;
+        MemoryAllocation textureAllocation;
         VkImageView textureImageView;
 
-        CreateImageWithInfo(device, imageInfo, properties, textureImage, textureImageMemory);
+        CreateImageWithInfo(device, imageInfo, properties, textureImage, textureAllocation);
         CreateImageView(textureImage, format, VK_IMAGE_ASPECT_COLOR_BIT, textureImageView, device);
 
         VkSampler textureSampler;
         CreateSampler(textureSampler, device);
-        return std::make_unique<Texture2D>(texWidth, texHeight, format, VK_IMAGE_LAYOUT_UNDEFINED, textureImage, textureImageMemory, textureImageView, textureSampler, device);
+        return std::make_unique<Texture2D>(texWidth, texHeight, format, VK_IMAGE_LAYOUT_UNDEFINED, textureImage, textureAllocation, textureImageView, textureSampler, device);
     }
 
-    Texture2D::Texture2D(uint32_t width, uint32_t height, VkFormat format, VkImageLayout layout, VkImage image, VkDeviceMemory imageMemory, VkImageView imageView, VkSampler sampler, VulkanDevice& device)
-        : VulkanResource(device, imageMemory), _width(width), _height(height), _format(format), _currentLayout(layout), _image(image), _imageView(imageView), _sampler(sampler)
+    Texture2D::Texture2D(uint32_t width, uint32_t height, VkFormat format, VkImageLayout layout, VkImage image, const MemoryAllocation& allocation, VkImageView imageView, VkSampler sampler, VulkanDevice& device)
+        : VulkanResource(device, allocation), _width(width), _height(height), _format(format), _currentLayout(layout), _image(image), _imageView(imageView), _sampler(sampler)
     { 
     }
 
@@ -121,16 +125,20 @@ namespace Resources
         vkDestroySampler(_device.GetVkDevice(), _sampler, nullptr);
         vkDestroyImageView(_device.GetVkDevice(), _imageView, nullptr);
         vkDestroyImage(_device.GetVkDevice(), _image, nullptr);
-        vkFreeMemory(_device.GetVkDevice(), _memory, nullptr);
     }
 
     void Texture2D::TransitionImageLayout(VkImageLayout newLayout)
+    {
+        VkCommandBuffer commandBuffer = _device.BeginSingleTimeCommands();
+        RecordTransitionImageLayout(commandBuffer, newLayout);
+        _device.EndSingleTimeCommands(commandBuffer);
+    }
+
+    void Texture2D::RecordTransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout)
     {
         assert(_currentLayout != newLayout);
         assert(newLayout != VK_IMAGE_LAYOUT_UNDEFINED);
 
-        VkCommandBuffer commandBuffer = _device.BeginSingleTimeCommands();
-
         VkImageMemoryBarrier barrier{};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.oldLayout = _currentLayout;
@@ -159,7 +167,6 @@ namespace Resources
             1, &barrier
         );
 
-        _device.EndSingleTimeCommands(commandBuffer);
         _currentLayout = newLayout;
     }
 
@@ -260,7 +267,7 @@ namespace Resources
             stageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
             break;
         case VK_IMAGE_LAYOUT_GENERAL:
-            accessMask = VK_ACCESS_SHADER_READ_BIT;
+            accessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
             stageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
             break;
         default:
@@ -16,7 +16,7 @@ namespace Resources
     class Texture2D : public VulkanResource
     {
     public:
-        Texture2D(uint32_t width, uint32_t height, VkFormat format, VkImageLayout layout, VkImage image, VkDeviceMemory imageMemory, VkImageView imageView, VkSampler sampler, VulkanDevice& device);
+        Texture2D(uint32_t width, uint32_t height, VkFormat format, VkImageLayout layout, VkImage image, const MemoryAllocation& allocation, VkImageView imageView, VkSampler sampler, VulkanDevice& device);
         ~Texture2D();
 
         Texture2D(const Texture2D&) = delete;
@@ -29,21 +29,26 @@ namespace Resources
             VkMemoryPropertyFlags properties,
             VkImageUsageFlags usage,
             bool optimalTiling,
-            VulkanDevice& device);
+            VulkanDevice& device,
+            const std::vector<uint32_t>& queueFamilies = {});
         static std::unique_ptr<Texture2D> LoadFileTexture(const std::string& filePath, VulkanDevice& device);
         static void SaveTextureToFile(const std::string& filePath, Texture2D* texture, VulkanDevice& device);
-        static void CreateImageWithInfo(VulkanDevice &device, const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory);
+        static void CreateImageWithInfo(VulkanDevice &device, const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties, VkImage &image, MemoryAllocation &allocation, 
+            MemoryCategory category = MemoryCategory::Textures);
         
         inline VkImage GetImage() const { return _image; }
         inline VkImageView GetImageView() const { return _imageView; }
         inline VkSampler GetSampler() const { return _sampler; }
-        inline VkDeviceMemory GetImageMemory() const { return _memory; }
+        inline VkDeviceMemory GetImageMemory() const { return _allocation.Memory; }
         inline VkImageLayout GetImageLayout() const { return _currentLayout; }
+        inline VkFormat GetFormat() const { return _format; }
 
         inline uint32_t GetWidth() { return _width; }
         inline uint32_t GetHeight() { return _height; }
         
         void TransitionImageLayout(VkImageLayout newLayout);
+        /// @brief Records the layout transition barrier into commandBuffer instead of submitting it. The layout is tracked in recording order.
+        void RecordTransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout);
 
         void CopyToBuffer(VulkanBuffer* buffer);
     private:
@@ -0,0 +1,250 @@
+#include "UploadManager.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <tracy/Tracy.hpp>
+
+namespace TracerCore {
+namespace Resources
+{
+
+    UploadManager::UploadManager(VulkanDevice &device) : _device(device)
+    {
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = _device.GetQueueFamilyIndices().TransferFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+        if (vkCreateCommandPool(_device.GetVkDevice(), &poolInfo, nullptr, &_commandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload command pool!");
+        }
+
+        std::array<VkCommandBuffer, STAGING_BUFFER_COUNT> commandBuffers;
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = _commandPool;
+        allocInfo.commandBufferCount = STAGING_BUFFER_COUNT;
+
+        if (vkAllocateCommandBuffers(_device.GetVkDevice(), &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate upload command buffers!");
+        }
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        for (uint32_t i = 0; i < STAGING_BUFFER_COUNT; i++)
+        {
+            StagingSlot& slot = _slots[i];
+            slot.Buffer = VulkanBuffer::CreateBuffer(_device, CHUNK_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryCategory::Staging);
+            slot.Buffer->MapMemory(CHUNK_SIZE, 0, &slot.MappedData);
+            slot.CommandBuffer = commandBuffers[i];
+
+            if (vkCreateFence(_device.GetVkDevice(), &fenceInfo, nullptr, &slot.Fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create upload fence!");
+            }
+        }
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        if (vkCreateSemaphore(_device.GetVkDevice(), &semaphoreInfo, nullptr, &_uploadSemaphore) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload semaphore!");
+        }
+
+        VkCommandPoolCreateInfo acquirePoolInfo = {};
+        acquirePoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        acquirePoolInfo.queueFamilyIndex = _device.GetQueueFamilyIndices().ComputeFamily;
+        acquirePoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+        if (vkCreateCommandPool(_device.GetVkDevice(), &acquirePoolInfo, nullptr, &_acquireCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload acquire command pool!");
+        }
+
+        VkCommandBufferAllocateInfo acquireAllocInfo{};
+        acquireAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        acquireAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        acquireAllocInfo.commandPool = _acquireCommandPool;
+        acquireAllocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(_device.GetVkDevice(), &acquireAllocInfo, &_acquireCommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate upload acquire command buffer!");
+        }
+
+        if (vkCreateFence(_device.GetVkDevice(), &fenceInfo, nullptr, &_acquireFence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload acquire fence!");
+        }
+    }
+
+    UploadManager::~UploadManager()
+    {
+        Flush();
+
+        for (auto& slot : _slots)
+        {
+            vkDestroyFence(_device.GetVkDevice(), slot.Fence, nullptr);
+            slot.Buffer = nullptr;
+        }
+
+        vkDestroyFence(_device.GetVkDevice(), _acquireFence, nullptr);
+        vkDestroySemaphore(_device.GetVkDevice(), _uploadSemaphore, nullptr);
+        vkDestroyCommandPool(_device.GetVkDevice(), _acquireCommandPool, nullptr);
+        vkDestroyCommandPool(_device.GetVkDevice(), _commandPool, nullptr);
+    }
+
+    std::unique_ptr<VulkanBuffer> UploadManager::CreateDeviceLocalBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage, MemoryCategory category)
+    {
+        if(size == 0)
+        {
+            throw std::runtime_error("failed to create device local buffer, size is 0!");
+        }
+
+        auto buffer = VulkanBuffer::CreateBuffer(_device, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, category, _device.GetResourceQueueFamilies());
+
+        Upload(buffer.get(), data, size);
+        return buffer;
+    }
+
+    void UploadManager::Upload(VulkanBuffer *dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset)
+    {
+        ZoneScoped;
+
+        if(_pendingChunks == 0)
+        {
+            _uploadStart = std::chrono::high_resolution_clock::now();
+        }
+
+        const uint8_t* src = static_cast<const uint8_t*>(data);
+        VkDeviceSize uploaded = 0;
+        while (uploaded < size)
+        {
+            StagingSlot& slot = _slots[_nextSlot];
+            _nextSlot = (_nextSlot + 1) % STAGING_BUFFER_COUNT;
+
+            // the copy that last used this staging buffer has to finish before it is overwritten
+            WaitForSlot(slot);
+
+            VkDeviceSize chunkSize = std::min(CHUNK_SIZE, size - uploaded);
+            memcpy(slot.MappedData, src + uploaded, chunkSize);
+            slot.Buffer->UnmapMemory();
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            vkBeginCommandBuffer(slot.CommandBuffer, &beginInfo);
+
+            VkBufferCopy copyRegion{};
+            copyRegion.srcOffset = 0;
+            copyRegion.dstOffset = dstOffset + uploaded;
+            copyRegion.size = chunkSize;
+            vkCmdCopyBuffer(slot.CommandBuffer, slot.Buffer->GetBuffer(), dstBuffer->GetBuffer(), 1, &copyRegion);
+
+            vkEndCommandBuffer(slot.CommandBuffer);
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &slot.CommandBuffer;
+
+            if (vkQueueSubmit(_device.GetTransferQueue(), 1, &submitInfo, slot.Fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit upload command buffer!");
+            }
+
+            slot.Pending = true;
+            uploaded += chunkSize;
+            _pendingBytes += chunkSize;
+            _pendingChunks++;
+        }
+    }
+
+    void UploadManager::Flush()
+    {
+        ZoneScoped;
+
+        if(_pendingChunks == 0)
+        {
+            return;
+        }
+
+        AcquireOnComputeQueue();
+
+        for (auto& slot : _slots)
+        {
+            WaitForSlot(slot);
+        }
+
+        auto uploadEnd = std::chrono::high_resolution_clock::now();
+        float seconds = std::chrono::duration<float, std::chrono::seconds::period>(uploadEnd - _uploadStart).count();
+        float megabytes = static_cast<float>(_pendingBytes) / (1024.0f * 1024.0f);
+
+        std::cout << "Uploaded " << megabytes << " MB in " << _pendingChunks << " chunks, " << seconds * 1000.0f << " ms ("
+            << (seconds > 0.0f ? megabytes / seconds : 0.0f) << " MB/s)" << std::endl;
+
+        _pendingBytes = 0;
+        _pendingChunks = 0;
+    }
+
+    void UploadManager::AcquireOnComputeQueue()
+    {
+        //an empty batch signals after every copy submitted before it on the transfer queue
+        VkSubmitInfo signalInfo{};
+        signalInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        signalInfo.signalSemaphoreCount = 1;
+        signalInfo.pSignalSemaphores = &_uploadSemaphore;
+
+        if (vkQueueSubmit(_device.GetTransferQueue(), 1, &signalInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload semaphore signal!");
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(_acquireCommandBuffer, &beginInfo);
+
+        //the semaphore wait only covers this batch, the barrier carries the copies over to every later compute submit
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(_acquireCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 
+            0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkEndCommandBuffer(_acquireCommandBuffer);
+
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo acquireInfo{};
+        acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        acquireInfo.waitSemaphoreCount = 1;
+        acquireInfo.pWaitSemaphores = &_uploadSemaphore;
+        acquireInfo.pWaitDstStageMask = &waitStage;
+        acquireInfo.commandBufferCount = 1;
+        acquireInfo.pCommandBuffers = &_acquireCommandBuffer;
+
+        if (vkQueueSubmit(_device.GetComputeQueue(), 1, &acquireInfo, _acquireFence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload acquire command buffer!");
+        }
+
+        vkWaitForFences(_device.GetVkDevice(), 1, &_acquireFence, VK_TRUE, UINT64_MAX);
+        vkResetFences(_device.GetVkDevice(), 1, &_acquireFence);
+    }
+
+    void UploadManager::WaitForSlot(StagingSlot &slot)
+    {
+        if(!slot.Pending)
+        {
+            return;
+        }
+
+        vkWaitForFences(_device.GetVkDevice(), 1, &slot.Fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(_device.GetVkDevice(), 1, &slot.Fence);
+        slot.Pending = false;
+    }
+
+}}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <chrono>
+#include <memory>
+
+#include "VulkanBuffer.hpp"
+
+namespace TracerCore {
+namespace Resources
+{
+    /// @brief Streams host data into device local buffers through a ring of reusable staging buffers.
+    /// Copies are submitted on the transfer queue chunk by chunk, so filling the next staging buffer overlaps the GPU copy of the previous one.
+    /// Flush hands the copies over to the compute queue with a semaphore, buffers are concurrent across the resource queue families so no ownership transfer is needed.
+    class UploadManager
+    {
+    public:
+        static constexpr VkDeviceSize CHUNK_SIZE = 8ull * 1024 * 1024;
+        static constexpr uint32_t STAGING_BUFFER_COUNT = 3;
+
+        UploadManager(VulkanDevice& device);
+        ~UploadManager();
+
+        UploadManager(const UploadManager&) = delete;
+        UploadManager &operator=(const UploadManager&) = delete;
+
+        /// @brief Creates a device local buffer and queues upload of its content. Call Flush before the buffer is used. Throws for an empty buffer.
+        std::unique_ptr<VulkanBuffer> CreateDeviceLocalBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, MemoryCategory category);
+
+        /// @brief Queues upload of size bytes to dstBuffer. The source memory can be released as soon as the call returns.
+        void Upload(VulkanBuffer* dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+        /// @brief Waits for all queued copies, makes them visible to later compute queue submissions and prints the upload bandwidth.
+        void Flush();
+
+    private:
+        struct StagingSlot
+        {
+            std::unique_ptr<VulkanBuffer> Buffer;
+            void* MappedData = nullptr;
+            VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+            VkFence Fence = VK_NULL_HANDLE;
+            bool Pending = false;
+        };
+
+        void WaitForSlot(StagingSlot& slot);
+        void AcquireOnComputeQueue();
+
+        VulkanDevice& _device;
+
+        VkCommandPool _commandPool;
+        std::array<StagingSlot, STAGING_BUFFER_COUNT> _slots;
+        uint32_t _nextSlot = 0;
+
+        // signaled on the transfer queue after the last copy, waited on by the acquire submit of the compute queue
+        VkSemaphore _uploadSemaphore;
+        VkCommandPool _acquireCommandPool;
+        VkCommandBuffer _acquireCommandBuffer;
+        VkFence _acquireFence;
+
+        VkDeviceSize _pendingBytes = 0;
+        uint32_t _pendingChunks = 0;
+        std::chrono::high_resolution_clock::time_point _uploadStart;
+    };
+
+}}
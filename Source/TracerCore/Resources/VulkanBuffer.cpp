@@ -7,7 +7,7 @@ namespace TracerCore {
 namespace Resources
 {
  
-    std::unique_ptr<VulkanBuffer> VulkanBuffer::CreateBuffer(VulkanDevice &device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+    std::unique_ptr<VulkanBuffer> VulkanBuffer::CreateBuffer(VulkanDevice &device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category, const std::vector<uint32_t>& queueFamilies)
     {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -15,8 +15,15 @@ namespace Resources
         bufferInfo.usage = usage;
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+        // shared between queue families, avoids explicit ownership transfers
+        if(queueFamilies.size() > 1)
+        {
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+            bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+        }
+
         VkBuffer buffer;
-        VkDeviceMemory bufferMemory;
 
         if (vkCreateBuffer(device.GetVkDevice(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to create vertex buffer!");
@@ -25,28 +32,23 @@ namespace Resources
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(device.GetVkDevice(), buffer, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = device.FindMemoryType(memRequirements.memoryTypeBits, properties);
+        MemoryAllocation allocation = device.GetMemoryAllocator().Allocate(memRequirements, properties, true, category);
 
-        if (vkAllocateMemory(device.GetVkDevice(), &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate vertex buffer memory!");
+        if (vkBindBufferMemory(device.GetVkDevice(), buffer, allocation.Memory, allocation.Offset) != VK_SUCCESS) {
+            throw std::runtime_error("failed to bind buffer memory!");
         }
 
-        vkBindBufferMemory(device.GetVkDevice(), buffer, bufferMemory, 0);
-        return std::make_unique<VulkanBuffer>(device, buffer, bufferMemory, size, usage, properties);
+        return std::make_unique<VulkanBuffer>(device, buffer, allocation, size, usage, properties);
     }
 
-    VulkanBuffer::VulkanBuffer(VulkanDevice& device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) : 
-        VulkanResource(device, memory), _buffer(buffer), _size(size), _usage(usage), _properties(properties)
+    VulkanBuffer::VulkanBuffer(VulkanDevice& device, VkBuffer buffer, const MemoryAllocation& allocation, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) : 
+        VulkanResource(device, allocation), _buffer(buffer), _size(size), _usage(usage), _properties(properties)
     {
     }
 
     VulkanBuffer::~VulkanBuffer()
     {
         vkDestroyBuffer(_device.GetVkDevice(), _buffer, nullptr);
-        vkFreeMemory(_device.GetVkDevice(), _memory, nullptr);
     }
 
     void VulkanBuffer::CopyToImage(Texture2D *image)
@@ -71,7 +73,7 @@ namespace Resources
         _device.EndSingleTimeCommands(commandBuffer);
     }
 
-    void VulkanBuffer::CopyToBuffer(VulkanBuffer *dstBuffer)
+    void VulkanBuffer::CopyToBuffer(VulkanBuffer *dstBuffer) const
     {
         VkCommandBuffer commandBuffer = _device.BeginSingleTimeCommands();
 
@@ -83,4 +85,24 @@ namespace Resources
 
         _device.EndSingleTimeCommands(commandBuffer);
     }
+
+    std::vector<uint8_t> VulkanBuffer::ReadBack() const
+    {
+        if((_usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) == 0)
+        {
+            throw std::runtime_error("failed to read back buffer, missing transfer source usage!");
+        }
+
+        auto stagingBuffer = CreateBuffer(_device, _size, 
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
+            MemoryCategory::Staging);
+        CopyToBuffer(stagingBuffer.get());
+
+        void* data;
+        stagingBuffer->MapMemory(_size, 0, &data);
+        std::vector<uint8_t> bytes(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + _size);
+        stagingBuffer->UnmapMemory();
+        return bytes;
+    }
 }}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "VulkanResource.hpp"
 
@@ -12,7 +13,7 @@ namespace Resources
     class VulkanBuffer : public VulkanResource
     {
     public:
-        VulkanBuffer(VulkanDevice& device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+        VulkanBuffer(VulkanDevice& device, VkBuffer buffer, const MemoryAllocation& allocation, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
         ~VulkanBuffer();
 
         VulkanBuffer(const VulkanBuffer&) = delete;
@@ -24,9 +25,13 @@ namespace Resources
         inline VkDeviceSize GetSize() const { return _size; }
 
         void CopyToImage(Texture2D* image);
-        void CopyToBuffer(VulkanBuffer* dstBuffer);
+        void CopyToBuffer(VulkanBuffer* dstBuffer) const;
 
-        static std::unique_ptr<VulkanBuffer> CreateBuffer(VulkanDevice& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+        /// @brief Copies the whole buffer through a staging buffer, the buffer needs VK_BUFFER_USAGE_TRANSFER_SRC_BIT.
+        std::vector<uint8_t> ReadBack() const;
+
+        static std::unique_ptr<VulkanBuffer> CreateBuffer(VulkanDevice& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
+            MemoryCategory category = MemoryCategory::Other, const std::vector<uint32_t>& queueFamilies = {});
 
     private:
         const VkDeviceSize _size;
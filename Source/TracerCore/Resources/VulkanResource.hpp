@@ -1,6 +1,7 @@
 #pragma once
 
 #include "..\VulkanDevice.hpp"
+#include "MemoryAllocator.hpp"
 
 namespace TracerCore {
 namespace Resources
@@ -8,27 +9,38 @@ namespace Resources
     class VulkanResource
     {
     public:
-        virtual ~VulkanResource() = default;
+        virtual ~VulkanResource()
+        {
+            _device.GetMemoryAllocator().Free(_allocation);
+        }
 
         VulkanResource(const VulkanResource&) = delete;
         VulkanResource operator=(const VulkanResource&) = delete;
 
+        /// @brief Returns a pointer into the persistently mapped memory block, no vkMapMemory call is made.
         inline VkResult MapMemory(VkDeviceSize size, VkDeviceSize offset, void** data) const 
         {
-            return vkMapMemory(_device.GetVkDevice(), _memory, offset, size, 0, data);
+            if(_allocation.MappedData == nullptr)
+                return VK_ERROR_MEMORY_MAP_FAILED;
+
+            *data = static_cast<char*>(_allocation.MappedData) + offset;
+            return VK_SUCCESS;
         }
 
+        /// @brief Flushes host writes for non coherent memory. The block itself stays mapped.
         inline void UnmapMemory() const
         {
-            vkUnmapMemory(_device.GetVkDevice(), _memory);
+            _device.GetMemoryAllocator().Flush(_allocation);
         }
 
+        inline const MemoryAllocation& GetAllocation() const { return _allocation; }
+
     protected:
-        VulkanResource(VulkanDevice& device, VkDeviceMemory memory) 
-            : _device(device), _memory(memory) { }
+        VulkanResource(VulkanDevice& device, const MemoryAllocation& allocation) 
+            : _device(device), _allocation(allocation) { }
 
         VulkanDevice& _device;
-        VkDeviceMemory _memory;
+        MemoryAllocation _allocation;
 
     };
 }}
\ No newline at end of file
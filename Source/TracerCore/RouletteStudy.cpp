@@ -0,0 +1,210 @@
+#include "RouletteStudy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "Tracer.hpp"
+#include "TracerIO.hpp"
+
+namespace TracerCore
+{
+    static constexpr uint32_t CPU_STUDY_SIZE = 64;
+    static constexpr uint32_t CPU_STUDY_SEED = 1337;
+    //probability of a bounce to escape to the sky, the rest hits the mesh albedo of the default materials
+    static constexpr float CPU_STUDY_ESCAPE = 0.25f;
+    static const glm::vec3 CPU_STUDY_ALBEDO = glm::vec3(0.83f, 0.65f, 0.92f);
+
+    float GetRouletteSurvivalProbability(const glm::vec3 &throughput)
+    {
+        return glm::clamp(std::max(throughput.r, std::max(throughput.g, throughput.b)), 0.05f, 1.0f);
+    }
+
+    std::vector<uint32_t> GetRouletteStudyMinBounces()
+    {
+        return {0, 1, 2, 3, 4, 6, 8};
+    }
+
+    void RouletteStudyResult::Print() const
+    {
+        std::cout << "Roulette study (" << Domain << ", " << MaxBounces << " bounces, " << SampleCount << " samples)" << std::endl;
+        for (const RouletteStudyRecord& record : Records)
+        {
+            std::cout << "  " << (record.MinBounce == 0 ? std::string("fixed depth") : "from bounce " + std::to_string(record.MinBounce))
+                << ": path length " << record.AveragePathLength << ", rmse " << record.Rmse;
+            if(Domain == "cpu")
+            {
+                std::cout << ", bias " << record.Bias;
+            }
+            if(record.TraceMs > 0.0f)
+            {
+                std::cout << ", " << record.TraceMs << " ms/frame";
+            }
+            std::cout << ", efficiency " << record.GetEfficiency() << std::endl;
+        }
+    }
+
+    //expected radiance of the random walk, the sky is reached after k scattering bounces with probability escape * (1 - escape)^k
+    static glm::dvec3 GetCpuStudyReference(uint32_t maxBounces)
+    {
+        glm::dvec3 reference{0.0};
+        glm::dvec3 scatter = glm::dvec3(CPU_STUDY_ALBEDO) * (1.0 - CPU_STUDY_ESCAPE);
+        glm::dvec3 weight{1.0};
+        for (uint32_t bounce = 0; bounce < maxBounces; bounce++)
+        {
+            reference += weight * static_cast<double>(CPU_STUDY_ESCAPE);
+            weight *= scatter;
+        }
+        return reference;
+    }
+
+    static RouletteStudyRecord MeasureCpuRoulette(uint32_t minBounce, uint32_t maxBounces, uint32_t sampleCount)
+    {
+        std::mt19937 random(CPU_STUDY_SEED);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        glm::dvec3 reference = GetCpuStudyReference(maxBounces);
+
+        RouletteStudyRecord record;
+        record.MinBounce = minBounce;
+
+        uint64_t rayCount = 0;
+        double squaredError = 0.0;
+        glm::dvec3 imageSum{0.0};
+        for (uint32_t pixel = 0; pixel < CPU_STUDY_SIZE * CPU_STUDY_SIZE; pixel++)
+        {
+            glm::dvec3 pixelSum{0.0};
+            for (uint32_t i = 0; i < sampleCount; i++)
+            {
+                //same loop as TraceRay
+                glm::vec3 color{1.0f};
+                for (uint32_t d = 0; d < maxBounces; d++)
+                {
+                    rayCount++;
+                    if(uniform(random) < CPU_STUDY_ESCAPE)
+                    {
+                        pixelSum += glm::dvec3(color);
+                        break;
+                    }
+
+                    color *= CPU_STUDY_ALBEDO;
+                    if(minBounce != 0 && d + 1 >= minBounce)
+                    {
+                        float survival = GetRouletteSurvivalProbability(color);
+                        if(uniform(random) >= survival)
+                            break;
+                        color /= survival;
+                    }
+                }
+            }
+
+            glm::dvec3 error = pixelSum / static_cast<double>(sampleCount) - reference;
+            squaredError += glm::dot(error, error);
+            imageSum += pixelSum;
+        }
+
+        double pixelCount = CPU_STUDY_SIZE * CPU_STUDY_SIZE;
+        glm::dvec3 bias = imageSum / (pixelCount * sampleCount) - reference;
+        record.AveragePathLength = rayCount / (pixelCount * sampleCount);
+        record.Rmse = std::sqrt(squaredError / (pixelCount * 3));
+        record.Bias = (bias.x + bias.y + bias.z) / 3.0;
+        return record;
+    }
+
+    RouletteStudyResult RunCpuRouletteStudy(uint32_t maxBounces, uint32_t sampleCount)
+    {
+        RouletteStudyResult result;
+        result.Domain = "cpu";
+        result.MaxBounces = maxBounces;
+        result.SampleCount = sampleCount;
+        for (uint32_t minBounce : GetRouletteStudyMinBounces())
+        {
+            result.Records.push_back(MeasureCpuRoulette(minBounce, maxBounces, sampleCount));
+        }
+        return result;
+    }
+
+    void SaveRouletteStudyReport(const std::string &filePath, const std::string &deviceName, const std::vector<RouletteStudyResult> &results)
+    {
+        std::ofstream file{filePath, std::ios::trunc};
+        if(!file.is_open())
+        {
+            std::cout << "Unable to write roulette study report to " << filePath << std::endl;
+            return;
+        }
+
+        file << "{\n";
+        file << "  \"device\": " << TracerUtils::IOHelpers::ToJsonString(deviceName) << ",\n";
+        file << "  \"studies\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const RouletteStudyResult& result = results[i];
+            file << "    {\n";
+            file << "      \"domain\": \"" << result.Domain << "\",\n";
+            file << "      \"maxBounces\": " << result.MaxBounces << ",\n";
+            file << "      \"samples\": " << result.SampleCount << ",\n";
+            file << "      \"records\": [\n";
+            for (size_t j = 0; j < result.Records.size(); j++)
+            {
+                const RouletteStudyRecord& record = result.Records[j];
+                file << "        {\"minBounce\": " << record.MinBounce
+                    << ", \"pathLength\": " << record.AveragePathLength
+                    << ", \"rmse\": " << record.Rmse
+                    << ", \"bias\": " << record.Bias
+                    << ", \"traceMs\": " << record.TraceMs
+                    << ", \"efficiency\": " << record.GetEfficiency() << "}"
+                    << (j + 1 < result.Records.size() ? ",\n" : "\n");
+            }
+            file << "      ]\n";
+            file << "    }" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n";
+        file << "}\n";
+
+        std::cout << "Roulette study saved to " << filePath << std::endl;
+    }
+
+    void Tracer::RunRouletteStudy()
+    {
+        uint32_t budget = _settings.FrameCount;
+        uint32_t samplesPerFrame = _raytracePermutation.SamplesPerPixel;
+        uint32_t maxBounces = _raytracePermutation.MaxBounces > 0 ? _raytracePermutation.MaxBounces : _frameStats.bounceCount;
+
+        std::vector<RouletteStudyResult> results;
+        results.push_back(RunCpuRouletteStudy(maxBounces, budget * samplesPerFrame));
+        results.back().Print();
+
+        //the image error needs the same frame count in every pixel
+        _sceneData.AdaptiveSampling = false;
+
+        //fixed depth tracing is the reference, so a biased roulette shows up in the error
+        _frameStats.rouletteMinBounce = 0;
+        std::vector<float> reference = RenderReference(budget);
+
+        auto extent = GetRenderExtent();
+        double samplesPerPass = static_cast<double>(extent.width) * extent.height * samplesPerFrame * budget;
+
+        RouletteStudyResult gpuResult;
+        gpuResult.Domain = "gpu";
+        gpuResult.MaxBounces = maxBounces;
+        gpuResult.SampleCount = budget * samplesPerFrame;
+        for (uint32_t minBounce : GetRouletteStudyMinBounces())
+        {
+            _frameStats.rouletteMinBounce = minBounce;
+            RenderTimings timings = RenderAccumulated(budget);
+
+            RouletteStudyRecord record;
+            record.MinBounce = minBounce;
+            record.AveragePathLength = timings.RayCount / samplesPerPass;
+            record.Rmse = ComputeImageRmse(ReadAccumulatedImage(budget), reference);
+            record.TraceMs = timings.GpuTraceAvgMs;
+            gpuResult.Records.push_back(record);
+        }
+        gpuResult.Print();
+        results.push_back(std::move(gpuResult));
+
+        _frameStats.rouletteMinBounce = _settings.RouletteMinBounce;
+        SaveRouletteStudyReport(_settings.ReportPath.empty() ? "RouletteStudy.json" : _settings.ReportPath, _device.Properties.deviceName, results);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace TracerCore
+{
+    /// @brief Survival probability of a path with the given throughput, same as RouletteSurvivalProbability in RaytracingPass.glsl.
+    float GetRouletteSurvivalProbability(const glm::vec3& throughput);
+
+    /// @brief Russian roulette settings the study compares, 0 is fixed depth tracing.
+    std::vector<uint32_t> GetRouletteStudyMinBounces();
+
+    struct RouletteStudyRecord
+    {
+        // bounce after which paths can be terminated, 0 traces every path to the bounce limit
+        uint32_t MinBounce = 0;
+        // rays per sample
+        double AveragePathLength = 0.0;
+        double Rmse = 0.0;
+        // mean minus reference over the image, close to 0 for an unbiased estimator. Only known on the CPU
+        double Bias = 0.0;
+        // average trace pass time per frame, 0 on the CPU
+        float TraceMs = 0.0f;
+
+        /// @brief Inverse of error times cost, GPU time when measured and path length otherwise.
+        inline double GetEfficiency() const
+        {
+            double cost = TraceMs > 0.0f ? TraceMs : AveragePathLength;
+            return Rmse > 0.0 && cost > 0.0 ? 1.0 / (Rmse * Rmse * cost) : 0.0;
+        }
+    };
+
+    struct RouletteStudyResult
+    {
+        // "cpu" for the analytic random walk, "gpu" for the ray tracing pass
+        std::string Domain;
+        uint32_t MaxBounces = 0;
+        uint32_t SampleCount = 0;
+        std::vector<RouletteStudyRecord> Records;
+
+        void Print() const;
+    };
+
+    /// @brief CPU reference: a 64x64 image of random walks with the bounce loop of TraceRay. Every bounce escapes to a sky
+    /// of radiance 1 with a fixed probability and otherwise scatters with a fixed albedo, so the expected value is known in closed form.
+    RouletteStudyResult RunCpuRouletteStudy(uint32_t maxBounces, uint32_t sampleCount);
+
+    void SaveRouletteStudyReport(const std::string& filePath, const std::string& deviceName, const std::vector<RouletteStudyResult>& results);
+}
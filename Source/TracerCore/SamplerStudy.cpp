@@ -0,0 +1,220 @@
+#include "SamplerStudy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <glm/glm.hpp>
+
+#include "Tracer.hpp"
+#include "TracerIO.hpp"
+#include "../TracerUtils/Math/LowDiscrepancy.hpp"
+
+namespace TracerCore
+{
+    static constexpr uint32_t CPU_STUDY_SIZE = 64;
+
+    double SamplerConvergence::GetEqualErrorSamples(double targetRmse) const
+    {
+        for (size_t i = 0; i < Rmse.size(); i++)
+        {
+            if(Rmse[i] > targetRmse)
+                continue;
+
+            if(i == 0 || Rmse[i] <= 0.0)
+                return SampleCounts[i];
+
+            double t = (std::log(targetRmse) - std::log(Rmse[i - 1])) / (std::log(Rmse[i]) - std::log(Rmse[i - 1]));
+            return std::exp(std::log(SampleCounts[i - 1]) + t * (std::log(SampleCounts[i]) - std::log(SampleCounts[i - 1])));
+        }
+
+        return 0.0;
+    }
+
+    void SamplerStudyResult::Print() const
+    {
+        std::cout << "Sampler study (" << Domain << ")" << std::endl;
+        for (size_t i = 0; i < Pcg.SampleCounts.size(); i++)
+        {
+            std::cout << "  " << Pcg.SampleCounts[i] << " samples: rmse " << GetSamplerName(Pcg.Sampler) << " " << Pcg.Rmse[i]
+                << ", " << GetSamplerName(Sobol.Sampler) << " " << Sobol.Rmse[i] << std::endl;
+        }
+
+        double equalErrorSamples = GetEqualErrorSamples();
+        std::cout << "  " << GetSamplerName(Sobol.Sampler) << " reaches the error of " << Budget << " " << GetSamplerName(Pcg.Sampler) << " samples ";
+        if(equalErrorSamples > 0.0)
+        {
+            std::cout << "after " << equalErrorSamples << " samples" << std::endl;
+        }
+        else
+        {
+            std::cout << "not within " << Budget << " samples" << std::endl;
+        }
+    }
+
+    //quarter disk indicator * (0.5 + xy) * clamped cosine of a uniform sphere direction, the product of the three expectations
+    static constexpr double CPU_STUDY_REFERENCE = 3.14159265358979 / 4.0 * 0.75 * 0.25;
+
+    template<typename Sampler>
+    static SamplerConvergence MeasureCpuSampler(Sampler& sampler, SamplerType samplerType, uint32_t budget)
+    {
+        SamplerConvergence convergence;
+        convergence.Sampler = samplerType;
+
+        for (uint32_t sampleCount = 1; sampleCount <= budget; sampleCount *= 2)
+        {
+            double squaredError = 0.0;
+            for (uint32_t y = 0; y < CPU_STUDY_SIZE; y++)
+            {
+                for (uint32_t x = 0; x < CPU_STUDY_SIZE; x++)
+                {
+                    double sum = 0.0;
+                    for (uint32_t i = 0; i < sampleCount; i++)
+                    {
+                        sampler.Init(glm::ivec2(x, y), i, 0);
+                        glm::vec2 disk = sampler.Sample2D();
+                        glm::vec2 smooth = sampler.Sample2D();
+                        glm::vec2 sphere = sampler.Sample2D();
+
+                        float inside = glm::dot(disk, disk) < 1.0f ? 1.0f : 0.0f;
+                        float cosine = std::max(0.0f, 1.0f - 2.0f * sphere.x);
+                        sum += inside * (0.5f + smooth.x * smooth.y) * cosine;
+                    }
+
+                    double error = sum / sampleCount - CPU_STUDY_REFERENCE;
+                    squaredError += error * error;
+                }
+            }
+
+            convergence.SampleCounts.push_back(sampleCount);
+            convergence.Rmse.push_back(std::sqrt(squaredError / (CPU_STUDY_SIZE * CPU_STUDY_SIZE)));
+        }
+
+        return convergence;
+    }
+
+    SamplerStudyResult RunCpuSamplerStudy(uint32_t budget)
+    {
+        TracerUtils::Math::PcgSampler pcgSampler;
+        TracerUtils::Math::SobolSampler sobolSampler;
+
+        SamplerStudyResult result;
+        result.Domain = "cpu";
+        result.Budget = budget;
+        result.Pcg = MeasureCpuSampler(pcgSampler, SamplerType::Sampler_Pcg, budget);
+        result.Sobol = MeasureCpuSampler(sobolSampler, SamplerType::Sampler_SobolBlueNoise, budget);
+        return result;
+    }
+
+    double ComputeImageRmse(const std::vector<float> &image, const std::vector<float> &reference)
+    {
+        size_t pixelCount = std::min(image.size(), reference.size()) / 4;
+        if(pixelCount == 0)
+            return 0.0;
+
+        double squaredError = 0.0;
+        for (size_t pixel = 0; pixel < pixelCount; pixel++)
+        {
+            for (size_t channel = 0; channel < 3; channel++)
+            {
+                double error = image[pixel * 4 + channel] - reference[pixel * 4 + channel];
+                squaredError += error * error;
+            }
+        }
+
+        return std::sqrt(squaredError / (pixelCount * 3));
+    }
+
+    static void WriteConvergence(std::ofstream& file, const SamplerConvergence& convergence)
+    {
+        file << "{\"sampler\": \"" << GetSamplerName(convergence.Sampler) << "\", \"rmse\": [";
+        for (size_t i = 0; i < convergence.Rmse.size(); i++)
+        {
+            file << "[" << convergence.SampleCounts[i] << ", " << convergence.Rmse[i] << "]" << (i + 1 < convergence.Rmse.size() ? ", " : "");
+        }
+        file << "]}";
+    }
+
+    void SaveSamplerStudyReport(const std::string &filePath, const std::string &deviceName, const std::vector<SamplerStudyResult> &results)
+    {
+        std::ofstream file{filePath, std::ios::trunc};
+        if(!file.is_open())
+        {
+            std::cout << "Unable to write sampler study report to " << filePath << std::endl;
+            return;
+        }
+
+        file << "{\n";
+        file << "  \"device\": " << TracerUtils::IOHelpers::ToJsonString(deviceName) << ",\n";
+        file << "  \"studies\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const SamplerStudyResult& result = results[i];
+            file << "    {\n";
+            file << "      \"domain\": \"" << result.Domain << "\",\n";
+            file << "      \"budget\": " << result.Budget << ",\n";
+            file << "      \"targetRmse\": " << result.GetTargetRmse() << ",\n";
+            file << "      \"equalErrorSamples\": " << result.GetEqualErrorSamples() << ",\n";
+            file << "      \"pcg\": ";
+            WriteConvergence(file, result.Pcg);
+            file << ",\n      \"sobol\": ";
+            WriteConvergence(file, result.Sobol);
+            file << "\n    }" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n";
+        file << "}\n";
+
+        std::cout << "Sampler study saved to " << filePath << std::endl;
+    }
+
+    const char *GetSamplerName(SamplerType sampler)
+    {
+        switch (sampler)
+        {
+        case SamplerType::Sampler_Pcg: return "pcg";
+        case SamplerType::Sampler_SobolBlueNoise: return "sobol";
+        default: return "unknown";
+        }
+    }
+
+    void Tracer::RunSamplerStudy()
+    {
+        uint32_t budget = _settings.FrameCount;
+        uint32_t samplesPerFrame = _raytracePermutation.SamplesPerPixel;
+
+        std::vector<SamplerStudyResult> results;
+        results.push_back(RunCpuSamplerStudy(budget * samplesPerFrame));
+        results.back().Print();
+
+        auto useSampler = [&](SamplerType sampler)
+        {
+            RaytracePermutation permutation = _raytracePermutation;
+            permutation.Sampler = sampler;
+            SetRaytracePermutation(permutation);
+        };
+
+        //the PCG reference is independent of the Sobol sequence, so the Sobol error is not underestimated
+        useSampler(SamplerType::Sampler_Pcg);
+        std::vector<float> reference = RenderReference(budget);
+
+        SamplerStudyResult gpuResult;
+        gpuResult.Domain = "gpu";
+        gpuResult.Budget = budget * samplesPerFrame;
+        gpuResult.Pcg.Sampler = SamplerType::Sampler_Pcg;
+        gpuResult.Sobol.Sampler = SamplerType::Sampler_SobolBlueNoise;
+        for (SamplerConvergence* convergence : {&gpuResult.Pcg, &gpuResult.Sobol})
+        {
+            useSampler(convergence->Sampler);
+            for (uint32_t frameCount = 1; frameCount <= budget; frameCount *= 2)
+            {
+                RenderAccumulated(frameCount);
+                convergence->SampleCounts.push_back(frameCount * samplesPerFrame);
+                convergence->Rmse.push_back(ComputeImageRmse(ReadAccumulatedImage(frameCount), reference));
+            }
+        }
+        gpuResult.Print();
+        results.push_back(std::move(gpuResult));
+
+        SaveSamplerStudyReport(_settings.ReportPath.empty() ? "SamplerStudy.json" : _settings.ReportPath, _device.Properties.deviceName, results);
+    }
+}
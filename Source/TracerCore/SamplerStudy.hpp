@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RaytracePermutation.hpp"
+
+namespace TracerCore
+{
+    /// @brief RMSE against a reference for power of two sample counts.
+    struct SamplerConvergence
+    {
+        SamplerType Sampler;
+        std::vector<uint32_t> SampleCounts;
+        std::vector<double> Rmse;
+
+        /// @brief Sample count at which the error drops to targetRmse, interpolated in log-log space.
+        /// @return 0 when the largest measured count does not reach the target
+        double GetEqualErrorSamples(double targetRmse) const;
+    };
+
+    /// @brief Samples the Sobol sampler needs to match the error of the PCG sampler at Budget samples.
+    struct SamplerStudyResult
+    {
+        // "cpu" for the analytic reference integrand, "gpu" for the ray tracing pass
+        std::string Domain;
+        uint32_t Budget = 0;
+        SamplerConvergence Pcg;
+        SamplerConvergence Sobol;
+
+        inline double GetTargetRmse() const { return Pcg.Rmse.empty() ? 0.0 : Pcg.Rmse.back(); }
+        inline double GetEqualErrorSamples() const { return Sobol.GetEqualErrorSamples(GetTargetRmse()); }
+
+        void Print() const;
+    };
+
+    /// @brief CPU reference: a 64x64 image of a 6 dimensional integrand with a known value, three Sample2D calls per sample
+    /// like the pixel jitter and two bounces of the ray tracing pass, once with each sampler.
+    SamplerStudyResult RunCpuSamplerStudy(uint32_t budget);
+
+    /// @param image rgba32f texels
+    /// @param reference rgba32f texels, only rgb is compared
+    double ComputeImageRmse(const std::vector<float>& image, const std::vector<float>& reference);
+
+    void SaveSamplerStudyReport(const std::string& filePath, const std::string& deviceName, const std::vector<SamplerStudyResult>& results);
+
+    const char* GetSamplerName(SamplerType sampler);
+}
@@ -41,7 +41,7 @@ namespace TracerCore
         for (int i = 0; i < depthImages.size(); i++) {
             vkDestroyImageView(_device.GetVkDevice(), depthImageViews[i], nullptr);
             vkDestroyImage(_device.GetVkDevice(), depthImages[i], nullptr);
-            vkFreeMemory(_device.GetVkDevice(), depthImageMemorys[i], nullptr);
+            _device.GetMemoryAllocator().Free(depthImageAllocations[i]);
         }
 
         for (auto framebuffer : _swapChainFramebuffers) {
@@ -79,7 +79,7 @@ namespace TracerCore
     }
 
     VkResult SwapChain::SubmitCommandBuffers(
-        const VkCommandBuffer *buffers, uint32_t *imageIndex) 
+        const VkCommandBuffer *buffers, uint32_t *imageIndex, VkSemaphore computeFinished) 
     {
         if (_imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
             vkWaitForFences(_device.GetVkDevice(), 1, &_imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
@@ -89,9 +89,9 @@ namespace TracerCore
         VkSubmitInfo submitInfo = {};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-        VkSemaphore waitSemaphores[] = {_imageAvailableSemaphores[_currentFrame]};
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount = 1;
+        VkSemaphore waitSemaphores[] = {_imageAvailableSemaphores[_currentFrame], computeFinished};
+        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+        submitInfo.waitSemaphoreCount = computeFinished != VK_NULL_HANDLE ? 2 : 1;
         submitInfo.pWaitSemaphores = waitSemaphores;
         submitInfo.pWaitDstStageMask = waitStages;
 
@@ -316,7 +316,7 @@ namespace TracerCore
         VkExtent2D swapChainExtent = GetExtent();
 
         depthImages.resize(GetImageCount());
-        depthImageMemorys.resize(GetImageCount());
+        depthImageAllocations.resize(GetImageCount());
         depthImageViews.resize(GetImageCount());
 
         for (int i = 0; i < depthImages.size(); i++) 
@@ -342,7 +342,8 @@ namespace TracerCore
                 imageInfo,
                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                 depthImages[i],
-                depthImageMemorys[i]
+                depthImageAllocations[i],
+                Resources::MemoryCategory::Other
             );
 
             VkImageViewCreateInfo viewInfo{};
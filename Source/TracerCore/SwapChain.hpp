@@ -34,11 +34,16 @@ namespace TracerCore
         inline uint32_t GetWidth() { return _swapChainExtent.width; }
         inline uint32_t GetHeight() { return _swapChainExtent.height; }
 
+        /// @brief Returns the frame in flight slot that the next AcquireNextImage/SubmitCommandBuffers pair uses.
+        inline uint32_t GetCurrentFrame() const { return static_cast<uint32_t>(_currentFrame); }
+
         inline float ExtentAspectRatio() { return static_cast<float>(_swapChainExtent.width) / static_cast<float>(_swapChainExtent.height); }
         VkFormat FindDepthFormat();
 
         VkResult AcquireNextImage(uint32_t *imageIndex);
-        VkResult SubmitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex);
+        /// @brief Submits the frame to the graphics queue and presents it.
+        /// @param computeFinished Optional semaphore signaled by async compute work, waited on before fragment shading.
+        VkResult SubmitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex, VkSemaphore computeFinished = VK_NULL_HANDLE);
 
     private:
         void Init();
@@ -80,7 +85,7 @@ namespace TracerCore
         VkRenderPass _graphicsRenderPass;
 
         std::vector<VkImage> depthImages;
-        std::vector<VkDeviceMemory> depthImageMemorys;
+        std::vector<Resources::MemoryAllocation> depthImageAllocations;
         std::vector<VkImageView> depthImageViews;
         std::vector<VkImage> _swapChainImages;
         std::vector<VkImageView> _swapChainImageViews;
@@ -0,0 +1,232 @@
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "Resources/MemoryAllocator.hpp"
+
+// Checks the buddy allocator against a real device. Runs on software drivers such as lavapipe
+// (select the driver with VK_DRIVER_FILES/VK_ICD_FILENAMES), exits with 77 to mark the test skipped without one.
+
+using TracerCore::Resources::MemoryAllocation;
+using TracerCore::Resources::MemoryAllocator;
+using TracerCore::Resources::MemoryCategory;
+using TracerCore::Resources::MemoryPoolStats;
+
+static int failureCount = 0;
+
+#define CHECK(condition) \
+    do { if(!(condition)) { std::cerr << __FILE__ << ":" << __LINE__ << " check failed: " #condition << std::endl; failureCount++; } } while(0)
+
+static VkMemoryRequirements MakeRequirements(VkDeviceSize size, VkDeviceSize alignment)
+{
+    VkMemoryRequirements requirements{};
+    requirements.size = size;
+    requirements.alignment = alignment;
+    requirements.memoryTypeBits = ~0u;
+    return requirements;
+}
+
+static MemoryAllocation Allocate(MemoryAllocator& allocator, VkDeviceSize size, VkDeviceSize alignment = 1)
+{
+    return allocator.Allocate(MakeRequirements(size, alignment), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, MemoryCategory::Other);
+}
+
+static MemoryPoolStats GetOnlyPool(const MemoryAllocator& allocator)
+{
+    auto stats = allocator.GetPoolStats();
+    CHECK(stats.size() == 1);
+    return stats.empty() ? MemoryPoolStats{} : stats.front();
+}
+
+static void TestSplitAndMerge(VkDevice device, VkPhysicalDevice physicalDevice)
+{
+    MemoryAllocator allocator(device, physicalDevice);
+
+    //the smallest range splits the block down to MIN_ALLOCATION_SIZE, the upper half is the largest free range left
+    MemoryAllocation first = Allocate(allocator, 1);
+    CHECK(!first.Dedicated);
+    CHECK(first.Offset == 0);
+    CHECK(first.Size == MemoryAllocator::MIN_ALLOCATION_SIZE);
+    CHECK(GetOnlyPool(allocator).LargestFreeRange == MemoryAllocator::BLOCK_SIZE / 2);
+
+    //its buddy is handed out next
+    MemoryAllocation second = Allocate(allocator, MemoryAllocator::MIN_ALLOCATION_SIZE);
+    CHECK(second.Memory == first.Memory);
+    CHECK(second.Offset == MemoryAllocator::MIN_ALLOCATION_SIZE);
+
+    //sizes round up to the next power of two
+    MemoryAllocation third = Allocate(allocator, MemoryAllocator::MIN_ALLOCATION_SIZE * 3);
+    CHECK(third.Size == MemoryAllocator::MIN_ALLOCATION_SIZE * 4);
+    CHECK(GetOnlyPool(allocator).UsedBytes == MemoryAllocator::MIN_ALLOCATION_SIZE * 6);
+
+    allocator.Free(second);
+    allocator.Free(first);
+    allocator.Free(third);
+
+    //all buddies merge back into one range of the whole block
+    MemoryPoolStats stats = GetOnlyPool(allocator);
+    CHECK(stats.AllocationCount == 0);
+    CHECK(stats.UsedBytes == 0);
+    CHECK(stats.LargestFreeRange == MemoryAllocator::BLOCK_SIZE);
+}
+
+static void TestAlignment(VkDevice device, VkPhysicalDevice physicalDevice)
+{
+    MemoryAllocator allocator(device, physicalDevice);
+
+    std::vector<MemoryAllocation> allocations;
+    for (uint32_t alignmentShift = 0; alignmentShift <= 16; alignmentShift++)
+    {
+        VkDeviceSize alignment = VkDeviceSize(1) << alignmentShift;
+        for (VkDeviceSize size : {VkDeviceSize(1), VkDeviceSize(300), VkDeviceSize(4097)})
+        {
+            MemoryAllocation allocation = Allocate(allocator, size, alignment);
+            CHECK(allocation.Offset % alignment == 0);
+            CHECK(allocation.Size >= size);
+            allocations.push_back(allocation);
+        }
+    }
+
+    //ranges of one memory object never overlap
+    std::vector<std::tuple<VkDeviceMemory, VkDeviceSize, VkDeviceSize>> ranges;
+    for (const auto& allocation : allocations)
+    {
+        ranges.emplace_back(allocation.Memory, allocation.Offset, allocation.Offset + allocation.Size);
+    }
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 1; i < ranges.size(); i++)
+    {
+        if(std::get<0>(ranges[i]) == std::get<0>(ranges[i - 1]))
+        {
+            CHECK(std::get<1>(ranges[i]) >= std::get<2>(ranges[i - 1]));
+        }
+    }
+
+    for (const auto& allocation : allocations)
+    {
+        allocator.Free(allocation);
+    }
+    CHECK(GetOnlyPool(allocator).LargestFreeRange == MemoryAllocator::BLOCK_SIZE);
+}
+
+static void TestDedicatedAllocations(VkDevice device, VkPhysicalDevice physicalDevice)
+{
+    MemoryAllocator allocator(device, physicalDevice);
+
+    //half a block is the largest pooled size
+    MemoryAllocation pooled = Allocate(allocator, MemoryAllocator::BLOCK_SIZE / 2);
+    CHECK(!pooled.Dedicated);
+    CHECK(allocator.GetDeviceAllocationCount() == 1);
+
+    MemoryAllocation dedicated = Allocate(allocator, MemoryAllocator::BLOCK_SIZE / 2 + 1);
+    CHECK(dedicated.Dedicated);
+    CHECK(dedicated.Offset == 0);
+    CHECK(dedicated.Size == MemoryAllocator::BLOCK_SIZE / 2 + 1);
+    CHECK(dedicated.Memory != pooled.Memory);
+    CHECK(allocator.GetDeviceAllocationCount() == 2);
+    CHECK(allocator.GetCategoryUsage(MemoryCategory::Other) == MemoryAllocator::BLOCK_SIZE + 1);
+    //dedicated memory is not part of the pool statistics
+    CHECK(GetOnlyPool(allocator).UsedBytes == MemoryAllocator::BLOCK_SIZE / 2);
+
+    allocator.Free(dedicated);
+    CHECK(allocator.GetDeviceAllocationCount() == 1);
+    allocator.Free(pooled);
+    CHECK(allocator.GetCategoryUsage(MemoryCategory::Other) == 0);
+}
+
+static void TestEmptyBlockRetention(VkDevice device, VkPhysicalDevice physicalDevice)
+{
+    MemoryAllocator allocator(device, physicalDevice);
+
+    //two halves fill the first block, the third allocation needs a second one
+    std::vector<MemoryAllocation> allocations;
+    for (int i = 0; i < 3; i++)
+    {
+        allocations.push_back(Allocate(allocator, MemoryAllocator::BLOCK_SIZE / 2));
+    }
+    CHECK(GetOnlyPool(allocator).BlockCount == 2);
+    CHECK(allocator.GetDeviceAllocationCount() == 2);
+
+    for (const auto& allocation : allocations)
+    {
+        allocator.Free(allocation);
+    }
+
+    //one empty block stays around for the next scene load, further empty ones are released
+    MemoryPoolStats stats = GetOnlyPool(allocator);
+    CHECK(stats.BlockCount == 1);
+    CHECK(stats.AllocationCount == 0);
+    CHECK(allocator.GetDeviceAllocationCount() == 1);
+
+    //the retained block is reused without a new device allocation
+    MemoryAllocation reused = Allocate(allocator, MemoryAllocator::MIN_ALLOCATION_SIZE);
+    CHECK(allocator.GetDeviceAllocationCount() == 1);
+    allocator.Free(reused);
+}
+
+int main()
+{
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "MemoryAllocatorTest";
+    appInfo.apiVersion = VK_API_VERSION_1_2;
+
+    VkInstanceCreateInfo instanceInfo{};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pApplicationInfo = &appInfo;
+
+    VkInstance instance;
+    if(vkCreateInstance(&instanceInfo, nullptr, &instance) != VK_SUCCESS)
+    {
+        std::cout << "No Vulkan instance, skipping" << std::endl;
+        return 77;
+    }
+
+    uint32_t physicalDeviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr);
+    if(physicalDeviceCount == 0)
+    {
+        std::cout << "No Vulkan device, skipping" << std::endl;
+        vkDestroyInstance(instance, nullptr);
+        return 77;
+    }
+
+    std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
+    vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices.data());
+    VkPhysicalDevice physicalDevice = physicalDevices.front();
+
+    //the allocator needs no queues, a device needs at least one
+    float queuePriority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo{};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = 0;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &queuePriority;
+
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+
+    VkDevice device;
+    if(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device) != VK_SUCCESS)
+    {
+        std::cerr << "failed to create logical device!" << std::endl;
+        vkDestroyInstance(instance, nullptr);
+        return 1;
+    }
+
+    TestSplitAndMerge(device, physicalDevice);
+    TestAlignment(device, physicalDevice);
+    TestDedicatedAllocations(device, physicalDevice);
+    TestEmptyBlockRetention(device, physicalDevice);
+
+    vkDestroyDevice(device, nullptr);
+    vkDestroyInstance(instance, nullptr);
+
+    std::cout << (failureCount == 0 ? "All memory allocator checks passed" : "Memory allocator checks failed") << std::endl;
+    return failureCount == 0 ? 0 : 1;
+}
@@ -2,75 +2,51 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
 #include <array>
 #include <vector>
+#include <chrono>
+#include <numeric>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtx/compatibility.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include <tracy/Tracy.hpp>
 
 #include "UI/CamerUIControl.hpp"
 
 #include "Models/TracerVertex.hpp"
+#include "../TracerUtils/Math/LowDiscrepancy.hpp"
 
 
 
 namespace TracerCore
 {
-    //test animation
-    static const bool AnimatedCamera = false;
-    static const glm::vec3 cameraPositions[] = {
-        glm::vec3(3, .4, .4),
-        glm::vec3(0, .7, -4.0),
-        glm::vec3(0, 3, 0),
-        glm::vec3(-2.4f, 0.7f, 3.5f),
-        glm::vec3(0, 0.5f, 4.0f),
-    };
-    static const float timePreTransition = 8.0f;
-    static int currentCameraPosition = 0;
-    static float timeTransition = 0.0f;
-    
-
-    static void AnimateCamera(TracerCamera& camera, float deltaTime, uint32_t frameCount)
-    {
-        glm::vec3 position = glm::lerp(cameraPositions[currentCameraPosition], cameraPositions[(currentCameraPosition + 1) % 5], timeTransition / timePreTransition);
-        if(frameCount > 10)
-        {
-            if(timeTransition < timePreTransition)
-            {
-                timeTransition += deltaTime;
-            }
-            else
-            {
-                timeTransition = 0.0f;
-                currentCameraPosition = (currentCameraPosition + 1) % 5;
-            }
-
-            camera.SetParameters(position, glm::normalize(glm::vec3(0, .5, 0) - position));
-            camera.SetStatic(false);
-        }
-    }
-
-    Tracer::Tracer()
+    Tracer::Tracer(const TracerSettings& settings) :
+        _settings(settings),
+        _mainWindow(settings.Headless ? nullptr : std::make_unique<Window>(settings.Width, settings.Height, "Sorpirit Raytracer"))
     {
         ZoneScoped;
 
-        auto extent = _mainWindow.GetExtent();
-        glm::vec3 position = cameraPositions[0];
-        glm::vec3 target = glm::vec3(0, .5, 0);
-        _camera.SetParameters(position, glm::normalize(target - position));
+        auto extent = GetRenderExtent();
+        _camera.SetParameters(DEFAULT_CAMERA_POSITION, glm::normalize(DEFAULT_CAMERA_TARGET - DEFAULT_CAMERA_POSITION));
         _camera.SetProjection(glm::radians(95.0f), extent.width / (float) extent.height, 0.1f, 150.0f);
 
-        _sceneData.ModelPath = "Models\\suzanne.fbx";
-        _sceneData.AccStructureType = AccStructureType::AccStructure_BVH;
-        _sceneData.AccHeruishitcType = AccHeruishitcType::AccHeruishitc_SAH;
+        _sceneData.ModelPath = _settings.ModelPath.empty() ? "Models\\suzanne.fbx" : _settings.ModelPath;
+        _sceneData.AccStructureType = _settings.AccStructureType;
+        _sceneData.AccHeruishitcType = _settings.AccHeruishitcType;
+        //de-indexing triples the vertex memory, it stays opt-in until it measures faster on the target GPU
+        _sceneData.ReorderLeafTriangles = false;
+        _sceneData.CompactVertices = false;
 
         _frameStats.color = glm::vec3(0.5, 0.7, 1.0);
         _frameStats.bounceCount = 16;
+        _frameStats.rouletteMinBounce = _settings.RouletteMinBounce;
 
         _frameData.Color = _frameStats.color;
         _frameData.FrameIndex = 1;
@@ -78,7 +54,29 @@ namespace TracerCore
         _frameData.InvProjection = _camera.GetInvProjection();
         _frameData.View = _camera.GetView();
         _frameData.InvView = _camera.GetInvView();
+        _frameData.PrevProjection = _frameData.Projection;
+        _frameData.PrevView = _frameData.View;
+        _frameData.ReprojectHistory = 0;
+        _frameData.ReprojectionMaxHistory = static_cast<uint32_t>(_sceneData.ReprojectionMaxHistory);
         _frameData.BounceCount = _frameStats.bounceCount;
+        _frameData.RouletteMinBounce = _frameStats.rouletteMinBounce;
+        _frameData.DebugView = 0;
+        _frameData.HeatmapMax = _sceneData.HeatmapMax;
+
+        _sceneData.NextEventEstimation = _settings.NextEventEstimation;
+        _raytracePermutation.NextEventEstimation = _settings.NextEventEstimation;
+        _sceneData.Denoiser = _settings.Denoiser;
+        _raytracePermutation.Denoiser = _settings.Denoiser;
+        _sceneData.Reprojection = _settings.Reprojection;
+        _raytracePermutation.Reprojection = _settings.Reprojection;
+        _sceneData.AccumulationFormat = static_cast<int>(_settings.Accumulation);
+        _raytracePermutation.Accumulation = _settings.Accumulation;
+
+        if(_settings.AdaptiveThreshold > 0.0f)
+        {
+            _sceneData.AdaptiveSampling = true;
+            _sceneData.AdaptiveThreshold = _settings.AdaptiveThreshold;
+        }
 
         _materialsSettings.groundAlbedo = glm::vec3(0.8f, 0.8f, 0.0f);
         _materialsSettings.UseRandomMaterials = true;
@@ -87,25 +85,114 @@ namespace TracerCore
 
 
         LoadImages();
-        RecreateSwapChain();
+        if(!_device.IsHeadless())
+        {
+            RecreateSwapChain();
+        }
 
         CreateBuffers();
-        CreateOnScreenPipelines();
+
+        auto pipelinesStart = std::chrono::high_resolution_clock::now();
+        if(!_device.IsHeadless())
+        {
+            CreateOnScreenPipelines();
+        }
         CreateComputePipelines();
-        SwitchRaytracePipeline();
-        LoadModels();
+        auto pipelinesEnd = std::chrono::high_resolution_clock::now();
+        std::cout << "Pipelines created in " << std::chrono::duration<float, std::milli>(pipelinesEnd - pipelinesStart).count() << " ms" << std::endl;
+        _pipelineManager.SavePipelineCache();
+
+        //batch and benchmark runs load the scene of every job themselves
+        if(_settings.BatchFile.empty() && !_settings.Benchmark)
+        {
+            LoadModels();
+        }
         
         CreateCommandBuffers();
+        CreateComputeSyncObjects();
+        CreateHeadlessSyncObjects();
     }
 
     Tracer::~Tracer()
     {
-        _framedataBuffer->UnmapMemory();
+        for (auto semaphore : _computeFinishedSemaphores)
+        {
+            vkDestroySemaphore(_device.GetVkDevice(), semaphore, nullptr);
+        }
+
+        for (auto fence : _headlessFences)
+        {
+            vkDestroyFence(_device.GetVkDevice(), fence, nullptr);
+        }
+
+        for (auto& framedataBuffer : _framedataBuffers)
+        {
+            framedataBuffer->UnmapMemory();
+        }
+
+        for (auto& rayCounterBuffer : _rayCounterBuffers)
+        {
+            rayCounterBuffer->UnmapMemory();
+        }
         _uiLayer = nullptr;
     }
 
     void Tracer::Run()
     {
+        if(!_settings.BatchFile.empty())
+        {
+            RunBatch();
+            return;
+        }
+
+        if(_settings.Benchmark)
+        {
+            RunBenchmark();
+            return;
+        }
+
+        if(_settings.SamplerStudy)
+        {
+            RunSamplerStudy();
+            return;
+        }
+
+        if(_settings.RouletteStudy)
+        {
+            RunRouletteStudy();
+            return;
+        }
+
+        if(_settings.LightStudy)
+        {
+            RunLightStudy();
+            return;
+        }
+
+        if(_settings.DenoiseCheck)
+        {
+            RunDenoiseCheck();
+            return;
+        }
+
+        if(_settings.ReprojectionCheck)
+        {
+            RunReprojectionCheck();
+            return;
+        }
+
+        if(_settings.AccumulationCheck)
+        {
+            RunAccumulationCheck();
+            return;
+        }
+
+        if(_device.IsHeadless())
+        {
+            RenderHeadless();
+            return;
+        }
+
         uint32_t extensionCount = 0;
         vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
         std::cout << extensionCount << " extensions supported\n";
@@ -121,7 +208,7 @@ namespace TracerCore
 
         uint32_t accumStartFrameIndex = 0;
 
-        while(_mainWindow.ShouldClose()) {
+        while(_mainWindow->ShouldClose()) {
             
             currentFrame = glfwGetTime();
             deltaTime = currentFrame - lastFrame;
@@ -137,48 +224,78 @@ namespace TracerCore
 
             _frameStats.FrameTime = deltaTime;
 
-            if(AnimatedCamera)
-            {
-                AnimateCamera(_camera, deltaTime, frameCount);
-            }
-
             //update frame params
             _frameData.Color = _frameStats.color;
+            _frameData.PrevProjection = _frameData.Projection;
+            _frameData.PrevView = _frameData.View;
             _frameData.Projection = _camera.GetProjection();
             _frameData.InvProjection = _camera.GetInvProjection();
             _frameData.View = _camera.GetView();
             _frameData.InvView = _camera.GetInvView();
             _frameData.FrameIndex = frameCount;
-            
-            if(_frameData.UseAccumTexture != _camera.IsStatic())
+            _frameData.BounceCount = _frameStats.bounceCount;
+            _frameData.RouletteMinBounce = _frameStats.rouletteMinBounce;
+            _frameData.DebugView = static_cast<uint32_t>(_sceneData.DebugView);
+            _frameData.HeatmapMax = _sceneData.HeatmapMax;
+
+            //counters are only compiled into the ray tracing pass while a heatmap is shown or a capture is pending
+            if(!_autotuner.IsRunning())
+            {
+                RaytracePermutation permutation = _raytracePermutation;
+                permutation.TraversalStats = _sceneData.DebugView != 0 || _sceneData.CaptureTraversalStats;
+                permutation.Sampler = static_cast<SamplerType>(_sceneData.Sampler);
+                //the denoiser filters every pixel of every frame, converged tiles would leave stale inputs
+                permutation.AdaptiveSampling = _sceneData.AdaptiveSampling && !_sceneData.Denoiser && !_sceneData.Reprojection;
+                permutation.NextEventEstimation = _sceneData.NextEventEstimation;
+                permutation.Denoiser = _sceneData.Denoiser;
+                permutation.Reprojection = _sceneData.Reprojection;
+                permutation.Accumulation = static_cast<AccumulationFormat>(_sceneData.AccumulationFormat);
+                SetRaytracePermutation(permutation);
+            }
+
+            //reprojection keeps the accumulation while the camera moves, only scene, camera and permutation resets restart it
+            bool useAccumulation = _raytracePermutation.Reprojection ? !_restartAccumulation : _camera.IsStatic();
+            _restartAccumulation = false;
+            if(_frameData.UseAccumTexture != useAccumulation)
             {
                 accumStartFrameIndex = frameCount;
             }
 
-            _frameData.UseAccumTexture = _camera.IsStatic();
+            _frameData.UseAccumTexture = useAccumulation;
             _frameData.AccumFrameIndex = frameCount - accumStartFrameIndex;
-            _frameData.BounceCount = _frameStats.bounceCount;
-
-            VkDeviceSize size = sizeof(FrameData);
-            memcpy(_frameDataPtr, &_frameData, size);
+            _frameData.ReprojectHistory = _frameData.View != _frameData.PrevView || _frameData.Projection != _frameData.PrevProjection;
+            _frameData.ReprojectionMaxHistory = static_cast<uint32_t>(_sceneData.ReprojectionMaxHistory);
             
             glfwPollEvents();
             DrawFrame();
 
+            if(_sceneData.CaptureTraversalStats && _lastTracedWithStats)
+            {
+                CaptureTraversalStats();
+                _sceneData.CaptureTraversalStats = false;
+            }
+
             if(!_sceneData.IsSceneLoaded)
             {
+                //scene buffers and descriptor sets are still referenced by frames in flight
+                vkDeviceWaitIdle(_device.GetVkDevice());
                 SwitchRaytracePipeline();
                 LoadModels();
                 _camera.SetStatic(false);
             }
 
+            if(_sceneData.RunAutotune)
+            {
+                _autotuner.Start(_raytracePermutation);
+                _sceneData.RunAutotune = false;
+            }
+
             if(_sceneData.ResetCamera)
             {
-                glm::vec3 position = cameraPositions[0];
-                glm::vec3 target = glm::vec3(0, .5, 0);
-                _camera.SetParameters(position, glm::normalize(target - position));
+                _camera.SetParameters(DEFAULT_CAMERA_POSITION, glm::normalize(DEFAULT_CAMERA_TARGET - DEFAULT_CAMERA_POSITION));
                 _sceneData.ResetCamera = false;
                 _camera.SetStatic(false);
+                _restartAccumulation = true;
             }
 
             frameCount++;
@@ -190,16 +307,28 @@ namespace TracerCore
 
     void Tracer::LoadModels()
     {
-        auto model = TracerUtils::IOHelpers::LoadModel(_sceneData.ModelPath);
-        _scene.AddModel(model);
+        //acceleration structure changes rebuild the scene from the model that is already loaded
+        if(_loadedModelPath != _sceneData.ModelPath)
+        {
+            _scene.ClearModels();
+            _scene.AddModel(TracerUtils::IOHelpers::LoadModel(_sceneData.ModelPath));
+            _loadedModelPath = _sceneData.ModelPath;
+        }
+
         _scene.BuildMaterials(_materialsSettings);
-        _scene.BuildScene(_sceneData.AccStructureType, _sceneData.AccHeruishitcType);
+        _scene.BuildScene(_sceneData.AccStructureType, _sceneData.AccHeruishitcType, _sceneData.ReorderLeafTriangles, _sceneData.CompactVertices);
         std::cout << "Scene builded. " << _sceneData.ModelPath << " loaded. Acc structure:" << (int) _sceneData.AccStructureType << " Acc heuristic:" << (int) _sceneData.AccHeruishitcType << "\n";
 
+        _device.GetMemoryAllocator().PrintReport();
+
         _frameStats.TriCount = _scene.GetIndeciesCount() / 3;
         _frameData.aabbMin = _scene.GetAABBMin();
         _frameData.aabbMax = _scene.GetAABBMax();
+        _frameData.DirectTriangleFetch = _scene.IsLeafOrdered();
+        _frameData.CompactVertices = _scene.UsesCompactVertices();
         _sceneData.IsSceneLoaded = true;
+        _denoiseHistoryValid = false;
+        _restartAccumulation = true;
 
         _scene.AttachSceneGeometry(_shaderResourceManager, _rayTracingPipeline->GetDescriptorSets());
     }
@@ -208,61 +337,339 @@ namespace TracerCore
     {
         // _texture2d = Resources::Texture2D::LoadFileTexture("Textures\\cutecat.jpg", _device);
 
-        auto extent = _mainWindow.GetExtent();
-        _computeTexture = Resources::Texture2D::CreateTexture2D(extent.width, extent.height, 
-            VK_FORMAT_R8G8B8A8_UNORM, 
+        auto extent = GetRenderExtent();
+
+        //Traced on the compute queue and sampled on the graphics queue, so both families share the images
+        std::vector<uint32_t> queueFamilies;
+        if(_device.HasDedicatedComputeQueue())
+        {
+            queueFamilies = {_device.GetQueueFamilyIndices().GraphicsFamily, _device.GetQueueFamilyIndices().ComputeFamily};
+        }
+
+        _computeTextures.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        for (auto& computeTexture : _computeTextures)
+        {
+            computeTexture = Resources::Texture2D::CreateTexture2D(extent.width, extent.height, 
+                VK_FORMAT_R8G8B8A8_UNORM, 
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT  | VK_IMAGE_USAGE_SAMPLED_BIT,
+                false,
+                _device,
+                queueFamilies
+            );
+            //stays in GENERAL, written as storage image and sampled by the on screen pass
+            computeTexture->TransitionImageLayout(VK_IMAGE_LAYOUT_GENERAL);
+        }
+
+        LoadTraversalStatsImages();
+        LoadAccumulationImages();
+        LoadDenoiseImages();
+        LoadReprojectionImages();
+        _restartAccumulation = true;
+
+        //enough tiles for workgroups down to 4x4, the autotuner never goes below that
+        _adaptiveTileCapacity = ((extent.width + 3) / 4) * ((extent.height + 3) / 4);
+        std::vector<uint32_t> tileStates(4 + _adaptiveTileCapacity, 0);
+        tileStates[1] = 1;
+        tileStates[2] = 1;
+        _adaptiveTileStateBuffer = _device.GetUploadManager().CreateDeviceLocalBuffer(tileStates.data(), tileStates.size() * sizeof(uint32_t), 
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+            Resources::MemoryCategory::FrameData);
+        _adaptiveActiveTileBuffer = Resources::VulkanBuffer::CreateBuffer(_device, _adaptiveTileCapacity * sizeof(uint32_t), 
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT  | VK_IMAGE_USAGE_SAMPLED_BIT,
-            false,
-            _device
-        );
+            Resources::MemoryCategory::FrameData);
+        _device.GetUploadManager().Flush();
+    }
+
+    std::unique_ptr<Resources::Texture2D> Tracer::CreateStorageTexture(VkExtent2D extent, VkFormat format, VkImageUsageFlags transferUsage)
+    {
+        //transitioned, copied and read back on the graphics queue, traced on the compute queue like the result images
+        std::vector<uint32_t> queueFamilies;
+        if(_device.HasDedicatedComputeQueue())
+        {
+            queueFamilies = {_device.GetQueueFamilyIndices().GraphicsFamily, _device.GetQueueFamilyIndices().ComputeFamily};
+        }
 
-        _accumulationTexture = Resources::Texture2D::CreateTexture2D(extent.width, extent.height, 
-            VK_FORMAT_R32G32B32A32_SFLOAT, 
+        auto texture = Resources::Texture2D::CreateTexture2D(extent.width, extent.height, 
+            format, 
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT  | VK_IMAGE_USAGE_SAMPLED_BIT,
+            VK_IMAGE_USAGE_STORAGE_BIT | transferUsage,
             false,
-            _device
+            _device,
+            queueFamilies
         );
-        _accumulationTexture->TransitionImageLayout(VK_IMAGE_LAYOUT_GENERAL);
+        texture->TransitionImageLayout(VK_IMAGE_LAYOUT_GENERAL);
+        return texture;
+    }
+
+    void Tracer::LoadTraversalStatsImages()
+    {
+        //only TRAVERSAL_STATS permutations write the counters, the others get 1x1 placeholders
+        VkExtent2D extent = _raytracePermutation.TraversalStats ? GetRenderExtent() : VkExtent2D{1, 1};
+        _traversalStatsTextures.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        for (auto& statsTexture : _traversalStatsTextures)
+        {
+            statsTexture = CreateStorageTexture(extent, VK_FORMAT_R32G32B32A32_UINT);
+        }
+    }
+
+    void Tracer::LoadDenoiseImages()
+    {
+        //the G-buffer is shared with the reprojection, the remaining images are only read and written by the denoiser passes
+        auto extent = GetRenderExtent();
+        VkExtent2D gBufferExtent = _raytracePermutation.WritesGBuffer() ? extent : VkExtent2D{1, 1};
+        VkExtent2D denoiseExtent = _raytracePermutation.Denoiser ? extent : VkExtent2D{1, 1};
+
+        _gBufferTexture = CreateStorageTexture(gBufferExtent, VK_FORMAT_R32G32B32A32_SFLOAT);
+        _albedoTexture = CreateStorageTexture(denoiseExtent, VK_FORMAT_R8G8B8A8_UNORM);
+        _denoiseInputTexture = CreateStorageTexture(denoiseExtent, VK_FORMAT_R16G16B16A16_SFLOAT);
+        for (auto& denoiseTexture : _denoiseTextures)
+        {
+            denoiseTexture = CreateStorageTexture(denoiseExtent, VK_FORMAT_R16G16B16A16_SFLOAT);
+        }
+        _denoiseHistoryTextures.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        for (auto& historyTexture : _denoiseHistoryTextures)
+        {
+            historyTexture = CreateStorageTexture(denoiseExtent, VK_FORMAT_R16G16B16A16_SFLOAT);
+        }
+        _denoiseHistoryValid = false;
+    }
+
+    void Tracer::LoadReprojectionImages()
+    {
+        VkExtent2D extent = _raytracePermutation.Reprojection ? GetRenderExtent() : VkExtent2D{1, 1};
+        _accumulationCountTexture = CreateStorageTexture(extent, VK_FORMAT_R32_UINT);
+        _previousGBufferTexture = CreateStorageTexture(extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+        _previousAccumulationCountTexture = CreateStorageTexture(extent, VK_FORMAT_R32_UINT, VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    }
+
+    void Tracer::LoadAccumulationImages()
+    {
+        //the shader declares the images of both formats, the unused format gets 1x1 placeholders
+        auto extent = GetRenderExtent();
+        bool useHalf = _raytracePermutation.Accumulation == AccumulationFormat::AccumulationFormat_HalfCompensated;
+        VkExtent2D floatExtent = useHalf ? VkExtent2D{1, 1} : extent;
+        VkExtent2D halfExtent = useHalf ? extent : VkExtent2D{1, 1};
+
+        _accumulationTexture = CreateStorageTexture(floatExtent, VK_FORMAT_R32G32B32A32_SFLOAT);
+        _previousAccumulationTexture = CreateStorageTexture(floatExtent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+        _halfAccumulationTexture = CreateStorageTexture(halfExtent, VK_FORMAT_R16G16B16A16_SFLOAT);
+        _accumulationCompensationTexture = CreateStorageTexture(halfExtent, VK_FORMAT_R8G8B8A8_SNORM);
+        _previousHalfAccumulationTexture = CreateStorageTexture(halfExtent, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+        _previousAccumulationCompensationTexture = CreateStorageTexture(halfExtent, VK_FORMAT_R8G8B8A8_SNORM, VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+        std::cout << "Accumulation " << GetAccumulationFormatName(_raytracePermutation.Accumulation) << ", "
+            << GetAccumulationBytesPerPixel(_raytracePermutation.Accumulation) * static_cast<uint64_t>(extent.width) * extent.height / (1024.0 * 1024.0)
+            << " MB read and written per frame" << std::endl;
     }
 
     void Tracer::SwitchRaytracePipeline()
     {
-        switch (_sceneData.AccStructureType)
-        {
-        case AccStructureType::AccStructure_BVH:   
-            _rayTracingPipeline->SetPipelineVariantIndex(0);
-            break;
-        case AccStructureType::AccStructure_KdTree:
-            _rayTracingPipeline->SetPipelineVariantIndex(1);
-            break;
-        case AccStructureType::AccStructure_None:
-            _rayTracingPipeline->SetPipelineVariantIndex(2);
-            break;
-        
-        default:
-            break;
+        _raytracePermutation.Traversal = _sceneData.AccStructureType;
+        _autotuner.ApplyBest(_raytracePermutation);
+        _rayTracingPipeline->SetPipelineVariantIndex(GetRaytraceVariant(_raytracePermutation));
+    }
+
+    void Tracer::SetRaytracePermutation(const RaytracePermutation &permutation)
+    {
+        if(permutation == _raytracePermutation)
+            return;
+
+        //tile states count frames per workgroup tile, a new tile grid restarts the accumulation
+        bool tileGridChanged = permutation.WorkgroupSizeX != _raytracePermutation.WorkgroupSizeX ||
+            permutation.WorkgroupSizeY != _raytracePermutation.WorkgroupSizeY ||
+            permutation.AdaptiveSampling != _raytracePermutation.AdaptiveSampling;
+        if(permutation.AdaptiveSampling && tileGridChanged)
+        {
+            _frameData.UseAccumTexture = 0;
+            _camera.SetStatic(false);
+        }
+
+        //frame counts switch between per pixel and global ones, or the accumulation moves to new images
+        bool formatChanged = permutation.Accumulation != _raytracePermutation.Accumulation;
+        bool statsChanged = permutation.TraversalStats != _raytracePermutation.TraversalStats;
+        bool denoiseChanged = permutation.Denoiser != _raytracePermutation.Denoiser || permutation.WritesGBuffer() != _raytracePermutation.WritesGBuffer();
+        bool reprojectionChanged = permutation.Reprojection != _raytracePermutation.Reprojection;
+        if(reprojectionChanged || formatChanged)
+        {
+            _frameData.UseAccumTexture = 0;
+            _restartAccumulation = true;
+        }
+
+        _raytracePermutation = permutation;
+        _rayTracingPipeline->SetPipelineVariantIndex(GetRaytraceVariant(_raytracePermutation));
+
+        if(formatChanged || statsChanged || denoiseChanged || reprojectionChanged)
+        {
+            //frames in flight still reference the previous images
+            vkDeviceWaitIdle(_device.GetVkDevice());
+            if(formatChanged)
+            {
+                LoadAccumulationImages();
+            }
+            if(statsChanged)
+            {
+                LoadTraversalStatsImages();
+            }
+            if(denoiseChanged)
+            {
+                LoadDenoiseImages();
+            }
+            if(reprojectionChanged)
+            {
+                LoadReprojectionImages();
+            }
+            BindRenderTargets();
         }
     }
 
+    void Tracer::UpdateRaytraceTiming(uint32_t frameIndex)
+    {
+        if(_gpuProfiler.CollectSlot(frameIndex))
+        {
+            float traceMs = _gpuProfiler.GetStatistics(GpuPass::GpuPass_Trace).LastMs;
+            auto& computeTexture = _computeTextures[frameIndex];
+            uint32_t rayCount = *_rayCounterPtrs[frameIndex];
+            _frameStats.AveragePathLength = rayCount / static_cast<float>(computeTexture->GetWidth() * computeTexture->GetHeight());
+            _frameStats.MRaysPerSecond = traceMs > 0.0f ? rayCount / (traceMs * 1000.0f) : 0.0f;
+
+            if(_autotuner.AddSample(_timestampCandidates[frameIndex], traceMs))
+            {
+                SetRaytracePermutation(_autotuner.GetBestPermutation());
+            }
+        }
+
+        if(_autotuner.IsRunning())
+        {
+            SetRaytracePermutation(_autotuner.GetCandidatePermutation());
+        }
+
+        _timestampCandidates[frameIndex] = _autotuner.GetCandidateIndex();
+    }
+
+    uint32_t Tracer::GetRaytraceVariant(const RaytracePermutation &permutation)
+    {
+        auto cached = _raytraceVariants.find(permutation);
+        if(cached != _raytraceVariants.end())
+        {
+            return cached->second;
+        }
+
+        ZoneScoped;
+        auto constants = permutation.GetConstants();
+        auto mapEntries = RaytracePermutation::GetMapEntries();
+
+        VkSpecializationInfo specializationInfo{};
+        specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+        specializationInfo.pMapEntries = mapEntries.data();
+        specializationInfo.dataSize = sizeof(constants);
+        specializationInfo.pData = constants.data();
+
+        VkPipeline pipeline;
+        _pipelineManager.CreateComputePipeline(_rayTracingPipeline->GetPipelineLayout(), permutation.GetShaderPath(), &pipeline, &specializationInfo);
+
+        uint32_t variantIndex = _rayTracingPipeline->AddPipelineVariant(pipeline);
+        _raytraceVariants.emplace(permutation, variantIndex);
+
+        std::cout << "Built ray tracing permutation " << permutation.GetShaderPath() 
+            << " workgroup " << permutation.WorkgroupSizeX << "x" << permutation.WorkgroupSizeY 
+            << " stack " << permutation.MaxStackDepth 
+            << " bounces " << permutation.MaxBounces 
+            << " spp " << permutation.SamplesPerPixel
+            << (permutation.Mapping == PixelMapping::PixelMapping_Morton ? " morton" : " linear")
+            << (permutation.TraversalStats ? " stats" : "")
+            << " sampler " << GetSamplerName(permutation.Sampler)
+            << (permutation.AdaptiveSampling ? " adaptive" : "")
+            << (permutation.NextEventEstimation ? " nee" : "")
+            << (permutation.Denoiser ? " denoise" : "")
+            << (permutation.Reprojection ? " reproject" : "")
+            << " accumulation " << GetAccumulationFormatName(permutation.Accumulation) << std::endl;
+
+        return variantIndex;
+    }
+
+    void Tracer::CaptureTraversalStats()
+    {
+        vkDeviceWaitIdle(_device.GetVkDevice());
+
+        auto& statsTexture = _traversalStatsTextures[_lastTracedFrameIndex];
+        uint32_t width = statsTexture->GetWidth();
+        uint32_t height = statsTexture->GetHeight();
+        VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * 4 * sizeof(uint32_t);
+
+        auto stagingBuffer = Resources::VulkanBuffer::CreateBuffer(_device, size, 
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
+            Resources::MemoryCategory::Staging);
+        statsTexture->CopyToBuffer(stagingBuffer.get());
+
+        void* data;
+        stagingBuffer->MapMemory(size, 0, &data);
+        const uint32_t* texels = static_cast<const uint32_t*>(data);
+
+        std::cout << _sceneData.ModelPath << " Acc structure:" << (int) _sceneData.AccStructureType << " Acc heuristic:" << (int) _sceneData.AccHeruishitcType << "\n";
+        TraversalStatsReport::Reduce(texels, width, height).Print(std::cout);
+
+        if(!_sceneData.TraversalHeatmapPath.empty())
+        {
+            //the shaded view exports node visits
+            TraversalCounter counter = static_cast<TraversalCounter>(std::max(_sceneData.DebugView - 1, 0));
+            SaveTraversalHeatmap(_sceneData.TraversalHeatmapPath, texels, width, height, counter, _sceneData.HeatmapMax);
+            std::cout << "Traversal heatmap saved to " << _sceneData.TraversalHeatmapPath << std::endl;
+            _sceneData.TraversalHeatmapPath.clear();
+        }
+
+        stagingBuffer->UnmapMemory();
+    }
+
     void Tracer::CreateBuffers()
     {
         VkDeviceSize size = sizeof(FrameData);
-        _framedataBuffer = Resources::VulkanBuffer::CreateBuffer(_device, size, 
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        
-        _framedataBuffer->MapMemory(size, 0, &_frameDataPtr);
-        memcpy(_frameDataPtr, &_frameData, size);
+        _framedataBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        _frameDataPtrs.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        for (size_t i = 0; i < _framedataBuffers.size(); i++)
+        {
+            _framedataBuffers[i] = Resources::VulkanBuffer::CreateBuffer(_device, size, 
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                Resources::MemoryCategory::FrameData);
+            
+            _framedataBuffers[i]->MapMemory(size, 0, &_frameDataPtrs[i]);
+            memcpy(_frameDataPtrs[i], &_frameData, size);
+        }
+
+        _rayCounterBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        _rayCounterPtrs.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        for (size_t i = 0; i < _rayCounterBuffers.size(); i++)
+        {
+            _rayCounterBuffers[i] = Resources::VulkanBuffer::CreateBuffer(_device, sizeof(uint32_t), 
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                Resources::MemoryCategory::FrameData);
+
+            void* data;
+            _rayCounterBuffers[i]->MapMemory(sizeof(uint32_t), 0, &data);
+            _rayCounterPtrs[i] = static_cast<uint32_t*>(data);
+            *_rayCounterPtrs[i] = 0;
+        }
+
+        //Sobol directions and blue noise never change, they are built and uploaded once
+        auto samplerTablesStart = std::chrono::high_resolution_clock::now();
+        std::vector<uint32_t> samplerTables = TracerUtils::Math::LowDiscrepancy::BuildSamplerTables();
+        _samplerTablesBuffer = _device.GetUploadManager().CreateDeviceLocalBuffer(samplerTables.data(), samplerTables.size() * sizeof(uint32_t), 
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Resources::MemoryCategory::Other);
+        _device.GetUploadManager().Flush();
+        auto samplerTablesEnd = std::chrono::high_resolution_clock::now();
+        std::cout << "Sampler tables built in " << std::chrono::duration<float, std::milli>(samplerTablesEnd - samplerTablesStart).count() << " ms" << std::endl;
     }
 
     void Tracer::CreateOnScreenPipelines()
     {
         assert(_swapChain != nullptr && "Unable to create pipeline while swap chain is not created");
 
-        //Create graphics pipeline;
-        auto imageCount = _swapChain->GetImageCount();
+        //Create graphics pipeline, descriptor sets are indexed by frame in flight
+        uint32_t imageCount = SwapChain::MAX_FRAMES_IN_FLIGHT;
 
         VkDescriptorPool descriptorPool;
         VkDescriptorSetLayout setLayout;
@@ -271,17 +678,33 @@ namespace TracerCore
         VkPipeline onScreenPipeline;
 
         VkDescriptorPoolSize poolSizes[] = {
-            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageCount}
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageCount},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, imageCount},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, imageCount},
         };
-        VkDescriptorSetLayoutBinding layoutBindings[1];
+
+        const int bindingCount = 3;
+        VkDescriptorSetLayoutBinding layoutBindings[bindingCount];
         layoutBindings[0].binding = 0;
         layoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         layoutBindings[0].descriptorCount = 1;
         layoutBindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
         layoutBindings[0].pImmutableSamplers = nullptr;
 
-        _shaderResourceManager.CreateDescriptorPool(poolSizes, 1, imageCount, descriptorPool);
-        _shaderResourceManager.CreateDescriptorSetLayout(layoutBindings, 1, setLayout);
+        layoutBindings[1].binding = 1;
+        layoutBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        layoutBindings[1].descriptorCount = 1;
+        layoutBindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        layoutBindings[1].pImmutableSamplers = nullptr;
+
+        layoutBindings[2].binding = 2;
+        layoutBindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        layoutBindings[2].descriptorCount = 1;
+        layoutBindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        layoutBindings[2].pImmutableSamplers = nullptr;
+
+        _shaderResourceManager.CreateDescriptorPool(poolSizes, 3, imageCount, descriptorPool);
+        _shaderResourceManager.CreateDescriptorSetLayout(layoutBindings, bindingCount, setLayout);
         _shaderResourceManager.CreateDescriptorSets(descriptorPool, setLayout, imageCount, descriptorSets);
 
         _pipelineManager.CreatePipelineLayout(setLayout, &pipelineLayout);
@@ -293,7 +716,12 @@ namespace TracerCore
 
         _pipelineManager.CreateGraphicsPipeline(pipelineConfig,  "PrecompiledShaders\\OnScreen.vert.spv", "PrecompiledShaders\\OnScreen.frag.spv", &onScreenPipeline);
 
-        _shaderResourceManager.UploadTexture(descriptorSets, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _computeTexture.get());
+        for (size_t i = 0; i < descriptorSets.size(); i++)
+        {
+            _shaderResourceManager.UploadTexture({descriptorSets[i]}, 0, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _computeTextures[i].get());
+            _shaderResourceManager.UploadTexture({descriptorSets[i]}, 1, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _traversalStatsTextures[i].get());
+            _shaderResourceManager.UploadBuffer({descriptorSets[i]}, 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, _framedataBuffers[i].get());
+        }
 
         std::vector<VkPipeline> variants = std::vector<VkPipeline>{onScreenPipeline};
 
@@ -310,86 +738,90 @@ namespace TracerCore
 
     void Tracer::CreateComputePipelines()
     {
-        assert(_swapChain != nullptr && "Unable to create pipeline while swap chain is not created");
-
-        //Create compute pipeline
-        auto imageCount = _swapChain->GetImageCount();
+        //Create compute pipeline, descriptor sets are indexed by frame in flight
+        uint32_t imageCount = SwapChain::MAX_FRAMES_IN_FLIGHT;
 
         VkDescriptorPool descriptorPool;
         VkDescriptorSetLayout setLayout;
         std::vector<VkDescriptorSet> descriptorSets;
         VkPipelineLayout pipelineLayout;
 
-        VkDescriptorPoolSize poolSizes[] = {
-            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, imageCount * 2},
-            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, imageCount},
-            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, imageCount * 4},
+        //binding numbers match the layout(binding = N) declarations of RaytracingPass.glsl and the denoiser shaders
+        const std::pair<uint32_t, VkDescriptorType> bindingTypes[] = {
+            {0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},   // result
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},   // accumulation
+            {2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER},  // scene data
+            {3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},  // vertices
+            {4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},  // indices
+            {5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},  // acceleration structure nodes
+            {6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},  // materials
+            {7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},  // ray counter
+            {8, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},   // traversal stats
+            {9, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},  // sampler tables
+            {10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER}, // adaptive tile states
+            {11, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER}, // adaptive active tiles
+            {12, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // G-buffer
+            {13, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // albedo
+            {14, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // denoise input
+            {15, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // denoise ping
+            {16, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // denoise pong
+            {17, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // denoise history
+            {18, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // previous denoise history
+            {19, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // accumulation count
+            {20, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // previous accumulation
+            {21, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // previous G-buffer
+            {22, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // previous accumulation count
+            {23, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // half accumulation
+            {24, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // accumulation compensation
+            {25, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // previous half accumulation
+            {26, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},  // previous accumulation compensation
         };
+        const uint32_t bindingCount = sizeof(bindingTypes) / sizeof(bindingTypes[0]);
 
-        const int bindingCount = 7;
         VkDescriptorSetLayoutBinding layoutBindings[bindingCount];
-        layoutBindings[0].binding = 0;
-        layoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        layoutBindings[0].descriptorCount = 1;
-        layoutBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        layoutBindings[0].pImmutableSamplers = nullptr;
-                
-        layoutBindings[1].binding = 1;
-        layoutBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        layoutBindings[1].descriptorCount = 1;
-        layoutBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        layoutBindings[1].pImmutableSamplers = nullptr;
+        VkDescriptorPoolSize poolSizes[] = {
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0},
+        };
+        for (uint32_t i = 0; i < bindingCount; i++)
+        {
+            layoutBindings[i].binding = bindingTypes[i].first;
+            layoutBindings[i].descriptorType = bindingTypes[i].second;
+            layoutBindings[i].descriptorCount = 1;
+            layoutBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            layoutBindings[i].pImmutableSamplers = nullptr;
+
+            //one descriptor of the binding per frame in flight
+            for (auto& poolSize : poolSizes)
+            {
+                if(poolSize.type == bindingTypes[i].second)
+                {
+                    poolSize.descriptorCount += imageCount;
+                }
+            }
+        }
 
-        layoutBindings[2].binding = 2;
-        layoutBindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        layoutBindings[2].descriptorCount = 1;
-        layoutBindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        layoutBindings[2].pImmutableSamplers = nullptr;
-        
-        layoutBindings[3].binding = 3;
-        layoutBindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        layoutBindings[3].descriptorCount = 1;
-        layoutBindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        layoutBindings[3].pImmutableSamplers = nullptr;
-        
-        layoutBindings[4].binding = 4;
-        layoutBindings[4].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        layoutBindings[4].descriptorCount = 1;
-        layoutBindings[4].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        layoutBindings[4].pImmutableSamplers = nullptr;
-        
-        layoutBindings[5].binding = 5;
-        layoutBindings[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        layoutBindings[5].descriptorCount = 1;
-        layoutBindings[5].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        layoutBindings[5].pImmutableSamplers = nullptr;
-
-        layoutBindings[6].binding = 6;
-        layoutBindings[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        layoutBindings[6].descriptorCount = 1;
-        layoutBindings[6].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        layoutBindings[6].pImmutableSamplers = nullptr;
-
-        _shaderResourceManager.CreateDescriptorPool(poolSizes, 1, imageCount, descriptorPool);
+        _shaderResourceManager.CreateDescriptorPool(poolSizes, 3, imageCount, descriptorPool);
         _shaderResourceManager.CreateDescriptorSetLayout(layoutBindings, bindingCount, setLayout);
         _shaderResourceManager.CreateDescriptorSets(descriptorPool, setLayout, imageCount, descriptorSets);
 
-        _pipelineManager.CreatePipelineLayout(setLayout, &pipelineLayout);
-
-        VkPipeline bhvPipeline;
-        VkPipeline kdPipeline;
-        VkPipeline simpleLoopPipeline;
-    
-        _pipelineManager.CreateComputePipeline(pipelineLayout, "PrecompiledShaders\\RaytraceKdTree.comp.spv", &kdPipeline);
-        _pipelineManager.CreateComputePipeline(pipelineLayout, "PrecompiledShaders\\RaytraceBHVTree.comp.spv", &bhvPipeline);
-        _pipelineManager.CreateComputePipeline(pipelineLayout, "PrecompiledShaders\\RaytraceSimpleLoop.comp.spv", &simpleLoopPipeline);
+        //the iteration of the denoiser passes changes between dispatches of the same frame
+        VkPushConstantRange denoisePushConstants{};
+        denoisePushConstants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        denoisePushConstants.offset = 0;
+        denoisePushConstants.size = sizeof(DenoisePushConstants);
+        _pipelineManager.CreatePipelineLayout(setLayout, &pipelineLayout, {denoisePushConstants});
 
-        _shaderResourceManager.UploadTexture(descriptorSets, 0, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _computeTexture.get());
-        _shaderResourceManager.UploadTexture(descriptorSets, 1, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _accumulationTexture.get());
-        _shaderResourceManager.UploadBuffer(descriptorSets, 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, _framedataBuffer.get());
+        for (size_t i = 0; i < descriptorSets.size(); i++)
+        {
+            _shaderResourceManager.UploadBuffer({descriptorSets[i]}, 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, _framedataBuffers[i].get());
+            _shaderResourceManager.UploadBuffer({descriptorSets[i]}, 7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _rayCounterBuffers[i].get());
+        }
+        _shaderResourceManager.UploadBuffer(descriptorSets, 9, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _samplerTablesBuffer.get());
 
-        std::vector<VkPipeline> variants = std::vector<VkPipeline>{bhvPipeline, kdPipeline, simpleLoopPipeline};
-        
+        //Permutations are built lazily by GetRaytraceVariant
+        _raytraceVariants.clear();
         _rayTracingPipeline = std::make_unique<PipelineObject>(
             _device,
             VK_PIPELINE_BIND_POINT_COMPUTE,
@@ -397,13 +829,30 @@ namespace TracerCore
             descriptorPool, 
             descriptorSets,
             pipelineLayout,
-            variants
+            std::vector<VkPipeline>{}
         );
+        BindRenderTargets();
+
+        //the tile compaction pass shares the descriptor sets of the ray tracing pass
+        VkPipeline adaptiveTilesPipeline;
+        _pipelineManager.CreateComputePipeline(pipelineLayout, "PrecompiledShaders\\AdaptiveTiles.comp.spv", &adaptiveTilesPipeline);
+        _adaptiveTilesVariant = _rayTracingPipeline->AddPipelineVariant(adaptiveTilesPipeline);
+
+        VkPipeline denoiseAtrousPipeline;
+        _pipelineManager.CreateComputePipeline(pipelineLayout, "PrecompiledShaders\\DenoiseAtrous.comp.spv", &denoiseAtrousPipeline);
+        _denoiseAtrousVariant = _rayTracingPipeline->AddPipelineVariant(denoiseAtrousPipeline);
+
+        VkPipeline denoiseResolvePipeline;
+        _pipelineManager.CreateComputePipeline(pipelineLayout, "PrecompiledShaders\\DenoiseResolve.comp.spv", &denoiseResolvePipeline);
+        _denoiseResolveVariant = _rayTracingPipeline->AddPipelineVariant(denoiseResolvePipeline);
+
+        //the default traversal of every scene is built up front, so the first frame does not stall on it
+        SwitchRaytracePipeline();
     }
 
     void Tracer::CreateCommandBuffers()
     {
-        _commandBuffers.resize(_swapChain->GetImageCount());
+        _commandBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
 
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -414,12 +863,64 @@ namespace TracerCore
         if(vkAllocateCommandBuffers(_device.GetVkDevice(), &allocInfo, _commandBuffers.data()) != VK_SUCCESS) {
             throw std::runtime_error("failed to allocate command buffers!");
         }
+
+        if(!_device.HasDedicatedComputeQueue())
+            return;
+
+        _computeCommandBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        allocInfo.commandPool = _device.GetComputeCommandPool();
+        allocInfo.commandBufferCount = static_cast<uint32_t>(_computeCommandBuffers.size());
+
+        if(vkAllocateCommandBuffers(_device.GetVkDevice(), &allocInfo, _computeCommandBuffers.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate compute command buffers!");
+        }
+    }
+
+    void Tracer::CreateComputeSyncObjects()
+    {
+        if(!_device.HasDedicatedComputeQueue())
+            return;
+
+        _computeFinishedSemaphores.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        for (auto& semaphore : _computeFinishedSemaphores)
+        {
+            if (vkCreateSemaphore(_device.GetVkDevice(), &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create compute synchronization objects!");
+            }
+        }
+    }
+    
+    void Tracer::CreateHeadlessSyncObjects()
+    {
+        if(!_device.IsHeadless())
+            return;
+
+        _headlessFences.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+        for (auto& fence : _headlessFences)
+        {
+            if (vkCreateFence(_device.GetVkDevice(), &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create headless synchronization objects!");
+            }
+        }
     }
     
     void Tracer::DrawFrame()
     {
         uint32_t imageIndex;
-        auto result = _swapChain->AcquireNextImage(&imageIndex);
+        VkResult result;
+        {
+            ZoneScopedN("WaitForFrame");
+            result = _swapChain->AcquireNextImage(&imageIndex);
+        }
 
         if(result == VK_ERROR_OUT_OF_DATE_KHR) {
             RecreateSwapChain();
@@ -430,23 +931,61 @@ namespace TracerCore
             throw std::runtime_error("failed to acquire swap chain image!");
         }
 
-        //Run compute pipeline
+        //The fence for this frame slot is signaled, its uniform buffer and command buffer are free to reuse
+        uint32_t frameIndex = _swapChain->GetCurrentFrame();
+        //the autotuner may switch the permutation and with it the adaptive tile grid
+        UpdateRaytraceTiming(frameIndex);
+        UpdateAdaptiveFrameData();
+        memcpy(_frameDataPtrs[frameIndex], &_frameData, sizeof(FrameData));
+
+        VkSemaphore computeFinished = VK_NULL_HANDLE;
+        if(_device.HasDedicatedComputeQueue())
         {
-            ZoneScopedN("ComputeRays");
-            _computeTexture->TransitionImageLayout(VK_IMAGE_LAYOUT_GENERAL);
-            auto cmdBuffer = _device.BeginSingleTimeCommands();
-            _rayTracingPipeline->Bind(cmdBuffer, imageIndex);
-            vkCmdDispatch(cmdBuffer, glm::ceil( _computeTexture->GetWidth() / 32.0f), glm::ceil(_computeTexture->GetHeight() / 32.0f), 1);
-            _device.EndSingleTimeCommands(cmdBuffer);
-            _computeTexture->TransitionImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            ZoneScopedN("SubmitCompute");
+            VkCommandBuffer computeCommandBuffer = _computeCommandBuffers[frameIndex];
+            vkResetCommandBuffer(computeCommandBuffer, 0);
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            if(vkBeginCommandBuffer(computeCommandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording compute command buffer!");
+            }
+
+            RecordComputeCommands(computeCommandBuffer, frameIndex);
+
+            if(vkEndCommandBuffer(computeCommandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record compute command buffer!");
+            }
+
+            computeFinished = _computeFinishedSemaphores[frameIndex];
+
+            VkSubmitInfo submitInfo = {};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &computeCommandBuffer;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &computeFinished;
+
+            if (vkQueueSubmit(_device.GetComputeQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit compute command buffer!");
+            }
+        }
+
+        {
+            ZoneScopedN("RecordFrame");
+            vkResetCommandBuffer(_commandBuffers[frameIndex], 0);
+            RecordCommandBuffer(_commandBuffers[frameIndex], frameIndex, imageIndex);
         }
 
-        vkResetCommandBuffer(_commandBuffers[imageIndex], 0);
-        RecordCommandBuffer(imageIndex);
-        result = _swapChain->SubmitCommandBuffers(&_commandBuffers[imageIndex], &imageIndex);
+        _lastTracedFrameIndex = frameIndex;
+        _lastTracedWithStats = _raytracePermutation.TraversalStats != 0;
+
+        result = _swapChain->SubmitCommandBuffers(&_commandBuffers[frameIndex], &imageIndex, computeFinished);
 
-        if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || _mainWindow.FramebufferResized()) {
-            _mainWindow.ResetFramebufferResizedFlag();
+        if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || _mainWindow->FramebufferResized()) {
+            _mainWindow->ResetFramebufferResizedFlag();
             RecreateSwapChain();
             return;
         }
@@ -458,14 +997,15 @@ namespace TracerCore
 
     void Tracer::RecreateSwapChain()
     {
-        auto extent = _mainWindow.GetExtent();
+        auto extent = _mainWindow->GetExtent();
         while(extent.width == 0 || extent.height == 0) 
         {
-            extent = _mainWindow.GetExtent();
+            extent = _mainWindow->GetExtent();
             glfwWaitEvents();
         }
 
         vkDeviceWaitIdle(_device.GetVkDevice());
+        auto recreateStart = std::chrono::high_resolution_clock::now();
 
         if(_swapChain == nullptr)
         {
@@ -473,41 +1013,597 @@ namespace TracerCore
         } 
         else 
         {
+            VkFormat previousFormat = _swapChain->GetImageFormat();
             _swapChain = std::make_unique<SwapChain>(_device, extent, std::move(_swapChain));
 
-            if(_swapChain->GetImageCount() != _commandBuffers.size()) 
+            //Viewport and scissor are dynamic, the on screen pipeline stays valid with any compatible render pass.
+            //The compute pipelines do not depend on the swap chain at all.
+            if(previousFormat != _swapChain->GetImageFormat())
             {
-                FreeCommandBuffers();
-                CreateCommandBuffers();
+                CreateOnScreenPipelines();
             }
 
-            CreateOnScreenPipelines();
-            CreateComputePipelines();
+            auto recreateEnd = std::chrono::high_resolution_clock::now();
+            std::cout << "Swap chain recreated in " << std::chrono::duration<float, std::milli>(recreateEnd - recreateStart).count() << " ms" << std::endl;
         }
 
         _uiLayer = nullptr;
         _uiLayer = std::make_unique<UI::ImguiLayer>(_device);
-        _uiLayer->Init(&_mainWindow, _swapChain.get());
-        _uiLayer->AddLayer(std::make_unique<UI::CamerUIControl>(_camera, _mainWindow));
-        _uiLayer->AddLayer(std::make_unique<UI::StatisticsWindow>(_frameStats));
-        _uiLayer->AddLayer(std::make_unique<UI::FrameControllsUI>(_device, _mainWindow, _sceneData, _computeTexture.get()));
+        _uiLayer->Init(_mainWindow.get(), _swapChain.get());
+        _uiLayer->AddLayer(std::make_unique<UI::CamerUIControl>(_camera, *_mainWindow));
+        _uiLayer->AddLayer(std::make_unique<UI::StatisticsWindow>(_frameStats, _gpuProfiler));
+        _uiLayer->AddLayer(std::make_unique<UI::FrameControllsUI>(_device, *_mainWindow, _sceneData, _computeTextures[0].get()));
+    }
+
+    void Tracer::RenderHeadless()
+    {
+        std::cout << "Headless render " << _settings.Width << "x" << _settings.Height << ", " << _settings.FrameCount << " frames" << std::endl;
+
+        RenderTimings timings = RenderAccumulated(_settings.FrameCount, _settings.OrbitDegrees);
+        std::cout << "Rendered " << timings.FrameCount << " frames in " << timings.RenderMs << " ms, "
+            << timings.RenderMs / std::max(timings.FrameCount, 1u) << " ms/frame, "
+            << "GPU trace avg " << timings.GpuTraceAvgMs << " ms, "
+            << timings.GetMRaysPerSecond() << " Mrays/s" << std::endl;
+
+        Resources::Texture2D::SaveTextureToFile(_settings.OutputPath, _computeTextures[_lastTracedFrameIndex].get(), _device);
+        std::cout << "Result saved to " << _settings.OutputPath << std::endl;
+    }
+
+    std::vector<float> Tracer::RenderReference(uint32_t frameCount, const std::string &name)
+    {
+        //error of the reference itself is small against the error of the budget
+        uint32_t referenceFrameCount = frameCount * STUDY_REFERENCE_MULTIPLIER;
+        std::cout << "Rendering reference" << (name.empty() ? "" : " of " + name) << " with " << referenceFrameCount << " frames" << std::endl;
+        RenderAccumulated(referenceFrameCount);
+        return ReadAccumulatedImage(referenceFrameCount);
+    }
+
+    std::vector<float> Tracer::ReadAccumulatedImage(uint32_t frameCount)
+    {
+        //the half format stores the mean, the frame counts are already divided out
+        if(_raytracePermutation.Accumulation == AccumulationFormat::AccumulationFormat_HalfCompensated)
+        {
+            return DecodeCompensatedMean(ReadTexture(_halfAccumulationTexture.get()), ReadTexture(_accumulationCompensationTexture.get()));
+        }
+
+        std::vector<float> image = ReadTexture(_accumulationTexture.get());
+
+        //the accumulation image holds the sum of the frames, reprojection counts them per pixel
+        std::vector<float> pixelFrameCounts;
+        if(_raytracePermutation.Reprojection)
+        {
+            pixelFrameCounts = ReadTexture(_accumulationCountTexture.get());
+        }
+
+        for (size_t i = 0; i < image.size(); i++)
+        {
+            image[i] /= pixelFrameCounts.empty() ? frameCount : std::max(pixelFrameCounts[i / 4], 1.0f);
+        }
+        return image;
+    }
+
+    std::vector<float> Tracer::ReadTexture(Resources::Texture2D* texture)
+    {
+        vkDeviceWaitIdle(_device.GetVkDevice());
+
+        VkFormat format = texture->GetFormat();
+        size_t componentSize;
+        size_t channelCount = 4;
+        switch (format)
+        {
+        case VK_FORMAT_R32G32B32A32_SFLOAT: componentSize = sizeof(float); break;
+        case VK_FORMAT_R16G16B16A16_SFLOAT: componentSize = sizeof(uint16_t); break;
+        case VK_FORMAT_R8G8B8A8_UNORM: componentSize = sizeof(uint8_t); break;
+        case VK_FORMAT_R8G8B8A8_SNORM: componentSize = sizeof(int8_t); break;
+        case VK_FORMAT_R32_UINT: componentSize = sizeof(uint32_t); channelCount = 1; break;
+        default: throw std::runtime_error("failed to read texture, unsupported format!");
+        }
+
+        size_t componentCount = static_cast<size_t>(texture->GetWidth()) * texture->GetHeight() * channelCount;
+        VkDeviceSize size = componentCount * componentSize;
+
+        auto stagingBuffer = Resources::VulkanBuffer::CreateBuffer(_device, size, 
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
+            Resources::MemoryCategory::Staging);
+        texture->CopyToBuffer(stagingBuffer.get());
+
+        void* data;
+        stagingBuffer->MapMemory(size, 0, &data);
+        std::vector<float> image(componentCount);
+        for (size_t i = 0; i < componentCount; i++)
+        {
+            switch (format)
+            {
+            case VK_FORMAT_R32G32B32A32_SFLOAT: image[i] = static_cast<const float*>(data)[i]; break;
+            case VK_FORMAT_R16G16B16A16_SFLOAT: image[i] = glm::unpackHalf1x16(static_cast<const uint16_t*>(data)[i]); break;
+            case VK_FORMAT_R32_UINT: image[i] = static_cast<float>(static_cast<const uint32_t*>(data)[i]); break;
+            case VK_FORMAT_R8G8B8A8_SNORM: image[i] = std::max(static_cast<const int8_t*>(data)[i] / 127.0f, -1.0f); break;
+            default: image[i] = static_cast<const uint8_t*>(data)[i] / 255.0f; break;
+            }
+        }
+        stagingBuffer->UnmapMemory();
+        return image;
+    }
+
+    float Tracer::SwitchScene(const std::string &modelPath, AccStructureType accStructureType, AccHeruishitcType accHeruishitcType)
+    {
+        vkDeviceWaitIdle(_device.GetVkDevice());
+        auto buildStart = std::chrono::high_resolution_clock::now();
+
+        _sceneData.ModelPath = modelPath;
+        _sceneData.AccStructureType = accStructureType;
+        _sceneData.AccHeruishitcType = accHeruishitcType;
+        SwitchRaytracePipeline();
+        LoadModels();
+
+        auto buildEnd = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<float, std::milli>(buildEnd - buildStart).count();
+    }
+
+    RenderTimings Tracer::RenderAccumulated(uint32_t frameCount, float orbitDegreesPerFrame)
+    {
+        ZoneScoped;
+
+        //without a dedicated compute family the graphics command buffers and queue trace the frames
+        bool computeQueue = _device.HasDedicatedComputeQueue();
+        VkQueue queue = computeQueue ? _device.GetComputeQueue() : _device.GetGraphicsQueue();
+        std::vector<VkCommandBuffer>& commandBuffers = computeQueue ? _computeCommandBuffers : _commandBuffers;
+
+        _frameData.Color = _frameStats.color;
+        _frameData.Projection = _camera.GetProjection();
+        _frameData.InvProjection = _camera.GetInvProjection();
+        _frameData.View = _camera.GetView();
+        _frameData.InvView = _camera.GetInvView();
+        _frameData.PrevProjection = _frameData.Projection;
+        _frameData.PrevView = _frameData.View;
+        _frameData.ReprojectHistory = 0;
+        _frameData.ReprojectionMaxHistory = static_cast<uint32_t>(_sceneData.ReprojectionMaxHistory);
+        _frameData.BounceCount = _frameStats.bounceCount;
+        _frameData.RouletteMinBounce = _frameStats.rouletteMinBounce;
+
+        RaytracePermutation permutation = _raytracePermutation;
+        permutation.AdaptiveSampling = _sceneData.AdaptiveSampling && !_sceneData.Denoiser && !_sceneData.Reprojection;
+        permutation.Denoiser = _sceneData.Denoiser;
+        permutation.Reprojection = _sceneData.Reprojection;
+        permutation.Accumulation = static_cast<AccumulationFormat>(_sceneData.AccumulationFormat);
+        SetRaytracePermutation(permutation);
+        UpdateAdaptiveFrameData();
+        //the history of the previous render saw another camera
+        _denoiseHistoryValid = false;
+
+        RenderTimings timings;
+        timings.FrameCount = frameCount;
+
+        //reads the results of the frame the slot finished
+        auto collectSlot = [&](uint32_t slot)
+        {
+            timings.RayCount += *_rayCounterPtrs[slot];
+            if(_gpuProfiler.CollectSlot(slot))
+            {
+                timings.GpuTraceMs.push_back(_gpuProfiler.GetStatistics(GpuPass::GpuPass_Trace).LastMs);
+            }
+        };
+
+        auto renderStart = std::chrono::high_resolution_clock::now();
+
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            uint32_t frameIndex = frame % SwapChain::MAX_FRAMES_IN_FLIGHT;
+            vkWaitForFences(_device.GetVkDevice(), 1, &_headlessFences[frameIndex], VK_TRUE, UINT64_MAX);
+            vkResetFences(_device.GetVkDevice(), 1, &_headlessFences[frameIndex]);
+
+            if(frame >= SwapChain::MAX_FRAMES_IN_FLIGHT)
+            {
+                collectSlot(frameIndex);
+            }
+
+            bool cameraMoved = frame > 0 && orbitDegreesPerFrame != 0.0f;
+            if(cameraMoved)
+            {
+                glm::vec3 offset = glm::rotateY(_camera.GetPosition() - DEFAULT_CAMERA_TARGET, glm::radians(orbitDegreesPerFrame));
+                _camera.SetParameters(DEFAULT_CAMERA_TARGET + offset, glm::normalize(-offset));
+                _frameData.PrevView = _frameData.View;
+                _frameData.View = _camera.GetView();
+                _frameData.InvView = _camera.GetInvView();
+            }
+
+            //the first frame overwrites the accumulation image, the following ones add to it.
+            //Without reprojection every frame of an orbit starts over like a moving camera in the window
+            _frameData.FrameIndex = frame + 1;
+            _frameData.UseAccumTexture = frame > 0 && (!cameraMoved || _raytracePermutation.Reprojection);
+            _frameData.AccumFrameIndex = std::max(frame, 1u);
+            _frameData.ReprojectHistory = cameraMoved;
+            memcpy(_frameDataPtrs[frameIndex], &_frameData, sizeof(FrameData));
+
+            VkCommandBuffer commandBuffer = commandBuffers[frameIndex];
+            vkResetCommandBuffer(commandBuffer, 0);
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording headless command buffer!");
+            }
+
+            if(!computeQueue)
+            {
+                TracyVkCollect(_gpuProfiler.GetTracyContext(false), commandBuffer);
+            }
+            RecordComputeCommands(commandBuffer, frameIndex);
+
+            if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record headless command buffer!");
+            }
+
+            VkSubmitInfo submitInfo = {};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &commandBuffer;
+
+            if (vkQueueSubmit(queue, 1, &submitInfo, _headlessFences[frameIndex]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit headless command buffer!");
+            }
+
+            _lastTracedFrameIndex = frameIndex;
+            _lastTracedWithStats = _raytracePermutation.TraversalStats != 0;
+            FrameMark;
+        }
+
+        vkWaitForFences(_device.GetVkDevice(), static_cast<uint32_t>(_headlessFences.size()), _headlessFences.data(), VK_TRUE, UINT64_MAX);
+        auto renderEnd = std::chrono::high_resolution_clock::now();
+
+        for (uint32_t slot = 0; slot < std::min<uint32_t>(frameCount, SwapChain::MAX_FRAMES_IN_FLIGHT); slot++)
+        {
+            collectSlot(slot);
+        }
+
+        timings.RenderMs = std::chrono::duration<float, std::milli>(renderEnd - renderStart).count();
+        if(!timings.GpuTraceMs.empty())
+        {
+            timings.GpuTraceAvgMs = std::accumulate(timings.GpuTraceMs.begin(), timings.GpuTraceMs.end(), 0.0f) / timings.GpuTraceMs.size();
+        }
+        return timings;
     }
 
-    void Tracer::RecordCommandBuffer(int index)
+    void Tracer::ResizeRenderTargets(uint32_t width, uint32_t height)
+    {
+        assert(_device.IsHeadless() && "Render targets of a window follow the swap chain");
+
+        if(width == _settings.Width && height == _settings.Height)
+            return;
+
+        vkDeviceWaitIdle(_device.GetVkDevice());
+        _settings.Width = width;
+        _settings.Height = height;
+        LoadImages();
+        BindRenderTargets();
+    }
+
+    void Tracer::BindRenderTargets()
+    {
+        const auto& descriptorSets = _rayTracingPipeline->GetDescriptorSets();
+        _shaderResourceManager.UploadTexture(descriptorSets, 1, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _accumulationTexture.get());
+        for (size_t i = 0; i < descriptorSets.size(); i++)
+        {
+            _shaderResourceManager.UploadTexture({descriptorSets[i]}, 0, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _computeTextures[i].get());
+            _shaderResourceManager.UploadTexture({descriptorSets[i]}, 8, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _traversalStatsTextures[i].get());
+        }
+        //the heatmap views of the on screen pass read the counters as well
+        if(_graphicsPipeline != nullptr)
+        {
+            const auto& onScreenDescriptorSets = _graphicsPipeline->GetDescriptorSets();
+            for (size_t i = 0; i < onScreenDescriptorSets.size(); i++)
+            {
+                _shaderResourceManager.UploadTexture({onScreenDescriptorSets[i]}, 1, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _traversalStatsTextures[i].get());
+            }
+        }
+        _shaderResourceManager.UploadBuffer(descriptorSets, 10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _adaptiveTileStateBuffer.get());
+        _shaderResourceManager.UploadBuffer(descriptorSets, 11, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _adaptiveActiveTileBuffer.get());
+
+        _shaderResourceManager.UploadTexture(descriptorSets, 12, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _gBufferTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 13, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _albedoTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 14, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _denoiseInputTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 15, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _denoiseTextures[0].get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 16, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _denoiseTextures[1].get());
+        for (size_t i = 0; i < descriptorSets.size(); i++)
+        {
+            //frame slots are used in order, the previous slot holds the previous frame
+            size_t previousSlot = (i + descriptorSets.size() - 1) % descriptorSets.size();
+            _shaderResourceManager.UploadTexture({descriptorSets[i]}, 17, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _denoiseHistoryTextures[i].get());
+            _shaderResourceManager.UploadTexture({descriptorSets[i]}, 18, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _denoiseHistoryTextures[previousSlot].get());
+        }
+
+        _shaderResourceManager.UploadTexture(descriptorSets, 19, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _accumulationCountTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 20, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _previousAccumulationTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 21, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _previousGBufferTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 22, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _previousAccumulationCountTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 23, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _halfAccumulationTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 24, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _accumulationCompensationTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 25, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _previousHalfAccumulationTexture.get());
+        _shaderResourceManager.UploadTexture(descriptorSets, 26, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _previousAccumulationCompensationTexture.get());
+    }
+
+    void Tracer::UpdateAdaptiveFrameData()
+    {
+        auto extent = GetRenderExtent();
+        _frameData.AdaptiveTileCountX = (extent.width + _raytracePermutation.WorkgroupSizeX - 1) / _raytracePermutation.WorkgroupSizeX;
+        _frameData.AdaptiveTileCount = _frameData.AdaptiveTileCountX * ((extent.height + _raytracePermutation.WorkgroupSizeY - 1) / _raytracePermutation.WorkgroupSizeY);
+        _frameData.AdaptiveThreshold = _sceneData.AdaptiveThreshold;
+        //both frame slots hold a result of the accumulation before a tile stops, see AdaptiveSampling.glsl
+        _frameData.AdaptiveMinFrames = std::max<uint32_t>(_sceneData.AdaptiveMinFrames, SwapChain::MAX_FRAMES_IN_FLIGHT);
+    }
+
+    VkExtent2D Tracer::GetRenderExtent() const
+    {
+        return _mainWindow != nullptr ? _mainWindow->GetExtent() : VkExtent2D{_settings.Width, _settings.Height};
+    }
+
+    void Tracer::RecordComputeCommands(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+    {
+        bool computeQueue = _device.HasDedicatedComputeQueue();
+        if(computeQueue)
+        {
+            TracyVkCollect(_gpuProfiler.GetTracyContext(true), commandBuffer);
+        }
+
+        _gpuProfiler.ResetPass(commandBuffer, frameIndex, GpuPass::GpuPass_Trace);
+        _gpuProfiler.ResetPass(commandBuffer, frameIndex, GpuPass::GpuPass_Denoise);
+        vkCmdFillBuffer(commandBuffer, _rayCounterBuffers[frameIndex]->GetBuffer(), 0, sizeof(uint32_t), 0);
+
+        //The result image of this frame slot was last sampled two frames ago, the slot fence already covers that.
+        //The accumulation image is shared between slots and was written by the previous dispatch on this queue.
+        VkMemoryBarrier accumulationBarrier{};
+        accumulationBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        accumulationBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        accumulationBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            1, &accumulationBarrier,
+            0, nullptr,
+            0, nullptr
+        );
+
+        if(_raytracePermutation.Reprojection && _frameData.UseAccumTexture && _frameData.ReprojectHistory)
+        {
+            RecordReprojectionCopies(commandBuffer);
+        }
+
+        auto& computeTexture = _computeTextures[frameIndex];
+        uint32_t groupCountX = (computeTexture->GetWidth() + _raytracePermutation.WorkgroupSizeX - 1) / _raytracePermutation.WorkgroupSizeX;
+        uint32_t groupCountY = (computeTexture->GetHeight() + _raytracePermutation.WorkgroupSizeY - 1) / _raytracePermutation.WorkgroupSizeY;
+
+        if(_raytracePermutation.AdaptiveSampling)
+        {
+            assert(groupCountX * groupCountY <= _adaptiveTileCapacity && "Adaptive tile buffers are smaller than the dispatch");
+
+            //compacts the tiles that are not converged into the active list and counts them into the dispatch arguments
+            vkCmdFillBuffer(commandBuffer, _adaptiveTileStateBuffer->GetBuffer(), 0, sizeof(uint32_t), 0);
+
+            VkMemoryBarrier clearBarrier{};
+            clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                1, &clearBarrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            _rayTracingPipeline->BindVariant(commandBuffer, frameIndex, _adaptiveTilesVariant);
+            vkCmdDispatch(commandBuffer, (groupCountX * groupCountY + 63) / 64, 1, 1);
+
+            VkMemoryBarrier activeTilesBarrier{};
+            activeTilesBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            activeTilesBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            activeTilesBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                1, &activeTilesBarrier,
+                0, nullptr,
+                0, nullptr
+            );
+        }
+
+        _rayTracingPipeline->Bind(commandBuffer, frameIndex);
+        {
+            TracyVkZone(_gpuProfiler.GetTracyContext(computeQueue), commandBuffer, "Trace");
+            _gpuProfiler.BeginPass(commandBuffer, frameIndex, GpuPass::GpuPass_Trace);
+            if(_raytracePermutation.AdaptiveSampling)
+            {
+                vkCmdDispatchIndirect(commandBuffer, _adaptiveTileStateBuffer->GetBuffer(), 0);
+            }
+            else
+            {
+                vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+            }
+            _gpuProfiler.EndPass(commandBuffer, frameIndex, GpuPass::GpuPass_Trace);
+        }
+
+        if(_raytracePermutation.Denoiser)
+        {
+            RecordDenoiseCommands(commandBuffer, frameIndex);
+        }
+        _denoiseHistoryValid = _raytracePermutation.Denoiser != 0;
+
+        //the ray counter is read by the host once the frame fence signals
+        VkMemoryBarrier rayCounterBarrier{};
+        rayCounterBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        rayCounterBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        rayCounterBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0,
+            1, &rayCounterBarrier,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+
+    void Tracer::RecordReprojectionCopies(VkCommandBuffer commandBuffer)
+    {
+        VkMemoryBarrier readBarrier{};
+        readBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        readBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        readBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            1, &readBarrier,
+            0, nullptr,
+            0, nullptr
+        );
+
+        //the ray tracing pass reads the previous frame at reprojected positions while it overwrites the current images
+        VkImageCopy region{};
+        region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.srcSubresource.layerCount = 1;
+        region.dstSubresource = region.srcSubresource;
+        region.extent = {_gBufferTexture->GetWidth(), _gBufferTexture->GetHeight(), 1};
+
+        std::vector<std::pair<Resources::Texture2D*, Resources::Texture2D*>> copies = {
+            {_gBufferTexture.get(), _previousGBufferTexture.get()},
+            {_accumulationCountTexture.get(), _previousAccumulationCountTexture.get()},
+        };
+        if(_raytracePermutation.Accumulation == AccumulationFormat::AccumulationFormat_HalfCompensated)
+        {
+            copies.push_back({_halfAccumulationTexture.get(), _previousHalfAccumulationTexture.get()});
+            copies.push_back({_accumulationCompensationTexture.get(), _previousAccumulationCompensationTexture.get()});
+        }
+        else
+        {
+            copies.push_back({_accumulationTexture.get(), _previousAccumulationTexture.get()});
+        }
+
+        for (const auto& [source, destination] : copies)
+        {
+            vkCmdCopyImage(commandBuffer, source->GetImage(), VK_IMAGE_LAYOUT_GENERAL, destination->GetImage(), VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+        }
+
+        VkMemoryBarrier copyBarrier{};
+        copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        copyBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &copyBarrier,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+
+    void Tracer::RecordDenoiseCommands(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+    {
+        bool computeQueue = _device.HasDedicatedComputeQueue();
+        auto& computeTexture = _computeTextures[frameIndex];
+        uint32_t groupCountX = (computeTexture->GetWidth() + 7) / 8;
+        uint32_t groupCountY = (computeTexture->GetHeight() + 7) / 8;
+
+        DenoisePushConstants pushConstants;
+        pushConstants.IterationCount = std::clamp<uint32_t>(_sceneData.DenoiseIterations, 1, DENOISE_MAX_ITERATIONS);
+        pushConstants.HistoryValid = _denoiseHistoryValid;
+
+        //every pass reads neighbours of the pixel that the previous dispatch wrote
+        VkMemoryBarrier passBarrier{};
+        passBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        passBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        passBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        TracyVkZone(_gpuProfiler.GetTracyContext(computeQueue), commandBuffer, "Denoise");
+        _gpuProfiler.BeginPass(commandBuffer, frameIndex, GpuPass::GpuPass_Denoise);
+
+        _rayTracingPipeline->BindVariant(commandBuffer, frameIndex, _denoiseAtrousVariant);
+        for (uint32_t iteration = 0; iteration <= pushConstants.IterationCount; iteration++)
+        {
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                1, &passBarrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            //the pass after the last iteration resolves the result image
+            if(iteration == pushConstants.IterationCount)
+            {
+                _rayTracingPipeline->BindVariant(commandBuffer, frameIndex, _denoiseResolveVariant);
+            }
+
+            pushConstants.Iteration = iteration;
+            vkCmdPushConstants(commandBuffer, _rayTracingPipeline->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DenoisePushConstants), &pushConstants);
+            vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+        }
+
+        _gpuProfiler.EndPass(commandBuffer, frameIndex, GpuPass::GpuPass_Denoise);
+    }
+
+    void Tracer::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex)
     {
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = 0; // Optional
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
         beginInfo.pInheritanceInfo = nullptr; // Optional
 
-        if(vkBeginCommandBuffer(_commandBuffers[index], &beginInfo) != VK_SUCCESS) {
+        if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
             throw std::runtime_error("failed to begin recording command buffer!");
         }
 
+        TracyVkCollect(_gpuProfiler.GetTracyContext(false), commandBuffer);
+        _gpuProfiler.ResetPass(commandBuffer, frameIndex, GpuPass::GpuPass_OnScreen);
+        _gpuProfiler.ResetPass(commandBuffer, frameIndex, GpuPass::GpuPass_UI);
+
+        //Without a dedicated compute queue the dispatch runs in the same command buffer before the on screen pass
+        if(!_device.HasDedicatedComputeQueue())
+        {
+            RecordComputeCommands(commandBuffer, frameIndex);
+
+            VkImageMemoryBarrier resultBarrier{};
+            resultBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            resultBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            resultBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            resultBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+            resultBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+            resultBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            resultBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            resultBarrier.image = _computeTextures[frameIndex]->GetImage();
+            resultBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            resultBarrier.subresourceRange.baseMipLevel = 0;
+            resultBarrier.subresourceRange.levelCount = 1;
+            resultBarrier.subresourceRange.baseArrayLayer = 0;
+            resultBarrier.subresourceRange.layerCount = 1;
+
+            //the heatmap views read the traversal counters instead
+            std::array<VkImageMemoryBarrier, 2> imageBarriers = {resultBarrier, resultBarrier};
+            imageBarriers[1].image = _traversalStatsTextures[frameIndex]->GetImage();
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                0,
+                0, nullptr,
+                0, nullptr,
+                static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data()
+            );
+        }
+
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassInfo.renderPass = _swapChain->GetGraphicsRenderPass();
-        renderPassInfo.framebuffer = _swapChain->GetFrameBuffer(index);
+        renderPassInfo.framebuffer = _swapChain->GetFrameBuffer(imageIndex);
 
         renderPassInfo.renderArea.offset = {0, 0};
         renderPassInfo.renderArea.extent = _swapChain->GetExtent();
@@ -519,7 +1615,7 @@ namespace TracerCore
         renderPassInfo.clearValueCount = clearValues.size();
         renderPassInfo.pClearValues = clearValues.data();
 
-        vkCmdBeginRenderPass(_commandBuffers[index], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         VkViewport viewport{};
         viewport.x = 0.0f;
@@ -529,18 +1625,28 @@ namespace TracerCore
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
         VkRect2D scissor{{0, 0}, _swapChain->GetExtent()};
-        vkCmdSetViewport(_commandBuffers[index], 0, 1, &viewport);
-        vkCmdSetScissor(_commandBuffers[index], 0, 1, &scissor);
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
         
-        _graphicsPipeline->Bind(_commandBuffers[index], index);
-        //_model->Bind(_commandBuffers[index]);
-        vkCmdDraw(_commandBuffers[index], 6, 1, 0, 0);
+        {
+            TracyVkZone(_gpuProfiler.GetTracyContext(false), commandBuffer, "On screen");
+            _gpuProfiler.BeginPass(commandBuffer, frameIndex, GpuPass::GpuPass_OnScreen);
+            _graphicsPipeline->Bind(commandBuffer, frameIndex);
+            //_model->Bind(commandBuffer);
+            vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+            _gpuProfiler.EndPass(commandBuffer, frameIndex, GpuPass::GpuPass_OnScreen);
+        }
 
-        _uiLayer->Render(_commandBuffers[index]);
+        {
+            TracyVkZone(_gpuProfiler.GetTracyContext(false), commandBuffer, "UI");
+            _gpuProfiler.BeginPass(commandBuffer, frameIndex, GpuPass::GpuPass_UI);
+            _uiLayer->Render(commandBuffer);
+            _gpuProfiler.EndPass(commandBuffer, frameIndex, GpuPass::GpuPass_UI);
+        }
 
-        vkCmdEndRenderPass(_commandBuffers[index]);
+        vkCmdEndRenderPass(commandBuffer);
 
-        if(vkEndCommandBuffer(_commandBuffers[index]) != VK_SUCCESS) {
+        if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to record command buffer!");
         }
     }
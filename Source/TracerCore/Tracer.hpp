@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <memory>
 #include <vector>
+#include <unordered_map>
 
 #include "Window.hpp"
 #include "VulkanDevice.hpp"
@@ -21,6 +23,17 @@
 #include "UI/StatisicUILayer.hpp"
 #include "UI/FrameControllsUI.hpp"
 #include "TracerScene.hpp"
+#include "RaytracePermutation.hpp"
+#include "RaytraceAutotuner.hpp"
+#include "GpuProfiler.hpp"
+#include "TraversalStatistics.hpp"
+#include "BatchJob.hpp"
+#include "Benchmark.hpp"
+#include "SamplerStudy.hpp"
+#include "RouletteStudy.hpp"
+#include "LightStudy.hpp"
+#include "Denoiser.hpp"
+#include "Accumulation.hpp"
 
 namespace TracerCore
 {
@@ -43,18 +56,87 @@ namespace TracerCore
         alignas(4) float DefocusDiskU;
         alignas(4) float DefocusDiskV;
 
+        alignas(4) uint32_t DirectTriangleFetch;
+        alignas(4) uint32_t CompactVertices;
+
         //scene data
         alignas(16) glm::vec3 aabbMin;
         alignas(16) glm::vec3 aabbMax;
+
+        //debug view, read by the on screen pass
+        alignas(4) uint32_t DebugView;
+        alignas(4) float HeatmapMax;
+
+        //adaptive sampling, tiles are the workgroups of the ray tracing pass
+        alignas(4) uint32_t AdaptiveTileCountX;
+        alignas(4) uint32_t AdaptiveTileCount;
+        alignas(4) float AdaptiveThreshold;
+        alignas(4) uint32_t AdaptiveMinFrames;
+
+        alignas(4) uint32_t RouletteMinBounce;
+
+        //camera of the previous frame, used to reproject history
+        alignas(16) glm::mat4x4 PrevProjection;
+        glm::mat4x4 PrevView;
+
+        //1 when the camera moved since the previous frame, REPROJECTION permutations then reproject the accumulation
+        alignas(4) uint32_t ReprojectHistory;
+        alignas(4) uint32_t ReprojectionMaxHistory;
+    };
+
+    /// @brief Start up options, parsed from the command line.
+    struct TracerSettings
+    {
+        // offscreen rendering without window, swap chain and UI
+        bool Headless = false;
+        uint32_t Width = 1024;
+        uint32_t Height = 1024;
+        // accumulated frames of a headless render
+        uint32_t FrameCount = 256;
+        std::string OutputPath = "Render.png";
+        // empty loads the default model
+        std::string ModelPath;
+        AccStructureType AccStructureType = AccStructureType::AccStructure_BVH;
+        AccHeruishitcType AccHeruishitcType = AccHeruishitcType::AccHeruishitc_SAH;
+        // renders the jobs of the file instead of a single image
+        std::string BatchFile;
+        // runs the fixed benchmark of every bundled model instead of a single image
+        bool Benchmark = false;
+        // stored in the benchmark report, e.g. the commit hash
+        std::string BenchmarkLabel;
+        // relative error at which tiles stop tracing, 0 traces every pixel of every frame
+        float AdaptiveThreshold = 0.0f;
+        // bounce after which paths are terminated by russian roulette, 0 traces every path to the bounce limit
+        uint32_t RouletteMinBounce = 3;
+        // compares the path length, frame time and error of russian roulette with fixed depth tracing, FrameCount is the frame budget
+        bool RouletteStudy = false;
+        // sky light sampling with shadow rays, false traces BSDF sampled paths only
+        bool NextEventEstimation = true;
+        // equal time error of light sampling against BSDF sampling on the bundled scenes, FrameCount is the frame budget
+        bool LightStudy = false;
+        // measures the convergence of the samplers, FrameCount is the frame budget
+        bool SamplerStudy = false;
+        // a-trous denoiser after the ray tracing pass
+        bool Denoiser = false;
+        // compares the GPU denoiser with its CPU reference and the noisy and denoised frames with a long accumulation
+        bool DenoiseCheck = false;
+        // per pixel frame counts and reprojection of the accumulation while the camera moves
+        bool Reprojection = false;
+        // camera orbit around the default target of a headless render, in degrees per frame
+        float OrbitDegrees = 0.0f;
+        // compares an orbit rendered with reprojection and one restarting every frame with a long accumulation at the final pose
+        bool ReprojectionCheck = false;
+        AccumulationFormat Accumulation = AccumulationFormat::AccumulationFormat_Float32;
+        // compares the accumulation formats on the same samples and reports their trace times and accumulation traffic
+        bool AccumulationCheck = false;
+        // empty writes BatchReport.json, Benchmark.json, SamplerStudy.json, RouletteStudy.json or LightStudy.json
+        std::string ReportPath;
     };
 
     class Tracer
     {
     public:
-        static constexpr int WIDTH = 1024;
-        static constexpr int HEIGHT = 1024;
-
-        Tracer();
+        Tracer(const TracerSettings& settings = {});
         ~Tracer();
 
         Tracer(const Tracer&) = delete;
@@ -62,9 +144,32 @@ namespace TracerCore
 
         void Run();
     private:
+        // start pose of the camera, headless orbits turn around the target
+        static inline const glm::vec3 DEFAULT_CAMERA_POSITION = glm::vec3(3, .4, .4);
+        static inline const glm::vec3 DEFAULT_CAMERA_TARGET = glm::vec3(0, .5, 0);
+        // frames of a study reference per frame of the measured renders
+        static constexpr uint32_t STUDY_REFERENCE_MULTIPLIER = 16;
+
         void LoadModels();
         void LoadImages();
+        /// @brief Creates the accumulation images of both formats, the ones of the unused format as 1x1 placeholders.
+        void LoadAccumulationImages();
+        /// @brief Creates the traversal counter images, full size only for TRAVERSAL_STATS permutations.
+        void LoadTraversalStatsImages();
+        /// @brief Creates the G-buffer and the denoiser images, 1x1 placeholders for permutations that do not use them.
+        void LoadDenoiseImages();
+        /// @brief Creates the per pixel frame counts and the previous frame copies of the reprojection, full size only for REPROJECTION permutations.
+        void LoadReprojectionImages();
+        /// @brief Creates a device local storage image in GENERAL layout, shared by the graphics and compute queue families.
+        std::unique_ptr<Resources::Texture2D> CreateStorageTexture(VkExtent2D extent, VkFormat format, VkImageUsageFlags transferUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
         void SwitchRaytracePipeline();
+        /// @brief Returns the variant index of the permutation in the ray tracing pipeline object, builds the pipeline on first use.
+        uint32_t GetRaytraceVariant(const RaytracePermutation& permutation);
+        void SetRaytracePermutation(const RaytracePermutation& permutation);
+        /// @brief Collects GPU timings and the ray count of the frame slot that is about to be reused and drives the autotuner.
+        void UpdateRaytraceTiming(uint32_t frameIndex);
+        /// @brief Reads back the traversal stats image of the last traced frame, prints the reduction and exports the requested heatmap.
+        void CaptureTraversalStats();
         void CreateBuffers();
         
         void CreateOnScreenPipelines();
@@ -72,39 +177,134 @@ namespace TracerCore
 
         void DrawFrame();
         void RecreateSwapChain();
+        /// @brief Traces FrameCount accumulated frames without presenting and writes the result image to OutputPath.
+        void RenderHeadless();
+        // offscreen runs, each defined in the source file of its report or CPU reference, e.g. RunLightStudy in LightStudy.cpp
+        /// @brief Renders all jobs of the batch file, jobs sharing a scene are grouped so each scene is built once.
+        void RunBatch();
+        /// @brief Renders the fixed waypoints of every bundled model with every acceleration structure and writes a report of the GPU trace timings.
+        void RunBenchmark();
+        /// @brief Compares the convergence of the PCG and Sobol samplers on the CPU reference integrand and in the ray tracing pass.
+        void RunSamplerStudy();
+        void RunRouletteStudy();
+        void RunLightStudy();
+        void RunDenoiseCheck();
+        void RunReprojectionCheck();
+        void RunAccumulationCheck();
+        /// @brief Accumulates STUDY_REFERENCE_MULTIPLIER times frameCount frames with the current settings and camera and reads back their mean.
+        /// The reference image the studies and checks measure their errors against, name is printed with the progress.
+        std::vector<float> RenderReference(uint32_t frameCount, const std::string& name = "");
+        /// @brief Reads back the accumulation image of the last RenderAccumulated call divided by its frame count, or by the frame count of each pixel with reprojection.
+        std::vector<float> ReadAccumulatedImage(uint32_t frameCount);
+        /// @brief Reads back an rgba32f, rgba16f, rgba8, rgba8 snorm or r32ui image as floats.
+        std::vector<float> ReadTexture(Resources::Texture2D* texture);
+        /// @brief Loads the model and builds the acceleration structure for an offscreen run.
+        /// @return scene build time in milliseconds
+        float SwitchScene(const std::string& modelPath, AccStructureType accStructureType, AccHeruishitcType accHeruishitcType);
+        /// @brief Traces frameCount frames into the accumulation image as fast as possible, the result image of _lastTracedFrameIndex holds the average.
+        /// A non zero orbitDegreesPerFrame moves the camera around the default camera target between frames.
+        RenderTimings RenderAccumulated(uint32_t frameCount, float orbitDegreesPerFrame = 0.0f);
+        /// @brief Recreates the render targets of a headless tracer at a new size.
+        void ResizeRenderTargets(uint32_t width, uint32_t height);
+        void BindRenderTargets();
+        VkExtent2D GetRenderExtent() const;
         void CreateCommandBuffers();
-        void RecordCommandBuffer(int index);
+        void CreateComputeSyncObjects();
+        void CreateHeadlessSyncObjects();
+        /// @brief Writes the tile grid of the current permutation and the convergence settings into the frame data.
+        void UpdateAdaptiveFrameData();
+        void RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex);
+        void RecordComputeCommands(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+        /// @brief Copies the accumulation, frame count and G-buffer images of the previous frame before a frame with camera motion.
+        void RecordReprojectionCopies(VkCommandBuffer commandBuffer);
+        /// @brief Records the a-trous iterations and the resolve pass after the ray tracing pass.
+        void RecordDenoiseCommands(VkCommandBuffer commandBuffer, uint32_t frameIndex);
         void FreeCommandBuffers();
 
-        Window _mainWindow{WIDTH, HEIGHT, "Sorpirit Raytracer"};
-        VulkanDevice _device{_mainWindow};
+        TracerSettings _settings;
+        // nullptr in headless mode
+        std::unique_ptr<Window> _mainWindow;
+        VulkanDevice _device{_mainWindow.get()};
         ShaderReosuceManager _shaderResourceManager{_device};
         PipelineManager _pipelineManager{_device};
 
         TracerScene _scene{_device};
+        // model file the scene was built from, acceleration structure changes rebuild without reloading it
+        std::string _loadedModelPath;
 
         TracerCamera _camera;
         UI::SceneData _sceneData;
         FrameData _frameData;
         UI::FrameStatisics _frameStats;
         MaterialsSettings _materialsSettings;
-        void* _frameDataPtr;
+        std::vector<void*> _frameDataPtrs;
 
         std::unique_ptr<SwapChain> _swapChain;
         std::vector<VkCommandBuffer> _commandBuffers;
+        // only used when the device has a dedicated compute queue family
+        std::vector<VkCommandBuffer> _computeCommandBuffers;
+        std::vector<VkSemaphore> _computeFinishedSemaphores;
+        // frame slot fences of headless rendering, the swap chain owns them otherwise
+        std::vector<VkFence> _headlessFences;
 
         std::unique_ptr<UI::UILayer> _uiLayer;
 
         std::unique_ptr<Resources::Texture2D> _texture2d;
         
-        std::unique_ptr<Resources::Texture2D> _computeTexture;
+        // one result image per frame in flight so tracing of the next frame can overlap sampling of the current one
+        std::vector<std::unique_ptr<Resources::Texture2D>> _computeTextures;
+        // rgba32f sums, or the rgba16f mean and its compensation, see Accumulation.glsl. The images of the unused format are 1x1
         std::unique_ptr<Resources::Texture2D> _accumulationTexture;
+        std::unique_ptr<Resources::Texture2D> _halfAccumulationTexture;
+        std::unique_ptr<Resources::Texture2D> _accumulationCompensationTexture;
+        // per frame in flight like the result images, sampled by the on screen pass in heatmap views
+        std::vector<std::unique_ptr<Resources::Texture2D>> _traversalStatsTextures;
+        // tile states with the indirect dispatch arguments in front, and the active tile list. Shared by all frame slots like the accumulation image
+        std::unique_ptr<Resources::VulkanBuffer> _adaptiveTileStateBuffer;
+        std::unique_ptr<Resources::VulkanBuffer> _adaptiveActiveTileBuffer;
+        uint32_t _adaptiveTileCapacity = 0;
+        // compaction pass variant of the ray tracing pipeline object
+        uint32_t _adaptiveTilesVariant = 0;
+        // G-buffer, noisy frame and the ping pong images of the a-trous iterations, shared by all frame slots
+        std::unique_ptr<Resources::Texture2D> _gBufferTexture;
+        std::unique_ptr<Resources::Texture2D> _albedoTexture;
+        std::unique_ptr<Resources::Texture2D> _denoiseInputTexture;
+        std::array<std::unique_ptr<Resources::Texture2D>, 2> _denoiseTextures;
+        // denoised color per frame slot, every frame reads the history of the previous slot
+        std::vector<std::unique_ptr<Resources::Texture2D>> _denoiseHistoryTextures;
+        uint32_t _denoiseAtrousVariant = 0;
+        uint32_t _denoiseResolveVariant = 0;
+        // false until a denoised frame wrote the history the next frame reads
+        bool _denoiseHistoryValid = false;
+        // per pixel frame counts of the reprojection and their copies for frames with camera motion, shared by all frame slots
+        std::unique_ptr<Resources::Texture2D> _accumulationCountTexture;
+        std::unique_ptr<Resources::Texture2D> _previousAccumulationTexture;
+        std::unique_ptr<Resources::Texture2D> _previousHalfAccumulationTexture;
+        std::unique_ptr<Resources::Texture2D> _previousAccumulationCompensationTexture;
+        std::unique_ptr<Resources::Texture2D> _previousGBufferTexture;
+        std::unique_ptr<Resources::Texture2D> _previousAccumulationCountTexture;
+        // set by scene, image and permutation changes, the next frame of a reprojecting tracer starts a new accumulation
+        bool _restartAccumulation = true;
+        uint32_t _lastTracedFrameIndex = 0;
+        bool _lastTracedWithStats = false;
 
-        std::unique_ptr<Resources::VulkanBuffer> _framedataBuffer;
+        // one uniform buffer per frame in flight, so the CPU never writes data the GPU is still reading
+        std::vector<std::unique_ptr<Resources::VulkanBuffer>> _framedataBuffers;
         std::unique_ptr<Resources::VulkanBuffer> _triangleBuffer;
+        // rays traced per frame slot, counted by the ray tracing shader and read back by the host
+        std::vector<std::unique_ptr<Resources::VulkanBuffer>> _rayCounterBuffers;
+        std::unique_ptr<Resources::VulkanBuffer> _samplerTablesBuffer;
+        std::vector<uint32_t*> _rayCounterPtrs;
 
         std::unique_ptr<PipelineObject> _graphicsPipeline;
         std::unique_ptr<PipelineObject> _rayTracingPipeline;
+        RaytracePermutation _raytracePermutation;
+        std::unordered_map<RaytracePermutation, uint32_t, RaytracePermutationHash> _raytraceVariants;
+
+        GpuProfiler _gpuProfiler{_device, SwapChain::MAX_FRAMES_IN_FLIGHT};
+        RaytraceAutotuner _autotuner{_device};
+        // autotune candidate each frame slot was traced with
+        std::vector<uint32_t> _timestampCandidates = std::vector<uint32_t>(SwapChain::MAX_FRAMES_IN_FLIGHT, RaytraceAutotuner::NO_CANDIDATE);
     };
     
 }
\ No newline at end of file
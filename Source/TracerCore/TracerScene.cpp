@@ -3,9 +3,14 @@
 #include "AccelerationStructures/BHVTree.hpp"
 #include "AccelerationStructures/KdTree.hpp"
 
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
 #include <tracy/Tracy.hpp>
 
 #include "../TracerUtils/Math/RandomHelper.hpp"
+#include "Models/CompactTracerVertex.hpp"
+#include "Resources/UploadManager.hpp"
 
 namespace TracerCore
 {
@@ -18,9 +23,9 @@ namespace TracerCore
     {
     }
 
-    void TracerScene::AddModel(TracerUtils::Models::TracerMesh& model)
+    void TracerScene::AddModel(TracerUtils::Models::TracerMesh&& model)
     {
-        _models.push_back(&model);
+        _models.push_back(std::move(model));
     }
 
     void TracerScene::BuildMaterials(const MaterialsSettings& materialsSettings)
@@ -32,9 +37,9 @@ namespace TracerCore
         groundMaterial.fuzz = 1.0f;
         _materials.push_back(groundMaterial);
 
-        for (const auto& model : _models)
+        for (auto& model : _models)
         {
-            for (auto& part : model->Parts)
+            for (auto& part : model.Parts)
             {
                 Material material;
 
@@ -55,30 +60,44 @@ namespace TracerCore
         }
 
         VkDeviceSize materialsSize = sizeof(Material) * _materials.size();
-        _materialsBuffer = Resources::VulkanBuffer::CreateBuffer(_device, materialsSize, 
-                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
-
-        void *data;
-        _materialsBuffer->MapMemory(materialsSize, 0, &data);
-        memcpy(data, _materials.data(), materialsSize);
-        _materialsBuffer->UnmapMemory();
+        _materialsBuffer = _device.GetUploadManager().CreateDeviceLocalBuffer(_materials.data(), materialsSize, 
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Resources::MemoryCategory::Scene);
+        _device.GetUploadManager().Flush();
 
         _materials.clear();
     }
 
-    void TracerScene::BuildScene(AccStructureType accType, AccHeruishitcType accHeruishitcType)
+    void TracerScene::BuildScene(AccStructureType accType, AccHeruishitcType accHeruishitcType, bool reorderLeafTriangles, bool compactVertices)
     {
         ZoneScoped;
+        if(_models.empty())
+        {
+            throw std::runtime_error("failed to build scene, no model loaded!");
+        }
+
         std::vector<TracerUtils::Models::TracerVertex> vertecies;
         std::vector<uint32_t> indices;
 
         _vertexBuffer = nullptr;
         _indexBuffer = nullptr;
 
-        for (const auto model : _models)
+        size_t verteciesCount = 0;
+        size_t indicesCount = 0;
+        for (const auto& model : _models)
         {
-            for (const auto part : model->Parts)
+            for (const auto& part : model.Parts)
+            {
+                verteciesCount += part.Vertices.size();
+                indicesCount += part.Indices.size();
+            }
+        }
+
+        vertecies.reserve(verteciesCount);
+        indices.reserve(indicesCount);
+
+        for (const auto& model : _models)
+        {
+            for (const auto& part : model.Parts)
             {
                 uint32_t partOffset = vertecies.size();
                 vertecies.insert(vertecies.end(), part.Vertices.begin(), part.Vertices.end());
@@ -90,19 +109,21 @@ namespace TracerCore
             }
         }
 
-        for (const auto vertex : vertecies)
+        _aabbMin = glm::vec3(FLT_MAX);
+        _aabbMax = glm::vec3(-FLT_MAX);
+        for (const auto& vertex : vertecies)
         {
             _aabbMin = glm::min(_aabbMin, vertex.Position);
             _aabbMax = glm::max(_aabbMax, vertex.Position);
         }
 
-        _models.clear();
+        //the models stay loaded so an acceleration structure change rebuilds from them
 
         _accStructure = nullptr;
         switch (accType)
         {
             case AccStructureType::AccStructure_BVH:
-                _accStructure = std::make_unique<AccelerationStructures::BHVTree>(_device, accHeruishitcType, vertecies, indices);
+                _accStructure = std::make_unique<AccelerationStructures::BHVTree>(_device, accHeruishitcType, reorderLeafTriangles, vertecies, indices);
                 break;
             case AccStructureType::AccStructure_KdTree:
                 auto kdTree = std::make_unique<AccelerationStructures::KdTree>(_device, accHeruishitcType, vertecies, indices);
@@ -113,25 +134,116 @@ namespace TracerCore
         }
 
         //Upload scene data to GPU
-        VkDeviceSize verteciesSize = sizeof(TracerUtils::Models::TracerVertex) * vertecies.size();
+        _compactVertices = compactVertices;
+        if(_compactVertices)
+        {
+            //the compact layout keeps 16 bits of the material index, larger scenes fall back to the full layout
+            auto materialOutOfRange = [](const TracerUtils::Models::TracerVertex& vertex) { return vertex.MaterialFlag > TracerUtils::Models::COMPACT_MAX_MATERIAL_INDEX; };
+            if(std::any_of(vertecies.begin(), vertecies.end(), materialOutOfRange))
+            {
+                std::cout << "Compact vertices hold material indices up to " << TracerUtils::Models::COMPACT_MAX_MATERIAL_INDEX << ", using the full vertex layout" << std::endl;
+                _compactVertices = false;
+            }
+        }
+        std::vector<TracerUtils::Models::CompactTracerVertex> compactVertecies;
+        if(_compactVertices)
+        {
+            compactVertecies.reserve(vertecies.size());
+            for (const auto& vertex : vertecies)
+            {
+                compactVertecies.push_back(TracerUtils::Models::EncodeVertex(vertex));
+            }
+        }
+
+        const void* verteciesData = _compactVertices ? static_cast<const void*>(compactVertecies.data()) : static_cast<const void*>(vertecies.data());
+        VkDeviceSize verteciesSize = _compactVertices ? 
+            sizeof(TracerUtils::Models::CompactTracerVertex) * compactVertecies.size() : 
+            sizeof(TracerUtils::Models::TracerVertex) * vertecies.size();
         VkDeviceSize indicesSize = sizeof(uint32_t) * indices.size();
 
-        _vertexBuffer = Resources::VulkanBuffer::CreateBuffer(_device, verteciesSize, 
-                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
-        
-        _indexBuffer = Resources::VulkanBuffer::CreateBuffer(_device, indicesSize, 
-                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
-
-        void *data;
-        _vertexBuffer->MapMemory(verteciesSize, 0, &data);
-        memcpy(data, vertecies.data(), verteciesSize);
-        _vertexBuffer->UnmapMemory();
-
-        _indexBuffer->MapMemory(indicesSize, 0, &data);
-        memcpy(data, indices.data(), indicesSize);
-        _indexBuffer->UnmapMemory();
+        std::cout << "Vertex buffer: " << vertecies.size() << " vertices, " << verteciesSize / 1024 << " KB" << (_compactVertices ? " (compact)" : "") << std::endl;
+
+        //transfer source so Occluded can read the geometry back instead of keeping a host copy
+        _vertexBuffer = _device.GetUploadManager().CreateDeviceLocalBuffer(verteciesData, verteciesSize, 
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Resources::MemoryCategory::Scene);
+
+        //Acceleration structures upload their own reordered indices
+        _trianglePositions.clear();
+        if(_accStructure == nullptr)
+        {
+            _indexBuffer = _device.GetUploadManager().CreateDeviceLocalBuffer(indices.data(), indicesSize, 
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Resources::MemoryCategory::Scene);
+        }
+
+        //node, index and vertex copies are in flight on the transfer queue until here
+        _device.GetUploadManager().Flush();
+    }
+
+    bool TracerScene::Occluded(const TracerUtils::Math::Ray &ray, float tMin, float tMax) const
+    {
+        if(_trianglePositions.empty())
+        {
+            LoadTrianglePositions();
+        }
+
+        if(_accStructure != nullptr)
+            return _accStructure->Occluded(ray, tMin, tMax, _trianglePositions);
+
+        float tStart = tMin;
+        float tEnd = tMax;
+        if(!TracerUtils::Math::IntersectAabb(ray, _aabbMin, _aabbMax, tStart, tEnd) || tStart > tMax)
+            return false;
+
+        for (size_t i = 0; i < _trianglePositions.size(); i += 3)
+        {
+            if(TracerUtils::Math::OccludedByTriangle(ray, _trianglePositions[i], _trianglePositions[i + 1], _trianglePositions[i + 2], tMin, tMax))
+                return true;
+        }
+        return false;
+    }
+
+    void TracerScene::LoadTrianglePositions() const
+    {
+        ZoneScoped;
+
+        std::vector<uint8_t> vertexData = _vertexBuffer->ReadBack();
+        std::vector<glm::vec3> positions;
+        if(_compactVertices)
+        {
+            const auto* compactVertecies = reinterpret_cast<const TracerUtils::Models::CompactTracerVertex*>(vertexData.data());
+            size_t vertexCount = vertexData.size() / sizeof(TracerUtils::Models::CompactTracerVertex);
+            positions.reserve(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                positions.push_back(TracerUtils::Models::DecodeVertex(compactVertecies[i]).Position);
+            }
+        }
+        else
+        {
+            const auto* vertecies = reinterpret_cast<const TracerUtils::Models::TracerVertex*>(vertexData.data());
+            size_t vertexCount = vertexData.size() / sizeof(TracerUtils::Models::TracerVertex);
+            positions.reserve(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                positions.push_back(vertecies[i].Position);
+            }
+        }
+
+        //leaf ordered vertices are already three per triangle in traversal order
+        if(IsLeafOrdered())
+        {
+            _trianglePositions = std::move(positions);
+            return;
+        }
+
+        std::vector<uint8_t> indexData = GetIndexBuffer()->ReadBack();
+        const auto* indices = reinterpret_cast<const uint32_t*>(indexData.data());
+        size_t indexCount = indexData.size() / sizeof(uint32_t);
+        _trianglePositions.reserve(indexCount);
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            _trianglePositions.push_back(positions[indices[i]]);
+        }
     }
 
     void TracerScene::AttachSceneGeometry(const ShaderReosuceManager &resourceManager, const std::vector<VkDescriptorSet> &descriptosSets) const
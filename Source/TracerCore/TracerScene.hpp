@@ -48,9 +48,10 @@ namespace TracerCore
         TracerScene(const TracerScene&) = delete;
         TracerScene &operator=(const TracerScene&) = delete;
 
-        void AddModel(TracerUtils::Models::TracerMesh& model);
+        void AddModel(TracerUtils::Models::TracerMesh&& model);
+        inline void ClearModels() { _models.clear(); }
         void BuildMaterials(const MaterialsSettings& materialsSettings);
-        void BuildScene(AccStructureType accType, AccHeruishitcType accHeruishitcType);
+        void BuildScene(AccStructureType accType, AccHeruishitcType accHeruishitcType, bool reorderLeafTriangles, bool compactVertices);
 
         inline const AccelerationStructures::AccelerationStructure& GetAccelerationStructure() const { return *_accStructure; }
         inline const Resources::VulkanBuffer* GetVertexBuffer() const { return _vertexBuffer.get(); }
@@ -59,14 +60,21 @@ namespace TracerCore
         inline const glm::vec3& GetAABBMin() const { return _aabbMin; }
         inline const glm::vec3& GetAABBMax() const { return _aabbMax; }
         inline const uint32_t GetIndeciesCount() const { return _accStructure == nullptr ? 0 : _accStructure->GetIndeciesCount(); }
+        inline bool IsLeafOrdered() const { return _accStructure != nullptr && _accStructure->IsLeafOrdered(); }
+        inline bool UsesCompactVertices() const { return _compactVertices; }
+
+        /// @brief CPU any hit query against the scene meshes, the acceleration structure or a loop over all triangles like SimpleLoop.glsl.
+        /// The first call reads the vertex and index buffers back from the GPU, make it from a single thread.
+        bool Occluded(const TracerUtils::Math::Ray& ray, float tMin, float tMax) const;
     
         void AttachSceneGeometry(const ShaderReosuceManager& resourceManager, const std::vector<VkDescriptorSet>& descriptosSets) const;
 
     private:
+        void LoadTrianglePositions() const;
         
         VulkanDevice& _device;
 
-        std::vector<TracerUtils::Models::TracerMesh*> _models;
+        std::vector<TracerUtils::Models::TracerMesh> _models;
         std::vector<Material> _materials;
 
         std::unique_ptr<Resources::VulkanBuffer> _vertexBuffer;
@@ -74,6 +82,9 @@ namespace TracerCore
         std::unique_ptr<Resources::VulkanBuffer> _materialsBuffer;
 
         std::unique_ptr<AccelerationStructures::AccelerationStructure> _accStructure;
+        bool _compactVertices = false;
+        // three positions per uploaded index, built on the first Occluded call
+        mutable std::vector<glm::vec3> _trianglePositions;
 
         glm::vec3 _aabbMin = glm::vec3(FLT_MAX);
         glm::vec3 _aabbMax = glm::vec3(-FLT_MAX);
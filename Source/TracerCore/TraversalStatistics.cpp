@@ -0,0 +1,112 @@
+#include "TraversalStatistics.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <vector>
+
+#include "TracerIO.hpp"
+
+namespace TracerCore
+{
+    static uint32_t GetHistogramBucket(uint32_t value)
+    {
+        uint32_t bucket = 0;
+        while (value > 0 && bucket < TraversalStatsReport::HISTOGRAM_BUCKETS - 1)
+        {
+            value >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    TraversalStatsReport TraversalStatsReport::Reduce(const uint32_t *texels, uint32_t width, uint32_t height)
+    {
+        TraversalStatsReport report;
+        report.Width = width;
+        report.Height = height;
+
+        for (size_t pixel = 0; pixel < static_cast<size_t>(width) * height; pixel++)
+        {
+            for (uint32_t counter = 0; counter < COUNTER_COUNT; counter++)
+            {
+                uint32_t value = texels[pixel * 4 + counter];
+                report.Totals[counter] += value;
+                report.Max[counter] = std::max(report.Max[counter], value);
+                report.Histograms[counter][GetHistogramBucket(value)]++;
+            }
+        }
+
+        return report;
+    }
+
+    void TraversalStatsReport::Print(std::ostream &stream) const
+    {
+        stream << "Traversal statistics " << Width << "x" << Height << std::endl;
+        for (uint32_t counter = 0; counter < COUNTER_COUNT; counter++)
+        {
+            TraversalCounter traversalCounter = static_cast<TraversalCounter>(counter);
+            stream << "  " << std::setw(14) << std::left << GetCounterName(traversalCounter) << std::right
+                << " total " << Totals[counter]
+                << " avg/pixel " << std::fixed << std::setprecision(2) << GetAverage(traversalCounter) << std::defaultfloat
+                << " max " << Max[counter] << std::endl;
+
+            stream << "    histogram";
+            for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+            {
+                stream << " " << Histograms[counter][bucket];
+            }
+            stream << std::endl;
+        }
+    }
+
+    const char *TraversalStatsReport::GetCounterName(TraversalCounter counter)
+    {
+        switch (counter)
+        {
+        case TraversalCounter::TraversalCounter_Nodes: return "Nodes";
+        case TraversalCounter::TraversalCounter_AabbTests: return "AABB tests";
+        case TraversalCounter::TraversalCounter_TriangleTests: return "Triangle tests";
+        case TraversalCounter::TraversalCounter_Rays: return "Rays";
+        default: return "Unknown";
+        }
+    }
+
+    glm::vec3 HeatmapColor(float t)
+    {
+        t = glm::clamp(t, 0.0f, 1.0f);
+        return glm::clamp(glm::vec3(4.0f * t - 2.0f, std::min(4.0f * t, 4.0f - 4.0f * t), 2.0f - 4.0f * t), 0.0f, 1.0f);
+    }
+
+    void SaveTraversalHeatmap(const std::string &filePath, const uint32_t *texels, uint32_t width, uint32_t height, TraversalCounter counter, float heatmapMax)
+    {
+        size_t pixelCount = static_cast<size_t>(width) * height;
+
+        if(std::filesystem::path(filePath).extension() == ".hdr")
+        {
+            std::vector<float> counts(pixelCount * 3);
+            for (size_t pixel = 0; pixel < pixelCount; pixel++)
+            {
+                for (uint32_t channel = 0; channel < 3; channel++)
+                {
+                    counts[pixel * 3 + channel] = static_cast<float>(texels[pixel * 4 + channel]);
+                }
+            }
+
+            TracerUtils::IOHelpers::SaveImageHdr(filePath, counts.data(), width, height, 3);
+            return;
+        }
+
+        std::vector<stbi_uc> heatmap(pixelCount * 4);
+        for (size_t pixel = 0; pixel < pixelCount; pixel++)
+        {
+            glm::vec3 color = HeatmapColor(texels[pixel * 4 + static_cast<uint32_t>(counter)] / heatmapMax);
+            heatmap[pixel * 4 + 0] = static_cast<stbi_uc>(color.r * 255.0f);
+            heatmap[pixel * 4 + 1] = static_cast<stbi_uc>(color.g * 255.0f);
+            heatmap[pixel * 4 + 2] = static_cast<stbi_uc>(color.b * 255.0f);
+            heatmap[pixel * 4 + 3] = 255;
+        }
+
+        TracerUtils::IOHelpers::SaveImage(filePath, heatmap.data(), width, height, 4);
+    }
+}
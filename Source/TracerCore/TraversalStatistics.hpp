@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <ostream>
+#include <glm/glm.hpp>
+
+namespace TracerCore
+{
+    /// @brief Channels of the traversal stats image written by TRAVERSAL_STATS permutations.
+    enum class TraversalCounter : uint32_t
+    {
+        TraversalCounter_Nodes,
+        TraversalCounter_AabbTests,
+        TraversalCounter_TriangleTests,
+        TraversalCounter_Rays,
+        TraversalCounter_Count
+    };
+
+    /// @brief Per pixel traversal cost of one frame reduced to totals and log2 histograms.
+    struct TraversalStatsReport
+    {
+        static constexpr uint32_t COUNTER_COUNT = static_cast<uint32_t>(TraversalCounter::TraversalCounter_Count);
+        // bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i), the last bucket is open ended
+        static constexpr uint32_t HISTOGRAM_BUCKETS = 16;
+
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::array<uint64_t, COUNTER_COUNT> Totals{};
+        std::array<uint32_t, COUNTER_COUNT> Max{};
+        std::array<std::array<uint32_t, HISTOGRAM_BUCKETS>, COUNTER_COUNT> Histograms{};
+
+        /// @param texels rgba32ui texels, one uvec4 of counters per pixel.
+        static TraversalStatsReport Reduce(const uint32_t* texels, uint32_t width, uint32_t height);
+
+        inline double GetAverage(TraversalCounter counter) const { return Totals[static_cast<uint32_t>(counter)] / static_cast<double>(Width * Height); }
+
+        void Print(std::ostream& stream) const;
+
+        static const char* GetCounterName(TraversalCounter counter);
+    };
+
+    /// @brief Same ramp as HeatmapColor in color.glsl.
+    glm::vec3 HeatmapColor(float t);
+
+    /// @brief Saves the traversal stats image. .hdr files store the raw node, AABB and triangle counts as float RGB,
+    /// any other extension is written as a PNG heatmap of one counter scaled by heatmapMax.
+    void SaveTraversalHeatmap(const std::string& filePath, const uint32_t* texels, uint32_t width, uint32_t height, TraversalCounter counter, float heatmapMax);
+}
@@ -1,6 +1,8 @@
 #include "FrameControllsUI.hpp"
 #include <imgui.h>
 
+#include "../Denoiser.hpp"
+
 namespace TracerCore::UI
 {
     FrameControllsUI::FrameControllsUI(VulkanDevice& device, const Window& window, SceneData& sceneData, Resources::Texture2D* screenTexture) :
@@ -21,7 +23,7 @@ namespace TracerCore::UI
 
         if(ImGui::Button("Load Model..."))
         {
-            auto model = _fileDialog.OpenFile("3D Model (*.obj, *.fbx)\0*.obj;*.fbx\0");
+            auto model = _fileDialog.OpenFile("3D Model (*.obj, *.fbx, *.tmesh)\0*.obj;*.fbx;*.tmesh\0");
             if(!model.empty())
             {
                 _sceneData.ModelPath = model;
@@ -63,6 +65,43 @@ namespace TracerCore::UI
             _sceneData.IsSceneLoaded = false;
         }
 
+        if(ImGui::Checkbox("Leaf ordered triangles (BVH)", &_sceneData.ReorderLeafTriangles))
+        {
+            _sceneData.IsSceneLoaded = false;
+        }
+
+        if(ImGui::Checkbox("Compact vertex format", &_sceneData.CompactVertices))
+        {
+            _sceneData.IsSceneLoaded = false;
+        }
+
+        ImGui::Combo("Sampler", &_sceneData.Sampler, "PCG\0Sobol + blue noise\0");
+        ImGui::Checkbox("Sample sky light (NEE + MIS)", &_sceneData.NextEventEstimation);
+
+        if(ImGui::CollapsingHeader("Adaptive sampling"))
+        {
+            ImGui::Checkbox("Skip converged tiles", &_sceneData.AdaptiveSampling);
+            ImGui::DragFloat("Error threshold", &_sceneData.AdaptiveThreshold, 0.001f, 0.001f, 1.0f, "%.3f");
+            ImGui::DragInt("Min frames", &_sceneData.AdaptiveMinFrames, 1.0f, 2, 4096);
+        }
+
+        if(ImGui::CollapsingHeader("Denoiser"))
+        {
+            ImGui::Checkbox("A-trous filter", &_sceneData.Denoiser);
+            ImGui::SliderInt("Iterations", &_sceneData.DenoiseIterations, 1, static_cast<int>(DENOISE_MAX_ITERATIONS));
+        }
+
+        if(ImGui::CollapsingHeader("Reprojection"))
+        {
+            ImGui::Checkbox("Keep accumulation while moving", &_sceneData.Reprojection);
+            ImGui::DragInt("Max history", &_sceneData.ReprojectionMaxHistory, 1.0f, 1, 4096);
+        }
+
+        if(ImGui::CollapsingHeader("Accumulation"))
+        {
+            ImGui::Combo("Format", &_sceneData.AccumulationFormat, "Float32\0Half + compensation\0");
+        }
+
         if(ImGui::Button("Save Screen Shot..."))
         {
             auto piccturePath = _fileDialog.SaveFile("PNG (*.png)\0*.png\0");
@@ -77,6 +116,33 @@ namespace TracerCore::UI
             _sceneData.ResetCamera = true;
         }
 
+        if(ImGui::Button("Autotune Workgroup Size"))
+        {
+            _sceneData.RunAutotune = true;
+        }
+
+        if(ImGui::CollapsingHeader("Traversal statistics"))
+        {
+            ImGui::Combo("View", &_sceneData.DebugView, "Shaded\0Node visits\0AABB tests\0Triangle tests\0Rays\0");
+            ImGui::DragFloat("Heatmap max", &_sceneData.HeatmapMax, 1.0f, 1.0f, 65536.0f, "%.0f");
+
+            if(ImGui::Button("Capture Statistics"))
+            {
+                _sceneData.CaptureTraversalStats = true;
+            }
+
+            ImGui::SameLine();
+            if(ImGui::Button("Export Heatmap..."))
+            {
+                auto heatmapPath = _fileDialog.SaveFile("PNG heatmap (*.png)\0*.png\0Raw counts HDR (*.hdr)\0*.hdr\0");
+                if(!heatmapPath.empty())
+                {
+                    _sceneData.TraversalHeatmapPath = heatmapPath;
+                    _sceneData.CaptureTraversalStats = true;
+                }
+            }
+        }
+
         ImGui::End();
     }
 
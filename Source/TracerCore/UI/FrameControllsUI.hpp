@@ -9,6 +9,7 @@
 #include "../Window.hpp"
 #include "UILayer.hpp"
 #include "../TracerScene.hpp"
+#include "../TraversalStatistics.hpp"
 #include "WindowsFileDialog.hpp"
 #include "../Resources/Texture2D.hpp"
 
@@ -22,6 +23,32 @@ namespace TracerCore::UI
         std::string ModelPath;
         AccStructureType AccStructureType;
         AccHeruishitcType AccHeruishitcType;
+        bool ReorderLeafTriangles;
+        bool CompactVertices;
+        bool RunAutotune = false;
+        // SamplerType of the ray tracing pass
+        int Sampler = 1;
+        bool NextEventEstimation = true;
+        bool AdaptiveSampling = false;
+        // relative standard error of the tile luminance at which a tile stops tracing
+        float AdaptiveThreshold = 0.02f;
+        int AdaptiveMinFrames = 16;
+        // a-trous denoiser after the ray tracing pass, replaces adaptive sampling while enabled
+        bool Denoiser = false;
+        int DenoiseIterations = 5;
+        // keeps the accumulation while the camera moves, replaces adaptive sampling while enabled
+        bool Reprojection = false;
+        // frames a reprojected pixel keeps at most
+        int ReprojectionMaxHistory = 128;
+        // AccumulationFormat of the accumulation images
+        int AccumulationFormat = 0;
+
+        // 0 - shaded, otherwise heatmap of TraversalCounter DebugView - 1
+        int DebugView = 0;
+        float HeatmapMax = 256.0f;
+        bool CaptureTraversalStats = false;
+        // exported by the next capture when not empty
+        std::string TraversalHeatmapPath;
     };
 
     class FrameControllsUI : public RenderUILayer
@@ -2,12 +2,13 @@
 
 #include <imgui.h>
 #include <string>
+#include <cstdio>
 
 #include <glm/gtc/type_ptr.hpp>
 
 namespace TracerCore::UI
 {
-    StatisticsWindow::StatisticsWindow(FrameStatisics &stats) : _stats(stats)
+    StatisticsWindow::StatisticsWindow(FrameStatisics &stats, const GpuProfiler& profiler) : _stats(stats), _profiler(profiler)
     {
     }
 
@@ -21,11 +22,30 @@ namespace TracerCore::UI
         std::string frameTime = "Frame time: " + std::to_string(_stats.FrameTime * 1000);
         std::string fpsTime = "FPS: " + std::to_string(_stats.FPS);
         std::string triCount = "Tri count: " + std::to_string(_stats.TriCount);
+        std::string pathLength = "Average path length: " + std::to_string(_stats.AveragePathLength);
+        std::string mrays = "Mrays/s: " + std::to_string(_stats.MRaysPerSecond);
         ImGui::Text(fpsTime.c_str());
         ImGui::Text(frameTime.c_str());
         ImGui::Text(triCount.c_str());
+        ImGui::Text(pathLength.c_str());
+        ImGui::Text(mrays.c_str());
+
+        if(_profiler.IsSupported() && ImGui::CollapsingHeader("GPU timings", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(GpuPass::GpuPass_Count); i++)
+            {
+                GpuPass pass = static_cast<GpuPass>(i);
+                const GpuPassStatistics& statistics = _profiler.GetStatistics(pass);
+
+                char overlay[96];
+                snprintf(overlay, sizeof(overlay), "min %.2f avg %.2f p99 %.2f ms", statistics.MinMs, statistics.AvgMs, statistics.P99Ms);
+                ImGui::PlotLines(GpuProfiler::GetPassName(pass), statistics.History.data(), statistics.SampleCount, statistics.HistoryOffset, 
+                    overlay, 0.0f, statistics.P99Ms * 1.5f, ImVec2(0, 40));
+            }
+        }
         ImGui::ColorEdit4("Sky Color", glm::value_ptr(_stats.color));
         ImGui::SliderInt("Bounce count", &_stats.bounceCount, 2, 16);
+        ImGui::SliderInt("Roulette from bounce", &_stats.rouletteMinBounce, 0, 16);
         ImGui::End();
     }
 }
\ No newline at end of file
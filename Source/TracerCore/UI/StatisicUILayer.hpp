@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "UILayer.hpp"
+#include "../GpuProfiler.hpp"
 
 #include "glm/glm.hpp"
 
@@ -16,21 +17,25 @@ namespace TracerCore::UI
         float FrameTime;
         uint32_t FPS;
         uint32_t TriCount;
+        float AveragePathLength = 0.0f;
+        float MRaysPerSecond = 0.0f;
 
         //todo remove
         glm::vec3 color; 
         int bounceCount;
+        int rouletteMinBounce;
     };
 
     class StatisticsWindow : public RenderUILayer
     {
         public:
-            StatisticsWindow(FrameStatisics& stats);
+            StatisticsWindow(FrameStatisics& stats, const GpuProfiler& profiler);
             ~StatisticsWindow();
 
             void Render() override;
         private:
             FrameStatisics& _stats;
+            const GpuProfiler& _profiler;
             bool isOpen = true;
     };
 }
\ No newline at end of file
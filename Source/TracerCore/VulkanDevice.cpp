@@ -1,4 +1,5 @@
 #include "VulkanDevice.hpp"
+#include "Resources/UploadManager.hpp"
 
 // std headers
 #include <cstring>
@@ -8,27 +9,36 @@
 
 namespace TracerCore 
 {
-    VulkanDevice::VulkanDevice(Window &window) : 
-        window{window} 
+    VulkanDevice::VulkanDevice(Window* window) : 
+        _window{window} 
     {
         CreateInstance();
         SetupDebugMessenger();
         CreateSurface();
         PickPhysicalDevice();
         CreateLogicalDevice();
+        _memoryAllocator = std::make_unique<Resources::MemoryAllocator>(_device, _physicalDevice);
         CreateGraphicsCommandPool();
+        CreateComputeCommandPool();
+        _uploadManager = std::make_unique<Resources::UploadManager>(*this);
     }
 
     VulkanDevice::~VulkanDevice() 
     {
+        _uploadManager = nullptr;
+        vkDestroyCommandPool(_device, _computeCommandPool, nullptr);
         vkDestroyCommandPool(_device, commandPool, nullptr);
+        _memoryAllocator = nullptr;
         vkDestroyDevice(_device, nullptr);
 
         if (ENABLE_VALIDATION_LAYERS) {
             _debugLayerMessenger = nullptr;
         }
 
-        vkDestroySurfaceKHR(_instance, _surface, nullptr);
+        if(_surface != VK_NULL_HANDLE)
+        {
+            vkDestroySurfaceKHR(_instance, _surface, nullptr);
+        }
         vkDestroyInstance(_instance, nullptr);
     }
 
@@ -112,9 +122,10 @@ namespace TracerCore
     void VulkanDevice::CreateLogicalDevice() 
     {
         QueueFamilyIndices indices = FindQueueFamilies(_physicalDevice);
+        _queueFamilyIndices = indices;
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<uint32_t> uniqueQueueFamilies = {indices.GraphicsFamily, indices.PresentFamily};
+        std::set<uint32_t> uniqueQueueFamilies = {indices.GraphicsFamily, indices.PresentFamily, indices.ComputeFamily, indices.TransferFamily};
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -142,7 +153,8 @@ namespace TracerCore
         features2.pNext = &features11;
         
         features11.pNext = &features12;
-        features12.pNext = &rtPipelineFeature;
+        //ray tracing feature structs are only valid together with their extensions
+        features12.pNext = IsHeadless() ? nullptr : &rtPipelineFeature;
         rtPipelineFeature.pNext = &accelFeature;
 
         //TODO check if this is necessary. Seems to be fishy
@@ -154,9 +166,10 @@ namespace TracerCore
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+        auto deviceExtensions = GetDeviceExtensions();
         createInfo.pEnabledFeatures = nullptr;
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(DEVICE_EXTENSIONS.size());
-        createInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
         // might not really be necessary anymore because device specific validation layers
         // have been deprecated
@@ -176,6 +189,16 @@ namespace TracerCore
         vkGetDeviceQueue(_device, indices.GraphicsFamily, 0, &_graphicsQueue);
         vkGetDeviceQueue(_device, indices.PresentFamily, 0, &_presentQueue);
         vkGetDeviceQueue(_device, indices.ComputeFamily, 0, &_computeQueue);
+        vkGetDeviceQueue(_device, indices.TransferFamily, 0, &_transferQueue);
+
+        std::cout << "graphics queue family: " << indices.GraphicsFamily << " compute queue family: " << indices.ComputeFamily 
+            << (HasDedicatedComputeQueue() ? " (dedicated)" : " (shared)") << " transfer queue family: " << indices.TransferFamily << std::endl;
+    }
+
+    std::vector<uint32_t> VulkanDevice::GetResourceQueueFamilies() const
+    {
+        std::set<uint32_t> families = {_queueFamilyIndices.GraphicsFamily, _queueFamilyIndices.ComputeFamily, _queueFamilyIndices.TransferFamily};
+        return std::vector<uint32_t>(families.begin(), families.end());
     }
 
     void VulkanDevice::CreateGraphicsCommandPool() 
@@ -193,7 +216,25 @@ namespace TracerCore
         }
     }
 
-    void VulkanDevice::CreateSurface() { window.CreateWindowSurface(_instance, &_surface); }
+    void VulkanDevice::CreateComputeCommandPool() 
+    {
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = _queueFamilyIndices.ComputeFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+        if (vkCreateCommandPool(_device, &poolInfo, nullptr, &_computeCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create compute command pool!");
+        }
+    }
+
+    void VulkanDevice::CreateSurface() 
+    { 
+        if(IsHeadless())
+            return;
+
+        _window->CreateWindowSurface(_instance, &_surface); 
+    }
 
     bool VulkanDevice::IsDeviceSuitable(VkPhysicalDevice device) 
     {
@@ -201,9 +242,10 @@ namespace TracerCore
 
         bool extensionsSupported = CheckDeviceExtensionSupport(device);
 
-        bool swapChainAdequate = false;
+        //nothing is presented without a window
+        bool swapChainAdequate = IsHeadless();
         // we need to do this only if the device supports the required extensions for the swap chain
-        if (extensionsSupported) {
+        if (extensionsSupported && !IsHeadless()) {
             SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         }
@@ -211,7 +253,7 @@ namespace TracerCore
         VkPhysicalDeviceFeatures supportedFeatures;
         vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
-        return indices.IsComplete() && extensionsSupported && swapChainAdequate &&
+        return indices.IsComplete(!IsHeadless()) && extensionsSupported && swapChainAdequate &&
                 supportedFeatures.samplerAnisotropy;
     }
 
@@ -252,11 +294,15 @@ namespace TracerCore
 
     std::vector<const char *> VulkanDevice::GetRequiredExtensions() 
     {
-        uint32_t glfwExtensionCount = 0;
-        const char **glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-        std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        std::vector<const char *> extensions;
+
+        //GLFW is not initialized without a window
+        if (!IsHeadless()) {
+            uint32_t glfwExtensionCount = 0;
+            const char **glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if (ENABLE_VALIDATION_LAYERS) {
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -265,6 +311,15 @@ namespace TracerCore
         return extensions;
     }
 
+    std::vector<const char *> VulkanDevice::GetDeviceExtensions() const
+    {
+        if (IsHeadless()) {
+            return {};
+        }
+
+        return DEVICE_EXTENSIONS;
+    }
+
     void VulkanDevice::HasRequierdInstanceExtensions(const std::vector<const char *>& requiredExtensions, bool log) 
     {
         uint32_t extensionCount = 0;
@@ -308,7 +363,8 @@ namespace TracerCore
             &extensionCount,
             availableExtensions.data());
 
-        std::set<std::string> requiredExtensions(DEVICE_EXTENSIONS.begin(), DEVICE_EXTENSIONS.end());
+        auto deviceExtensions = GetDeviceExtensions();
+        std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
         for (const auto &extension : availableExtensions) {
             requiredExtensions.erase(extension.extensionName);
@@ -319,7 +375,7 @@ namespace TracerCore
 
     QueueFamilyIndices VulkanDevice::FindQueueFamilies(VkPhysicalDevice device) 
     {
-        QueueFamilyIndices indices;
+        QueueFamilyIndices indices{};
 
         uint32_t queueFamilyCount = 0;
         vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
@@ -330,34 +386,55 @@ namespace TracerCore
         int i = 0;
         for (const auto &queueFamily : queueFamilies) 
         {
-            if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) 
+            if (!indices.HasGraphicsFamily && queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) 
             {
                 indices.GraphicsFamily = i;
                 indices.HasGraphicsFamily = true;
             }
             
             VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
-            if (queueFamily.queueCount > 0 && presentSupport) 
+            if(!IsHeadless())
+            {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
+            }
+            if (!indices.HasPresentFamily && queueFamily.queueCount > 0 && presentSupport) 
             {
                 indices.PresentFamily = i;
                 indices.HasPresentFamily = true;
             }
 
-            if(queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)
+            // a compute only family runs asynchronously to the graphics queue, take it over a shared one
+            bool computeOnly = !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+            bool hasSharedCompute = indices.HasComputeFamily && (queueFamilies[indices.ComputeFamily].queueFlags & VK_QUEUE_GRAPHICS_BIT);
+            if(queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT && (!indices.HasComputeFamily || (computeOnly && hasSharedCompute)))
             {
                 indices.ComputeFamily = i;
                 indices.HasComputeFamily = true;
             }
 
-            if (indices.IsComplete()) 
+            // copy engines run uploads next to rendering, only take a family that can do nothing else
+            bool transferOnly = !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+            if(!indices.HasTransferFamily && queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT && transferOnly)
             {
-                break;
+                indices.TransferFamily = i;
+                indices.HasTransferFamily = true;
             }
 
             i++;
         }
 
+        //headless devices never present, the present queue aliases the graphics queue
+        if(!indices.HasPresentFamily && indices.HasGraphicsFamily && IsHeadless())
+        {
+            indices.PresentFamily = indices.GraphicsFamily;
+        }
+
+        if(!indices.HasTransferFamily && indices.HasGraphicsFamily)
+        {
+            indices.TransferFamily = indices.GraphicsFamily;
+            indices.HasTransferFamily = true;
+        }
+
         return indices;
     }
 
@@ -2,6 +2,7 @@
 
 #include "Window.hpp"
 #include "Utils/DebugLayerMessenger.hpp"
+#include "Resources/MemoryAllocator.hpp"
 
 // std lib headers
 #include <string>
@@ -10,6 +11,11 @@
 
 namespace TracerCore {
 
+    namespace Resources
+    {
+        class UploadManager;
+    }
+
     /// @brief Contains the details of the swap chain.
     struct SwapChainSupportDetails {
         VkSurfaceCapabilitiesKHR capabilities;
@@ -23,20 +29,24 @@ namespace TracerCore {
         uint32_t GraphicsFamily;
         uint32_t PresentFamily;
         uint32_t ComputeFamily;
+        uint32_t TransferFamily;
 
         bool HasGraphicsFamily;
         bool HasPresentFamily;
         bool HasComputeFamily;
+        bool HasTransferFamily;
 
         /// @brief Returns true if the required queue families are supported.
         /// @return True if the required queue families are supported.
-        inline bool IsComplete() { return HasGraphicsFamily && HasPresentFamily && HasComputeFamily; }
+        inline bool IsComplete(bool needsPresent = true) { return HasGraphicsFamily && (HasPresentFamily || !needsPresent) && HasComputeFamily; }
 
     };
 
     class VulkanDevice {
         public:
-        VulkanDevice(Window &window);
+        /// @param window nullptr creates a headless device without surface and swap chain support,
+        /// for offscreen rendering and software implementations like lavapipe.
+        VulkanDevice(Window* window);
         ~VulkanDevice();
 
         // Not copyable or movable
@@ -54,7 +64,10 @@ namespace TracerCore {
         /// @brief Getter for Vulkan physical device.
         inline VkPhysicalDevice GetPhysicalDevice() const { return _physicalDevice; }
 
-        /// @brief Returns window surface for rendering.
+        /// @brief Returns true if the device was created without a window, there is no surface and no present queue.
+        inline bool IsHeadless() const { return _window == nullptr; }
+
+        /// @brief Returns window surface for rendering. VK_NULL_HANDLE for headless devices.
         inline VkSurfaceKHR GetSurface() const { return _surface; }
 
         /// @brief Retruns pointer to Graphics Queue.
@@ -63,12 +76,33 @@ namespace TracerCore {
         /// @brief Returns pointer to Present Queue.
         inline VkQueue GetPresentQueue() const { return _presentQueue; }
 
+        /// @brief Returns pointer to Compute Queue. Same queue as graphics when the device has no separate compute family.
+        inline VkQueue GetComputeQueue() const { return _computeQueue; }
+
+        /// @brief Returns true if compute work can be submitted to a queue family other than graphics.
+        inline bool HasDedicatedComputeQueue() const { return _queueFamilyIndices.ComputeFamily != _queueFamilyIndices.GraphicsFamily; }
+
+        /// @brief Returns pointer to Transfer Queue. Same queue as graphics when the device has no separate transfer family.
+        inline VkQueue GetTransferQueue() const { return _transferQueue; }
+
+        inline const QueueFamilyIndices& GetQueueFamilyIndices() const { return _queueFamilyIndices; }
+
+        /// @brief Returns the distinct queue families that access scene resources.
+        std::vector<uint32_t> GetResourceQueueFamilies() const;
+
         /// @brief Get the swap chain support details for the currently selected physical device. Must be called after the physical device is selected.
         /// @return SwapChainSupportDetails struct with the swap chain support details.
         inline SwapChainSupportDetails GetSwapChainSupport() { return QuerySwapChainSupport(_physicalDevice); }
 
         VkCommandPool getCommandPool() const { return commandPool; }
 
+        /// @brief Pooled allocator all buffers and textures take their memory from.
+        inline Resources::MemoryAllocator& GetMemoryAllocator() const { return *_memoryAllocator; }
+
+        /// @brief Staged uploader for device local buffers.
+        inline Resources::UploadManager& GetUploadManager() const { return *_uploadManager; }
+        VkCommandPool GetComputeCommandPool() const { return _computeCommandPool; }
+
         uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
         /// @brief Find the queue families supported by currently selected physical device. Must be called after the physical device is selected.
@@ -120,16 +154,22 @@ namespace TracerCore {
         /// @brief Creates a command pool on grahpics family queue to allocate command buffers from. 
         void CreateGraphicsCommandPool();
 
+        /// @brief Creates a command pool on compute family queue to allocate command buffers from. 
+        void CreateComputeCommandPool();
+
         /// @brief Check if the physical graphics card supports the required features.
         bool IsDeviceSuitable(VkPhysicalDevice device);
 
-        /// @brief Returns the queue families supported by the physical device.
+        /// @brief Returns the queue families supported by the physical device. Prefers a compute family without graphics support.
         /// @param device Graphics card to check for queue families.
         /// @return QueueFamilyIndices struct with the supported queue families.
         QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
 
         /// @brief Get the required extensions for the Vulkan Instance.
         std::vector<const char *> GetRequiredExtensions();
+
+        /// @brief Returns DEVICE_EXTENSIONS, headless devices need none of them.
+        std::vector<const char *> GetDeviceExtensions() const;
         
         /// @brief Check whether the required validation layers are supported by the Vulkan Instance driver.
         /// @return True if the required validation layers are supported.
@@ -140,7 +180,7 @@ namespace TracerCore {
         /// @param log Weather to log the availabe and reqierd extensions.
         void HasRequierdInstanceExtensions(const std::vector<const char *>& requiredExtensions, bool log);
 
-        /// @brief Check if the physical device supports the required extensions(DEVICE_EXTENSIONS).
+        /// @brief Check if the physical device supports the required extensions(GetDeviceExtensions).
         /// @param device Target physical device
         /// @return Returns true if the required extensions are supported.
         bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
@@ -158,14 +198,20 @@ namespace TracerCore {
         VkQueue _graphicsQueue;
         VkQueue _presentQueue;
         VkQueue _computeQueue;
+        VkQueue _transferQueue;
+
+        QueueFamilyIndices _queueFamilyIndices;
 
-        Window &window;
+        Window* _window = nullptr;
         VkCommandPool commandPool;
+        VkCommandPool _computeCommandPool;
 
         
-        VkSurfaceKHR _surface;
+        VkSurfaceKHR _surface = VK_NULL_HANDLE;
         
 
         std::unique_ptr<Utils::DebugLayerMessenger> _debugLayerMessenger;
+        std::unique_ptr<Resources::MemoryAllocator> _memoryAllocator;
+        std::unique_ptr<Resources::UploadManager> _uploadManager;
     };
 }
\ No newline at end of file
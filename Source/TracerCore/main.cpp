@@ -2,17 +2,201 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <string>
 
 #include "Tracer.hpp"
 #include "TracerIO.hpp"
 
-int main() {
+// Tracer [--headless] [--model <path>] [--acc bvh|bvh-primitive|kd|kd-primitive|none] [--size <width> <height>] [--frames <count>] [--output <file.png>]
+// Tracer --batch <jobs file> [--report <file.json>]
+// --adaptive <threshold> stops tracing tiles of headless renders once their relative error is below the threshold
+// Tracer --sampler-study [--model <path>] [--acc <type>] [--size <width> <height>] [--frames <budget>] [--report <file.json>]
+// --roulette <bounce> starts russian roulette after the bounce, 0 disables it
+// --no-nee disables sky light sampling
+// --denoise filters the frames with the a-trous denoiser
+// Tracer --denoise-check [--model <path>] [--size <width> <height>] [--frames <count>] [--output <file.png>]
+// --reproject keeps the accumulation while the camera moves, --orbit <degrees> moves the camera of headless renders every frame
+// Tracer --reprojection-check [--model <path>] [--size <width> <height>] [--frames <count>] [--orbit <degrees>] [--output <file.png>]
+// --accumulation float|half accumulates in rgba32f sums or in an rgba16f mean with an rgba8 compensation
+// Tracer --accumulation-check [--model <path>] [--size <width> <height>] [--frames <count>] [--output <file.png>]
+// Tracer --light-study [--size <width> <height>] [--frames <budget>] [--report <file.json>]
+// Tracer --roulette-study [--model <path>] [--acc <type>] [--size <width> <height>] [--frames <budget>] [--report <file.json>]
+// Tracer --benchmark [--size <width> <height>] [--label <text>] [--report <file.json>]
+static bool ParseSettings(int argc, char** argv, TracerCore::TracerSettings& settings)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if(argument == "--headless")
+        {
+            settings.Headless = true;
+        }
+        else if(argument == "--model" && hasValue)
+        {
+            settings.ModelPath = argv[++i];
+        }
+        else if(argument == "--acc" && hasValue)
+        {
+            if(!TracerCore::ParseAccStructureName(argv[++i], settings.AccStructureType, settings.AccHeruishitcType))
+            {
+                std::cerr << "Unknown acceleration structure " << argv[i] << '\n';
+                return false;
+            }
+        }
+        else if(argument == "--size" && i + 2 < argc)
+        {
+            settings.Width = std::stoul(argv[++i]);
+            settings.Height = std::stoul(argv[++i]);
+            if(settings.Width == 0 || settings.Height == 0)
+            {
+                std::cerr << "Size must be at least 1x1\n";
+                return false;
+            }
+        }
+        else if(argument == "--frames" && hasValue)
+        {
+            //studies divide by the frame count and average over it
+            settings.FrameCount = std::stoul(argv[++i]);
+            if(settings.FrameCount == 0)
+            {
+                std::cerr << "Frame count must be at least 1\n";
+                return false;
+            }
+        }
+        else if(argument == "--adaptive" && hasValue)
+        {
+            settings.AdaptiveThreshold = std::stof(argv[++i]);
+        }
+        else if(argument == "--output" && hasValue)
+        {
+            settings.OutputPath = argv[++i];
+        }
+        else if(argument == "--batch" && hasValue)
+        {
+            //batch jobs are always rendered offscreen
+            settings.BatchFile = argv[++i];
+            settings.Headless = true;
+        }
+        else if(argument == "--benchmark")
+        {
+            settings.Benchmark = true;
+            settings.Headless = true;
+        }
+        else if(argument == "--sampler-study")
+        {
+            settings.SamplerStudy = true;
+            settings.Headless = true;
+        }
+        else if(argument == "--light-study")
+        {
+            settings.LightStudy = true;
+            settings.Headless = true;
+        }
+        else if(argument == "--no-nee")
+        {
+            settings.NextEventEstimation = false;
+        }
+        else if(argument == "--denoise")
+        {
+            settings.Denoiser = true;
+        }
+        else if(argument == "--denoise-check")
+        {
+            settings.DenoiseCheck = true;
+            settings.Headless = true;
+        }
+        else if(argument == "--reproject")
+        {
+            settings.Reprojection = true;
+        }
+        else if(argument == "--orbit" && hasValue)
+        {
+            settings.OrbitDegrees = std::stof(argv[++i]);
+        }
+        else if(argument == "--reprojection-check")
+        {
+            settings.ReprojectionCheck = true;
+            settings.Headless = true;
+        }
+        else if(argument == "--accumulation" && hasValue)
+        {
+            if(!TracerCore::ParseAccumulationFormatName(argv[++i], settings.Accumulation))
+            {
+                std::cerr << "Unknown accumulation format " << argv[i] << '\n';
+                return false;
+            }
+        }
+        else if(argument == "--accumulation-check")
+        {
+            settings.AccumulationCheck = true;
+            settings.Headless = true;
+        }
+        else if(argument == "--roulette-study")
+        {
+            settings.RouletteStudy = true;
+            settings.Headless = true;
+        }
+        else if(argument == "--roulette" && hasValue)
+        {
+            settings.RouletteMinBounce = std::stoul(argv[++i]);
+        }
+        else if(argument == "--label" && hasValue)
+        {
+            settings.BenchmarkLabel = argv[++i];
+        }
+        else if(argument == "--report" && hasValue)
+        {
+            settings.ReportPath = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Unknown argument " << argument << '\n';
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
     TracerUtils::IOHelpers::SetAssetFolder("..\\Assets");
 
-    TracerCore::Tracer engine{}; 
-    
+    // Tracer --convert <model> <output.tmesh>
+    if(argc == 4 && std::string(argv[1]) == "--convert")
+    {
+        try
+        {
+            TracerUtils::IOHelpers::ConvertModel(argv[2], argv[3]);
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    TracerCore::TracerSettings settings;
     try
     {
+        if(!ParseSettings(argc, argv, settings))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Invalid argument: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        //the constructor loads shaders and the scene, their errors are reported like the ones of Run
+        TracerCore::Tracer engine{settings};
         engine.Run();
     }
     catch(const std::exception& e)
@@ -20,6 +204,6 @@ int main() {
         std::cerr << e.what() << '\n';
         return EXIT_FAILURE;
     }
-    
+
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
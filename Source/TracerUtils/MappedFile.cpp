@@ -0,0 +1,96 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace TracerUtils
+{
+    MappedFile::~MappedFile()
+    {
+#ifdef _WIN32
+        if(_data != nullptr)
+            UnmapViewOfFile(_data);
+        if(_mappingHandle != nullptr)
+            CloseHandle(_mappingHandle);
+        if(_fileHandle != nullptr && _fileHandle != INVALID_HANDLE_VALUE)
+            CloseHandle(_fileHandle);
+#else
+        if(_data != nullptr)
+            munmap(const_cast<uint8_t*>(_data), _size);
+        if(_fileDescriptor >= 0)
+            close(_fileDescriptor);
+#endif
+    }
+
+    std::unique_ptr<MappedFile> MappedFile::Open(const std::string& filePath)
+    {
+        auto file = std::unique_ptr<MappedFile>(new MappedFile());
+
+#ifdef _WIN32
+        file->_fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(file->_fileHandle == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("failed to open file for mapping: " + filePath);
+        }
+
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(file->_fileHandle, &fileSize))
+        {
+            throw std::runtime_error("failed to query file size: " + filePath);
+        }
+
+        file->_size = static_cast<size_t>(fileSize.QuadPart);
+        if(file->_size == 0)
+            return file;
+
+        file->_mappingHandle = CreateFileMappingA(file->_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(file->_mappingHandle == nullptr)
+        {
+            throw std::runtime_error("failed to create file mapping: " + filePath);
+        }
+
+        file->_data = static_cast<const uint8_t*>(MapViewOfFile(file->_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if(file->_data == nullptr)
+        {
+            throw std::runtime_error("failed to map file: " + filePath);
+        }
+#else
+        file->_fileDescriptor = open(filePath.c_str(), O_RDONLY);
+        if(file->_fileDescriptor < 0)
+        {
+            throw std::runtime_error("failed to open file for mapping: " + filePath);
+        }
+
+        struct stat fileStat;
+        if(fstat(file->_fileDescriptor, &fileStat) != 0)
+        {
+            throw std::runtime_error("failed to query file size: " + filePath);
+        }
+
+        file->_size = static_cast<size_t>(fileStat.st_size);
+        if(file->_size == 0)
+            return file;
+
+        void* data = mmap(nullptr, file->_size, PROT_READ, MAP_PRIVATE, file->_fileDescriptor, 0);
+        if(data == MAP_FAILED)
+        {
+            throw std::runtime_error("failed to map file: " + filePath);
+        }
+
+        madvise(data, file->_size, MADV_SEQUENTIAL);
+        file->_data = static_cast<const uint8_t*>(data);
+#endif
+
+        return file;
+    }
+}
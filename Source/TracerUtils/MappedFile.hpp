@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace TracerUtils
+{
+    /// @brief Read only memory mapping of a whole file. The view stays valid for the lifetime of the object.
+    class MappedFile
+    {
+    public:
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile &operator=(const MappedFile&) = delete;
+
+        static std::unique_ptr<MappedFile> Open(const std::string& filePath);
+
+        inline const uint8_t* GetData() const { return _data; }
+        inline size_t GetSize() const { return _size; }
+
+    private:
+        MappedFile() = default;
+
+        const uint8_t* _data = nullptr;
+        size_t _size = 0;
+
+#ifdef _WIN32
+        void* _fileHandle = nullptr;
+        void* _mappingHandle = nullptr;
+#else
+        int _fileDescriptor = -1;
+#endif
+    };
+}
@@ -0,0 +1,261 @@
+#include "LowDiscrepancy.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace TracerUtils::Math
+{
+    //blue noise seed shared by the uploaded tables and the CPU reference
+    static constexpr uint32_t BLUE_NOISE_SEED = 0x8f1bbcdc;
+
+    static uint32_t ReverseBits(uint32_t x)
+    {
+        x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+        x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+        x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+        x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+        return (x >> 16) | (x << 16);
+    }
+
+    std::array<uint32_t, LowDiscrepancy::SOBOL_DIMENSIONS * LowDiscrepancy::SOBOL_BITS> LowDiscrepancy::BuildSobolDirections()
+    {
+        std::array<uint32_t, SOBOL_DIMENSIONS * SOBOL_BITS> directions{};
+
+        //dimension 0 is the van der Corput sequence
+        for (uint32_t bit = 0; bit < SOBOL_BITS; bit++)
+        {
+            directions[bit] = 1u << (SOBOL_BITS - 1 - bit);
+        }
+
+        //dimension 1, primitive polynomial x + 1 (degree 1, a = 0, m = {1})
+        uint32_t* v = directions.data() + SOBOL_BITS;
+        v[0] = 1u << (SOBOL_BITS - 1);
+        for (uint32_t bit = 1; bit < SOBOL_BITS; bit++)
+        {
+            v[bit] = v[bit - 1] ^ (v[bit - 1] >> 1);
+        }
+
+        return directions;
+    }
+
+    static std::vector<uint16_t> BuildBlueNoiseChannel(uint32_t seed)
+    {
+        const int size = static_cast<int>(LowDiscrepancy::BLUE_NOISE_SIZE);
+        const int count = size * size;
+        const int radius = 6;
+        const int kernelSize = 2 * radius + 1;
+        const float sigma = 1.5f;
+
+        std::vector<float> kernel(kernelSize * kernelSize);
+        for (int dy = -radius; dy <= radius; dy++)
+        {
+            for (int dx = -radius; dx <= radius; dx++)
+            {
+                kernel[(dy + radius) * kernelSize + dx + radius] = std::exp(-(dx * dx + dy * dy) / (2.0f * sigma * sigma));
+            }
+        }
+
+        std::vector<uint8_t> pattern(count, 0);
+        std::vector<float> energy(count, 0.0f);
+
+        //gaussian energy of the points on the torus, so the texture tiles
+        auto splat = [&](int index, float sign)
+        {
+            int x = index % size;
+            int y = index / size;
+            for (int dy = -radius; dy <= radius; dy++)
+            {
+                for (int dx = -radius; dx <= radius; dx++)
+                {
+                    int texel = ((y + dy) & (size - 1)) * size + ((x + dx) & (size - 1));
+                    energy[texel] += sign * kernel[(dy + radius) * kernelSize + dx + radius];
+                }
+            }
+        };
+
+        auto tightestCluster = [&]()
+        {
+            int best = -1;
+            for (int i = 0; i < count; i++)
+            {
+                if(pattern[i] && (best < 0 || energy[i] > energy[best]))
+                    best = i;
+            }
+            return best;
+        };
+
+        auto largestVoid = [&]()
+        {
+            int best = -1;
+            for (int i = 0; i < count; i++)
+            {
+                if(!pattern[i] && (best < 0 || energy[i] < energy[best]))
+                    best = i;
+            }
+            return best;
+        };
+
+        //random initial points, then moved from clusters into voids until the pattern is stable
+        std::mt19937 random(seed);
+        const int initialCount = count / 10;
+        for (int placed = 0; placed < initialCount;)
+        {
+            int index = static_cast<int>(random() % count);
+            if(pattern[index])
+                continue;
+
+            pattern[index] = 1;
+            splat(index, 1.0f);
+            placed++;
+        }
+
+        for (int iteration = 0; iteration < count; iteration++)
+        {
+            int cluster = tightestCluster();
+            pattern[cluster] = 0;
+            splat(cluster, -1.0f);
+
+            int emptiest = largestVoid();
+            pattern[emptiest] = 1;
+            splat(emptiest, 1.0f);
+            if(emptiest == cluster)
+                break;
+        }
+
+        std::vector<uint32_t> ranks(count);
+        std::vector<uint8_t> initialPattern = pattern;
+        std::vector<float> initialEnergy = energy;
+
+        //ranks below the initial points remove the tightest clusters first
+        for (int rank = initialCount - 1; rank >= 0; rank--)
+        {
+            int cluster = tightestCluster();
+            pattern[cluster] = 0;
+            splat(cluster, -1.0f);
+            ranks[cluster] = rank;
+        }
+
+        //the remaining ranks fill the largest voids
+        pattern = initialPattern;
+        energy = initialEnergy;
+        for (int rank = initialCount; rank < count; rank++)
+        {
+            int emptiest = largestVoid();
+            pattern[emptiest] = 1;
+            splat(emptiest, 1.0f);
+            ranks[emptiest] = rank;
+        }
+
+        std::vector<uint16_t> channel(count);
+        for (int i = 0; i < count; i++)
+        {
+            channel[i] = static_cast<uint16_t>((static_cast<uint64_t>(ranks[i]) * 65536) / count);
+        }
+        return channel;
+    }
+
+    std::vector<uint32_t> LowDiscrepancy::BuildBlueNoise(uint32_t seed)
+    {
+        std::vector<uint16_t> red = BuildBlueNoiseChannel(seed);
+        std::vector<uint16_t> green = BuildBlueNoiseChannel(Pcg(seed));
+
+        std::vector<uint32_t> texels(red.size());
+        for (size_t i = 0; i < texels.size(); i++)
+        {
+            texels[i] = red[i] | (static_cast<uint32_t>(green[i]) << 16);
+        }
+        return texels;
+    }
+
+    std::vector<uint32_t> LowDiscrepancy::BuildSamplerTables()
+    {
+        auto directions = BuildSobolDirections();
+        auto blueNoise = BuildBlueNoise(BLUE_NOISE_SEED);
+
+        std::vector<uint32_t> tables(directions.begin(), directions.end());
+        tables.insert(tables.end(), blueNoise.begin(), blueNoise.end());
+        return tables;
+    }
+
+    uint32_t LowDiscrepancy::Pcg(uint32_t value)
+    {
+        uint32_t state = value * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28) + 4)) ^ state) * 277803737u;
+        return (word >> 22) ^ word;
+    }
+
+    uint32_t LowDiscrepancy::HashCombine(uint32_t seed, uint32_t value)
+    {
+        return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+    }
+
+    uint32_t LowDiscrepancy::NestedUniformScramble(uint32_t x, uint32_t seed)
+    {
+        x = ReverseBits(x);
+        x += seed;
+        x ^= x * 0x6c50b47cu;
+        x ^= x * 0xb82f1e52u;
+        x ^= x * 0xc7afe638u;
+        x ^= x * 0x8d22f6e6u;
+        return ReverseBits(x);
+    }
+
+    void PcgSampler::Init(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t seed)
+    {
+        _state = LowDiscrepancy::Pcg(LowDiscrepancy::HashCombine(LowDiscrepancy::HashCombine(pixel.x, pixel.y), LowDiscrepancy::HashCombine(sampleIndex, seed)));
+    }
+
+    glm::vec2 PcgSampler::Sample2D()
+    {
+        glm::vec2 sample;
+        _state = LowDiscrepancy::Pcg(_state);
+        sample.x = (_state >> 8) * (1.0f / 16777216.0f);
+        _state = LowDiscrepancy::Pcg(_state);
+        sample.y = (_state >> 8) * (1.0f / 16777216.0f);
+        return sample;
+    }
+
+    SobolSampler::SobolSampler() :
+        _directions(LowDiscrepancy::BuildSobolDirections()),
+        _blueNoise(LowDiscrepancy::BuildBlueNoise(BLUE_NOISE_SEED))
+    {
+    }
+
+    void SobolSampler::Init(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t seed)
+    {
+        _pixel = pixel;
+        _sampleIndex = sampleIndex;
+        _seed = seed;
+        _dimension = 0;
+    }
+
+    glm::vec2 SobolSampler::Sample2D()
+    {
+        uint32_t dimensionSeed = LowDiscrepancy::Pcg(LowDiscrepancy::HashCombine(_seed, _dimension));
+        uint32_t index = LowDiscrepancy::NestedUniformScramble(_sampleIndex, dimensionSeed);
+
+        glm::uvec2 sobol{0u};
+        for (uint32_t bit = 0; index != 0; bit++, index >>= 1)
+        {
+            if(index & 1u)
+            {
+                sobol.x ^= _directions[bit];
+                sobol.y ^= _directions[LowDiscrepancy::SOBOL_BITS + bit];
+            }
+        }
+        sobol.x = LowDiscrepancy::NestedUniformScramble(sobol.x, LowDiscrepancy::Pcg(dimensionSeed ^ 0x5bd1e995u));
+        sobol.y = LowDiscrepancy::NestedUniformScramble(sobol.y, LowDiscrepancy::Pcg(dimensionSeed + 0x68e31da4u));
+        glm::vec2 u = glm::vec2(sobol >> 8u) * (1.0f / 16777216.0f);
+
+        float pair = static_cast<float>(_dimension / 2);
+        glm::ivec2 noiseOffset = glm::ivec2(glm::fract(glm::vec2(0.7548776662f, 0.5698402910f) * pair) * static_cast<float>(LowDiscrepancy::BLUE_NOISE_SIZE));
+        uint32_t seedHash = LowDiscrepancy::Pcg(_seed);
+        noiseOffset += glm::ivec2(static_cast<int32_t>(seedHash), static_cast<int32_t>(seedHash >> 16));
+        glm::ivec2 texel = (_pixel + noiseOffset) & glm::ivec2(LowDiscrepancy::BLUE_NOISE_SIZE - 1);
+        uint32_t noise = _blueNoise[texel.y * LowDiscrepancy::BLUE_NOISE_SIZE + texel.x];
+        glm::vec2 rotation = glm::vec2(noise & 0xffffu, noise >> 16) * (1.0f / 65536.0f);
+
+        _dimension += 2;
+        return glm::fract(u + rotation);
+    }
+}
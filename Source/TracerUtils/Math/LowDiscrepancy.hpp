@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace TracerUtils::Math
+{
+    /// @brief Sampler tables and a CPU reference of the samplers in Sampler.glsl.
+    class LowDiscrepancy
+    {
+    public:
+        // must match Sampler.glsl
+        static constexpr uint32_t SOBOL_DIMENSIONS = 2;
+        static constexpr uint32_t SOBOL_BITS = 32;
+        static constexpr uint32_t BLUE_NOISE_SIZE = 64;
+
+        /// @brief Sobol direction numbers of the first SOBOL_DIMENSIONS dimensions (Joe and Kuo), SOBOL_BITS per dimension.
+        static std::array<uint32_t, SOBOL_DIMENSIONS * SOBOL_BITS> BuildSobolDirections();
+
+        /// @brief Tileable BLUE_NOISE_SIZE^2 blue noise from the void and cluster method, two independent 16 bit channels packed per texel.
+        static std::vector<uint32_t> BuildBlueNoise(uint32_t seed);
+
+        /// @brief Contents of the SamplerTables buffer of Sampler.glsl: Sobol directions followed by the blue noise texels.
+        static std::vector<uint32_t> BuildSamplerTables();
+
+        static uint32_t Pcg(uint32_t value);
+        static uint32_t HashCombine(uint32_t seed, uint32_t value);
+        static uint32_t NestedUniformScramble(uint32_t x, uint32_t seed);
+
+        LowDiscrepancy() = delete;
+    };
+
+    /// @brief PCG white noise sampler, the sampler of the ray tracing pass before Sobol sampling.
+    class PcgSampler
+    {
+    public:
+        void Init(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t seed);
+        glm::vec2 Sample2D();
+
+    private:
+        uint32_t _state = 0;
+    };
+
+    /// @brief Owen scrambled Sobol sampler with blue noise rotation, same sequence as Sample2D in Sampler.glsl.
+    class SobolSampler
+    {
+    public:
+        SobolSampler();
+
+        void Init(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t seed);
+        glm::vec2 Sample2D();
+
+    private:
+        std::array<uint32_t, LowDiscrepancy::SOBOL_DIMENSIONS * LowDiscrepancy::SOBOL_BITS> _directions;
+        std::vector<uint32_t> _blueNoise;
+
+        glm::ivec2 _pixel{0};
+        uint32_t _sampleIndex = 0;
+        uint32_t _seed = 0;
+        uint32_t _dimension = 0;
+    };
+}
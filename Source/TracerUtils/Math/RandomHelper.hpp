@@ -16,11 +16,17 @@ namespace TracerUtils::Math
                 return min + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (max - min)));
             }
 
+            /// @brief Replaces the time based seed, the following values repeat for the same seed.
+            static void SetSeed(unsigned int seed) {
+                srand(seed);
+                _seeded = true;
+            }
+
         private:
             TracerRandom() = delete;
 
             static bool _seeded;
     };
 
-    bool TracerRandom::_seeded = false;
+    inline bool TracerRandom::_seeded = false;
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+namespace TracerUtils::Math
+{
+    /// @brief CPU ray with the same tests as Common.glsl.
+    struct Ray
+    {
+        glm::vec3 Origin;
+        glm::vec3 Direction;
+        glm::vec3 InvDirection;
+
+        Ray(const glm::vec3& origin, const glm::vec3& direction) : Origin(origin), Direction(direction), InvDirection(1.0f / direction) {}
+    };
+
+    /// @brief Same as hitAABB in Common.glsl.
+    inline bool IntersectAabb(const Ray& ray, const glm::vec3& aabbMin, const glm::vec3& aabbMax, float& tStart, float& tEnd)
+    {
+        glm::vec3 t0 = (aabbMin - ray.Origin) * ray.InvDirection;
+        glm::vec3 t1 = (aabbMax - ray.Origin) * ray.InvDirection;
+        glm::vec3 tMinv = glm::min(t0, t1);
+        glm::vec3 tMaxv = glm::max(t0, t1);
+
+        tStart = std::max(tMinv.x, std::max(tMinv.y, tMinv.z));
+        tEnd = std::min(tMaxv.x, std::min(tMaxv.y, tMaxv.z));
+        return tEnd >= tStart && tEnd > 0.0f;
+    }
+
+    /// @brief Same as occludedTriangle in Common.glsl: true if the triangle is hit in [tMin, tMax].
+    inline bool OccludedByTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float tMin, float tMax)
+    {
+        glm::vec3 v0v1 = v1 - v0;
+        glm::vec3 v0v2 = v2 - v0;
+        glm::vec3 pVec = glm::cross(ray.Direction, v0v2);
+        float det = glm::dot(v0v1, pVec);
+        if(std::abs(det) < 0.0001f)
+            return false;
+
+        float invDet = 1.0f / det;
+        glm::vec3 tVec = ray.Origin - v0;
+        float u = glm::dot(tVec, pVec) * invDet;
+        glm::vec3 qVec = glm::cross(tVec, v0v1);
+        float v = glm::dot(ray.Direction, qVec) * invDet;
+        if(u < 0.0f || v < 0.0f || (u + v) > 1.0f)
+            return false;
+
+        float t = glm::dot(v0v2, qVec) * invDet;
+        return t >= tMin && t <= tMax;
+    }
+}
@@ -0,0 +1,260 @@
+#include "MeshOptimizer.hpp"
+#include "WorkerPool.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace TracerUtils
+{
+    namespace
+    {
+        struct VertexKey
+        {
+            int32_t Values[8];
+
+            bool operator==(const VertexKey& other) const
+            {
+                return memcmp(Values, other.Values, sizeof(Values)) == 0;
+            }
+        };
+
+        struct VertexKeyHasher
+        {
+            size_t operator()(const VertexKey& key) const
+            {
+                size_t hash = 14695981039346656037ull;
+                for (int32_t value : key.Values)
+                {
+                    hash ^= std::hash<int32_t>{}(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+                }
+                return hash;
+            }
+        };
+
+        struct CellKey
+        {
+            int64_t X;
+            int64_t Y;
+            int64_t Z;
+
+            bool operator==(const CellKey& other) const
+            {
+                return X == other.X && Y == other.Y && Z == other.Z;
+            }
+        };
+
+        struct CellKeyHasher
+        {
+            size_t operator()(const CellKey& key) const
+            {
+                return std::hash<int64_t>{}(key.X * 73856093ll ^ key.Y * 19349663ll ^ key.Z * 83492791ll);
+            }
+        };
+
+        int32_t GetComponentBits(float value)
+        {
+            int32_t bits;
+            // treat -0.0f and 0.0f as the same value
+            value = value == 0.0f ? 0.0f : value;
+            memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        VertexKey MakeKey(const Models::TracerVertex& vertex)
+        {
+            VertexKey key;
+            key.Values[0] = GetComponentBits(vertex.Position.x);
+            key.Values[1] = GetComponentBits(vertex.Position.y);
+            key.Values[2] = GetComponentBits(vertex.Position.z);
+            key.Values[3] = GetComponentBits(vertex.Normal.x);
+            key.Values[4] = GetComponentBits(vertex.Normal.y);
+            key.Values[5] = GetComponentBits(vertex.Normal.z);
+            key.Values[6] = GetComponentBits(vertex.TextureCoordinate.x);
+            key.Values[7] = GetComponentBits(vertex.TextureCoordinate.y);
+            return key;
+        }
+
+        CellKey MakeCellKey(const glm::vec3& position, float invCellSize)
+        {
+            glm::vec3 cell = glm::floor(position * invCellSize);
+            return {static_cast<int64_t>(cell.x), static_cast<int64_t>(cell.y), static_cast<int64_t>(cell.z)};
+        }
+
+        bool IsWeldable(const Models::TracerVertex& a, const Models::TracerVertex& b, float positionEpsilon, float attributeEpsilon)
+        {
+            glm::vec3 positionOffset = a.Position - b.Position;
+            glm::vec3 normalOffset = glm::abs(a.Normal - b.Normal);
+            glm::vec2 uvOffset = glm::abs(a.TextureCoordinate - b.TextureCoordinate);
+            return glm::dot(positionOffset, positionOffset) <= positionEpsilon * positionEpsilon &&
+                normalOffset.x <= attributeEpsilon && normalOffset.y <= attributeEpsilon && normalOffset.z <= attributeEpsilon &&
+                uvOffset.x <= attributeEpsilon && uvOffset.y <= attributeEpsilon;
+        }
+    }
+
+    MeshOptimizationStats MeshOptimizer::Optimize(Models::TracerMesh& mesh, const MeshOptimizationSettings& settings)
+    {
+        MeshOptimizationStats stats;
+        for (const auto& part : mesh.Parts)
+        {
+            stats.VerticesBefore += part.Vertices.size();
+            stats.IndicesBefore += part.Indices.size();
+        }
+
+        //parts are independent, they are optimized in parallel
+        WorkerPool::GetShared().ParallelFor(mesh.Parts.size(), [&](size_t i) { Optimize(mesh.Parts[i], settings); });
+
+        for (const auto& part : mesh.Parts)
+        {
+            stats.VerticesAfter += part.Vertices.size();
+            stats.IndicesAfter += part.Indices.size();
+        }
+
+        return stats;
+    }
+
+    void MeshOptimizer::Optimize(Models::TracerMeshPart& part, const MeshOptimizationSettings& settings)
+    {
+        if(settings.WeldVertices)
+        {
+            WeldVertices(part, settings.WeldPositionEpsilon, settings.WeldAttributeEpsilon);
+        }
+
+        if(settings.RemoveDegenerateTriangles)
+        {
+            RemoveDegenerateTriangles(part);
+        }
+
+        if(settings.OptimizeVertexFetch)
+        {
+            OptimizeVertexFetch(part);
+        }
+    }
+
+    void MeshOptimizer::WeldVertices(Models::TracerMeshPart& part, float positionEpsilon, float attributeEpsilon)
+    {
+        std::vector<uint32_t> remap(part.Vertices.size());
+        std::vector<Models::TracerVertex> weldedVertices;
+        weldedVertices.reserve(part.Vertices.size());
+
+        if(positionEpsilon <= 0.0f)
+        {
+            std::unordered_map<VertexKey, uint32_t, VertexKeyHasher> uniqueVertices;
+            uniqueVertices.reserve(part.Vertices.size());
+
+            for (size_t i = 0; i < part.Vertices.size(); i++)
+            {
+                auto result = uniqueVertices.try_emplace(MakeKey(part.Vertices[i]), static_cast<uint32_t>(weldedVertices.size()));
+                if(result.second)
+                {
+                    weldedVertices.push_back(part.Vertices[i]);
+                }
+
+                remap[i] = result.first->second;
+            }
+        }
+        else
+        {
+            // cells are positionEpsilon wide, so every position within it lies in the cell of the vertex or one of its 26 neighbours
+            const float invCellSize = 1.0f / positionEpsilon;
+            std::unordered_map<CellKey, std::vector<uint32_t>, CellKeyHasher> cells;
+            cells.reserve(part.Vertices.size());
+
+            for (size_t i = 0; i < part.Vertices.size(); i++)
+            {
+                const Models::TracerVertex& vertex = part.Vertices[i];
+                CellKey cell = MakeCellKey(vertex.Position, invCellSize);
+
+                uint32_t weldedIndex = std::numeric_limits<uint32_t>::max();
+                for (int64_t z = -1; z <= 1 && weldedIndex == std::numeric_limits<uint32_t>::max(); z++)
+                {
+                    for (int64_t y = -1; y <= 1 && weldedIndex == std::numeric_limits<uint32_t>::max(); y++)
+                    {
+                        for (int64_t x = -1; x <= 1 && weldedIndex == std::numeric_limits<uint32_t>::max(); x++)
+                        {
+                            auto neighbour = cells.find({cell.X + x, cell.Y + y, cell.Z + z});
+                            if(neighbour == cells.end())
+                                continue;
+
+                            for (uint32_t candidate : neighbour->second)
+                            {
+                                if(IsWeldable(vertex, weldedVertices[candidate], positionEpsilon, attributeEpsilon))
+                                {
+                                    weldedIndex = candidate;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                if(weldedIndex == std::numeric_limits<uint32_t>::max())
+                {
+                    weldedIndex = static_cast<uint32_t>(weldedVertices.size());
+                    weldedVertices.push_back(vertex);
+                    cells[cell].push_back(weldedIndex);
+                }
+
+                remap[i] = weldedIndex;
+            }
+        }
+
+        for (auto& index : part.Indices)
+        {
+            index = remap[index];
+        }
+
+        part.Vertices = std::move(weldedVertices);
+    }
+
+    void MeshOptimizer::RemoveDegenerateTriangles(Models::TracerMeshPart& part)
+    {
+        size_t writeIndex = 0;
+        for (size_t i = 0; i + 2 < part.Indices.size(); i += 3)
+        {
+            uint32_t i0 = part.Indices[i];
+            uint32_t i1 = part.Indices[i + 1];
+            uint32_t i2 = part.Indices[i + 2];
+
+            if(i0 == i1 || i1 == i2 || i0 == i2)
+                continue;
+
+            const glm::vec3& v0 = part.Vertices[i0].Position;
+            const glm::vec3& v1 = part.Vertices[i1].Position;
+            const glm::vec3& v2 = part.Vertices[i2].Position;
+            glm::vec3 crossProduct = glm::cross(v1 - v0, v2 - v0);
+            if(glm::dot(crossProduct, crossProduct) <= std::numeric_limits<float>::min())
+                continue;
+
+            part.Indices[writeIndex++] = i0;
+            part.Indices[writeIndex++] = i1;
+            part.Indices[writeIndex++] = i2;
+        }
+
+        part.Indices.resize(writeIndex);
+    }
+
+    void MeshOptimizer::OptimizeVertexFetch(Models::TracerMeshPart& part)
+    {
+        const uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(part.Vertices.size(), unassigned);
+        std::vector<Models::TracerVertex> orderedVertices;
+        orderedVertices.reserve(part.Vertices.size());
+
+        for (auto& index : part.Indices)
+        {
+            if(remap[index] == unassigned)
+            {
+                remap[index] = static_cast<uint32_t>(orderedVertices.size());
+                orderedVertices.push_back(part.Vertices[index]);
+            }
+
+            index = remap[index];
+        }
+
+        part.Vertices = std::move(orderedVertices);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Models/TracerMesh.hpp"
+#include "Models/TracerVertex.hpp"
+
+namespace TracerUtils
+{
+    struct MeshOptimizationSettings
+    {
+        bool WeldVertices = true;
+        /// @brief Largest distance in world units between welded positions. Zero welds only bitwise identical vertices.
+        float WeldPositionEpsilon = 0.0f;
+        /// @brief Largest difference per normal and uv component between welded vertices, used when WeldPositionEpsilon is not zero.
+        float WeldAttributeEpsilon = 0.0f;
+        bool RemoveDegenerateTriangles = true;
+        bool OptimizeVertexFetch = true;
+    };
+
+    struct MeshOptimizationStats
+    {
+        size_t VerticesBefore = 0;
+        size_t VerticesAfter = 0;
+        size_t IndicesBefore = 0;
+        size_t IndicesAfter = 0;
+    };
+
+    class MeshOptimizer
+    {
+    public:
+        /// @brief Optimizes all parts of the mesh on the shared worker pool.
+        static MeshOptimizationStats Optimize(Models::TracerMesh& mesh, const MeshOptimizationSettings& settings);
+        static void Optimize(Models::TracerMeshPart& part, const MeshOptimizationSettings& settings);
+
+        /// @brief Merges vertices with equal position, normal and uv and remaps indices.
+        /// With a non zero positionEpsilon vertices closer than it whose attributes differ by at most attributeEpsilon are merged into the first of them.
+        static void WeldVertices(Models::TracerMeshPart& part, float positionEpsilon, float attributeEpsilon);
+
+        /// @brief Removes triangles with repeated indices or zero area.
+        static void RemoveDegenerateTriangles(Models::TracerMeshPart& part);
+
+        /// @brief Reorders vertices in the order they are first referenced by the index buffer and drops unreferenced ones.
+        static void OptimizeVertexFetch(Models::TracerMeshPart& part);
+
+    private:
+        MeshOptimizer() = delete;
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+#include "glm/packing.hpp"
+
+#include "TracerVertex.hpp"
+
+namespace TracerUtils::Models
+{
+    /// @brief Compact GPU vertex layout (24 bytes instead of 48). Mirrors compactVertex in VertexInput.glsl.
+    struct CompactTracerVertex
+    {
+        glm::vec3 Position;
+        // octahedral encoded normal, 2x16 bit snorm
+        uint32_t Normal;
+        // 2x16 bit half floats
+        uint32_t TextureCoordinate;
+        // lower 16 bits material index, upper 16 bits reserved
+        uint32_t MaterialFlag;
+    };
+
+    static_assert(sizeof(CompactTracerVertex) == 24, "CompactTracerVertex must match the std430 layout used in the shaders");
+
+    // largest material index the 16 bits of CompactTracerVertex::MaterialFlag hold
+    static constexpr uint32_t COMPACT_MAX_MATERIAL_INDEX = 0xFFFF;
+
+    inline glm::vec2 OctahedralWrap(const glm::vec2& v)
+    {
+        return (1.0f - glm::abs(glm::vec2(v.y, v.x))) * glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    inline uint32_t EncodeOctahedralNormal(const glm::vec3& normal)
+    {
+        float length = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+        if(length <= 0.0f)
+        {
+            return glm::packSnorm2x16(glm::vec2(0.0f));
+        }
+
+        glm::vec3 n = normal / length;
+        glm::vec2 encoded = n.z >= 0.0f ? glm::vec2(n.x, n.y) : OctahedralWrap(glm::vec2(n.x, n.y));
+        return glm::packSnorm2x16(encoded);
+    }
+
+    inline glm::vec3 DecodeOctahedralNormal(uint32_t packedNormal)
+    {
+        glm::vec2 f = glm::unpackSnorm2x16(packedNormal);
+        glm::vec3 n = glm::vec3(f.x, f.y, 1.0f - glm::abs(f.x) - glm::abs(f.y));
+        float t = glm::clamp(-n.z, 0.0f, 1.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    }
+
+    inline CompactTracerVertex EncodeVertex(const TracerVertex& vertex)
+    {
+        //callers check the range first, see TracerScene::BuildScene
+        assert(vertex.MaterialFlag <= COMPACT_MAX_MATERIAL_INDEX && "Compact vertex format supports up to 65536 materials");
+
+        CompactTracerVertex compact;
+        compact.Position = vertex.Position;
+        compact.Normal = EncodeOctahedralNormal(vertex.Normal);
+        compact.TextureCoordinate = glm::packHalf2x16(vertex.TextureCoordinate);
+        compact.MaterialFlag = vertex.MaterialFlag & 0xFFFF;
+        return compact;
+    }
+
+    inline TracerVertex DecodeVertex(const CompactTracerVertex& compact)
+    {
+        TracerVertex vertex;
+        vertex.Position = compact.Position;
+        vertex.Normal = DecodeOctahedralNormal(compact.Normal);
+        vertex.TextureCoordinate = glm::unpackHalf2x16(compact.TextureCoordinate);
+        vertex.MaterialFlag = compact.MaterialFlag & 0xFFFF;
+        return vertex;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TracerVertex.hpp"
+
+namespace TracerUtils::Models
+{
+    /// @brief On disk layout of the .tmesh container.
+    /// Header, followed by the part table, followed by vertex and index blocks aligned to TracerMeshFileAlignment.
+    /// All offsets are in bytes from the beginning of the file.
+    constexpr uint32_t TracerMeshFileMagic = 0x48534D54; // "TMSH"
+    constexpr uint32_t TracerMeshFileVersion = 1;
+    constexpr uint64_t TracerMeshFileAlignment = 64;
+
+    enum TracerMeshFileFlags : uint32_t
+    {
+        TracerMeshFile_None = 0,
+        // reserved for a prebuilt acceleration structure block, not written yet
+        TracerMeshFile_AccelerationStructure = 1 << 0,
+    };
+
+    struct TracerMeshFileHeader
+    {
+        uint32_t Magic = TracerMeshFileMagic;
+        uint32_t Version = TracerMeshFileVersion;
+        uint32_t Flags = TracerMeshFile_None;
+        uint32_t PartCount = 0;
+        uint32_t VertexStride = sizeof(TracerVertex);
+        uint32_t IndexStride = sizeof(uint32_t);
+        uint64_t PartTableOffset = 0;
+        uint64_t FileSize = 0;
+    };
+
+    struct TracerMeshFilePart
+    {
+        uint64_t VertexOffset = 0;
+        uint64_t VertexCount = 0;
+        uint64_t IndexOffset = 0;
+        uint64_t IndexCount = 0;
+    };
+
+    static_assert(sizeof(TracerMeshFileHeader) == 40, "TracerMeshFileHeader layout changed, bump TracerMeshFileVersion");
+    static_assert(sizeof(TracerMeshFilePart) == 32, "TracerMeshFilePart layout changed, bump TracerMeshFileVersion");
+
+    /// @brief Non owning view over a contiguous array.
+    template<typename T>
+    struct ArrayView
+    {
+        const T* Data = nullptr;
+        size_t Size = 0;
+
+        inline const T* begin() const { return Data; }
+        inline const T* end() const { return Data + Size; }
+        inline const T& operator[](size_t index) const { return Data[index]; }
+        inline size_t SizeInBytes() const { return Size * sizeof(T); }
+    };
+}
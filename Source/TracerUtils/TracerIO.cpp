@@ -1,10 +1,13 @@
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "TracerIO.hpp"
+#include "TracerMeshFile.hpp"
+#include "WorkerPool.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
+#include <chrono>
 
 namespace TracerUtils
 {
@@ -49,33 +52,101 @@ namespace TracerUtils
         stbi_write_png(filePath.c_str(), width, height, channels, image, width * channels);
     }
 
+    void IOHelpers::SaveImageHdr(const std::string &filePath, const float *image, int width, int height, int channels)
+    {
+        stbi_write_hdr(filePath.c_str(), width, height, channels, image);
+    }
+
+    std::string IOHelpers::ToJsonString(const std::string &value)
+    {
+        std::string result = "\"";
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default: result += c; break;
+            }
+        }
+        return result + "\"";
+    }
+
     void IOHelpers::FreeImage(stbi_uc *image)
     {
         stbi_image_free(image);
     }
 
-    Models::TracerMesh IOHelpers::LoadModel(const std::string &filePath)
+    Models::TracerMesh IOHelpers::LoadModel(const std::string &filePath, const MeshOptimizationSettings& optimizationSettings)
     {
-        Models::TracerMesh mesh;
-        Assimp::Importer importer;
+        std::filesystem::path path = ResolveAssetPath(filePath);
+        if(path.extension() == ".tmesh")
+        {
+            auto loadStart = std::chrono::high_resolution_clock::now();
+            auto meshFile = TracerMeshFile::Open(path.string());
+            Models::TracerMesh mesh = meshFile->ToMesh();
+            auto loadEnd = std::chrono::high_resolution_clock::now();
+
+            std::cout << "Loaded model: " << filePath << " with " << mesh.Parts.size() << " meshes (tmesh, " 
+                << meshFile->GetHeader().FileSize / 1024 << " KB in " << std::chrono::duration<float, std::milli>(loadEnd - loadStart).count() << " ms)" << std::endl;
+            return mesh;
+        }
+
+        return ImportModel(path, optimizationSettings);
+    }
 
+    void IOHelpers::ConvertModel(const std::string& sourcePath, const std::string& destinationPath, const MeshOptimizationSettings& optimizationSettings)
+    {
+        Models::TracerMesh mesh = ImportModel(ResolveAssetPath(sourcePath), optimizationSettings);
+        TracerMeshFile::Export(mesh, destinationPath);
+        std::cout << "Converted model: " << sourcePath << " -> " << destinationPath << std::endl;
+    }
+
+    std::filesystem::path IOHelpers::ResolveAssetPath(const std::string& filePath)
+    {
         std::filesystem::path path = filePath;
         if(!path.is_absolute())
         {
-            path = (_assetFolder / filePath).string();
+            path = _assetFolder / filePath;
         }
-        
+
+        return path;
+    }
+
+    Models::TracerMesh IOHelpers::ImportModel(const std::filesystem::path& path, const MeshOptimizationSettings& optimizationSettings)
+    {
+        Models::TracerMesh mesh;
+        Assimp::Importer importer;
+
+        auto parseStart = std::chrono::high_resolution_clock::now();
         const aiScene* scene = importer.ReadFile(path.string(), aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
+        if(scene == nullptr || scene->mRootNode == nullptr)
+        {
+            throw std::runtime_error("failed to load model: " + path.string() + " " + importer.GetErrorString());
+        }
 
         std::vector<const aiMesh*> meshes;
         VisitNode(scene->mRootNode, scene, &meshes);
-        std::cout << "Loaded model: " << filePath << " with " << meshes.size() << " meshes" << std::endl;
-        for (size_t i = 0; i < meshes.size(); i++)
-        {
-            ImportMesh(meshes[i], mesh);
-        }
+        std::cout << "Loaded model: " << path.string() << " with " << meshes.size() << " meshes" << std::endl;
+
+        auto convertStart = std::chrono::high_resolution_clock::now();
+        mesh.Parts.resize(meshes.size());
+        WorkerPool::GetShared().ParallelFor(meshes.size(), [&](size_t i) { ImportMesh(meshes[i], mesh.Parts[i]); });
 
         importer.FreeScene();
+
+        auto optimizeStart = std::chrono::high_resolution_clock::now();
+        MeshOptimizationStats stats = MeshOptimizer::Optimize(mesh, optimizationSettings);
+        auto optimizeEnd = std::chrono::high_resolution_clock::now();
+
+        std::cout << "Mesh optimization: vertices " << stats.VerticesBefore << " -> " << stats.VerticesAfter
+            << ", indices " << stats.IndicesBefore << " -> " << stats.IndicesAfter << std::endl;
+        std::cout << "Model import timings: parse " << std::chrono::duration<float, std::milli>(convertStart - parseStart).count()
+            << " ms, conversion " << std::chrono::duration<float, std::milli>(optimizeStart - convertStart).count()
+            << " ms, post-process " << std::chrono::duration<float, std::milli>(optimizeEnd - optimizeStart).count() << " ms" << std::endl;
+
         return mesh;
     }
 
@@ -93,30 +164,32 @@ namespace TracerUtils
         }
     }
 
-    void IOHelpers::ImportMesh(const aiMesh* mesh, Models::TracerMesh& tracerMesh)
+    void IOHelpers::ImportMesh(const aiMesh* mesh, Models::TracerMeshPart& part)
     {
-        Models::TracerMeshPart part;
+        part.Vertices.resize(mesh->mNumVertices);
         for (size_t i = 0; i < mesh->mNumVertices; i++)
         {
-            Models::TracerVertex vertex;
+            Models::TracerVertex& vertex = part.Vertices[i];
             vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
-            vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+            vertex.Normal = mesh->HasNormals() ? glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z) : glm::vec3(0.0f);
             vertex.MaterialFlag = 1;
             //TODO fix texture import
             //vertex.TextureCoordinate = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y); 
-
-            part.Vertices.push_back(vertex);
         }
 
+        // After aiProcess_Triangulate faces are triangles, points or lines. Only triangles are kept.
+        part.Indices.resize(static_cast<size_t>(mesh->mNumFaces) * 3);
+        uint32_t* indices = part.Indices.data();
         for (size_t i = 0; i < mesh->mNumFaces; i++)
         {
-            auto face = mesh->mFaces[i];
-            for (size_t j = 0; j < face.mNumIndices; j++)
-            {
-                part.Indices.push_back(face.mIndices[j]);
-            }
+            const aiFace& face = mesh->mFaces[i];
+            if(face.mNumIndices != 3)
+                continue;
+
+            memcpy(indices, face.mIndices, sizeof(uint32_t) * 3);
+            indices += 3;
         }
 
-        tracerMesh.Parts.push_back(part);
+        part.Indices.resize(indices - part.Indices.data());
     }
 }
\ No newline at end of file
@@ -4,11 +4,13 @@
 #include <memory>
 #include <vector>
 #include <filesystem>
+#include <functional>
 #include <stb_image.h>
 #include <stb_image_write.h>
 
 #include "Models/TracerMesh.hpp"
 #include "Models/TracerVertex.hpp"
+#include "MeshOptimizer.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -24,15 +26,24 @@ namespace TracerUtils
         
         static stbi_uc* LoadImage(const std::string& filePath, int* width, int* height, int* channels, bool useAlphaChannel);
         static void SaveImage(const std::string& filePath, stbi_uc* image, int width, int height, int channels);
+        /// @brief Writes unclamped float channels as a Radiance .hdr file.
+        static void SaveImageHdr(const std::string& filePath, const float* image, int width, int height, int channels);
         static void FreeImage(stbi_uc* image);
-        static Models::TracerMesh LoadModel(const std::string& filePath);
+        static Models::TracerMesh LoadModel(const std::string& filePath, const MeshOptimizationSettings& optimizationSettings = {});
+        /// @brief Imports any Assimp supported model and writes it as a .tmesh file.
+        static void ConvertModel(const std::string& sourcePath, const std::string& destinationPath, const MeshOptimizationSettings& optimizationSettings = {});
+
+        /// @brief Returns value as a quoted JSON string.
+        static std::string ToJsonString(const std::string& value);
 
         static inline void SetAssetFolder(const std::string& assetFolderPath) { _assetFolder = assetFolderPath; };
 
     private:
         static inline std::filesystem::path _assetFolder;
 
+        static std::filesystem::path ResolveAssetPath(const std::string& filePath);
+        static Models::TracerMesh ImportModel(const std::filesystem::path& path, const MeshOptimizationSettings& optimizationSettings);
         static void VisitNode(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>* meshes);
-        static void ImportMesh(const aiMesh* mesh, Models::TracerMesh& tracerMesh);
+        static void ImportMesh(const aiMesh* mesh, Models::TracerMeshPart& part);
     };
 }
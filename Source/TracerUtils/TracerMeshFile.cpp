@@ -0,0 +1,157 @@
+#include "TracerMeshFile.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace TracerUtils
+{
+    namespace
+    {
+        uint64_t AlignOffset(uint64_t offset)
+        {
+            return (offset + Models::TracerMeshFileAlignment - 1) & ~(Models::TracerMeshFileAlignment - 1);
+        }
+
+        // counts come from the file, dividing the remaining size instead of multiplying the count can not wrap
+        bool IsBlockInFile(uint64_t offset, uint64_t count, uint64_t stride, uint64_t fileSize)
+        {
+            return offset <= fileSize && count <= (fileSize - offset) / stride && offset % Models::TracerMeshFileAlignment == 0;
+        }
+    }
+
+    TracerMeshFile::TracerMeshFile(std::unique_ptr<MappedFile> file) : 
+        _file(std::move(file))
+    {
+        _header = reinterpret_cast<const Models::TracerMeshFileHeader*>(_file->GetData());
+        _parts = reinterpret_cast<const Models::TracerMeshFilePart*>(_file->GetData() + _header->PartTableOffset);
+    }
+
+    std::unique_ptr<TracerMeshFile> TracerMeshFile::Open(const std::string& filePath)
+    {
+        auto file = MappedFile::Open(filePath);
+        if(file->GetSize() < sizeof(Models::TracerMeshFileHeader))
+        {
+            throw std::runtime_error("failed to load tmesh, file is too small: " + filePath);
+        }
+
+        const auto* header = reinterpret_cast<const Models::TracerMeshFileHeader*>(file->GetData());
+        if(header->Magic != Models::TracerMeshFileMagic || header->Version != Models::TracerMeshFileVersion)
+        {
+            throw std::runtime_error("failed to load tmesh, unsupported header: " + filePath);
+        }
+
+        if(header->VertexStride != sizeof(Models::TracerVertex) || header->IndexStride != sizeof(uint32_t))
+        {
+            throw std::runtime_error("failed to load tmesh, vertex layout mismatch: " + filePath);
+        }
+
+        uint64_t fileSize = file->GetSize();
+        if(header->FileSize != fileSize || 
+            !IsBlockInFile(header->PartTableOffset, header->PartCount, sizeof(Models::TracerMeshFilePart), fileSize))
+        {
+            throw std::runtime_error("failed to load tmesh, file is truncated: " + filePath);
+        }
+
+        const auto* parts = reinterpret_cast<const Models::TracerMeshFilePart*>(file->GetData() + header->PartTableOffset);
+        for (uint32_t i = 0; i < header->PartCount; i++)
+        {
+            if(!IsBlockInFile(parts[i].VertexOffset, parts[i].VertexCount, header->VertexStride, fileSize) ||
+                !IsBlockInFile(parts[i].IndexOffset, parts[i].IndexCount, header->IndexStride, fileSize))
+            {
+                throw std::runtime_error("failed to load tmesh, part block is out of range: " + filePath);
+            }
+        }
+
+        return std::unique_ptr<TracerMeshFile>(new TracerMeshFile(std::move(file)));
+    }
+
+    void TracerMeshFile::Export(const Models::TracerMesh& mesh, const std::string& filePath)
+    {
+        Models::TracerMeshFileHeader header;
+        header.PartCount = static_cast<uint32_t>(mesh.Parts.size());
+        header.PartTableOffset = AlignOffset(sizeof(Models::TracerMeshFileHeader));
+
+        std::vector<Models::TracerMeshFilePart> parts(mesh.Parts.size());
+        uint64_t offset = AlignOffset(header.PartTableOffset + sizeof(Models::TracerMeshFilePart) * parts.size());
+        for (size_t i = 0; i < mesh.Parts.size(); i++)
+        {
+            parts[i].VertexOffset = offset;
+            parts[i].VertexCount = mesh.Parts[i].Vertices.size();
+            offset = AlignOffset(offset + parts[i].VertexCount * sizeof(Models::TracerVertex));
+
+            parts[i].IndexOffset = offset;
+            parts[i].IndexCount = mesh.Parts[i].Indices.size();
+            offset = AlignOffset(offset + parts[i].IndexCount * sizeof(uint32_t));
+        }
+
+        header.FileSize = offset;
+
+        std::ofstream file{filePath, std::ios::binary | std::ios::trunc};
+        if(!file.is_open())
+        {
+            throw std::runtime_error("failed to open file for writing: " + filePath);
+        }
+
+        const char padding[Models::TracerMeshFileAlignment] = {};
+        auto writeBlock = [&](uint64_t blockOffset, const void* data, size_t size)
+        {
+            uint64_t position = static_cast<uint64_t>(file.tellp());
+            file.write(padding, blockOffset - position);
+            file.write(static_cast<const char*>(data), size);
+        };
+
+        writeBlock(0, &header, sizeof(header));
+        writeBlock(header.PartTableOffset, parts.data(), sizeof(Models::TracerMeshFilePart) * parts.size());
+        for (size_t i = 0; i < mesh.Parts.size(); i++)
+        {
+            writeBlock(parts[i].VertexOffset, mesh.Parts[i].Vertices.data(), sizeof(Models::TracerVertex) * mesh.Parts[i].Vertices.size());
+            writeBlock(parts[i].IndexOffset, mesh.Parts[i].Indices.data(), sizeof(uint32_t) * mesh.Parts[i].Indices.size());
+        }
+
+        writeBlock(header.FileSize, nullptr, 0);
+
+        if(!file.good())
+        {
+            throw std::runtime_error("failed to write tmesh: " + filePath);
+        }
+    }
+
+    Models::ArrayView<Models::TracerVertex> TracerMeshFile::GetVertices(uint32_t partIndex) const
+    {
+        const auto& part = _parts[partIndex];
+        return { reinterpret_cast<const Models::TracerVertex*>(_file->GetData() + part.VertexOffset), static_cast<size_t>(part.VertexCount) };
+    }
+
+    Models::ArrayView<uint32_t> TracerMeshFile::GetIndices(uint32_t partIndex) const
+    {
+        const auto& part = _parts[partIndex];
+        return { reinterpret_cast<const uint32_t*>(_file->GetData() + part.IndexOffset), static_cast<size_t>(part.IndexCount) };
+    }
+
+    Models::TracerMesh TracerMeshFile::ToMesh() const
+    {
+        Models::TracerMesh mesh;
+        mesh.Parts.resize(GetPartCount());
+        for (uint32_t i = 0; i < GetPartCount(); i++)
+        {
+            auto vertices = GetVertices(i);
+            auto indices = GetIndices(i);
+            mesh.Parts[i].Vertices.assign(vertices.begin(), vertices.end());
+            mesh.Parts[i].Indices.assign(indices.begin(), indices.end());
+
+            //acceleration structure builds and the shaders index the vertices without bounds checks
+            for (uint32_t index : mesh.Parts[i].Indices)
+            {
+                if(index >= vertices.Size)
+                {
+                    throw std::runtime_error("failed to load tmesh, part " + std::to_string(i) + " references vertex " + std::to_string(index) + " of " + std::to_string(vertices.Size) + "!");
+                }
+            }
+        }
+
+        return mesh;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "MappedFile.hpp"
+#include "Models/TracerMesh.hpp"
+#include "Models/TracerMeshFile.hpp"
+
+namespace TracerUtils
+{
+    /// @brief Memory mapped .tmesh file. Vertex and index views point straight into the mapping.
+    class TracerMeshFile
+    {
+    public:
+        TracerMeshFile(const TracerMeshFile&) = delete;
+        TracerMeshFile &operator=(const TracerMeshFile&) = delete;
+
+        static std::unique_ptr<TracerMeshFile> Open(const std::string& filePath);
+        static void Export(const Models::TracerMesh& mesh, const std::string& filePath);
+
+        inline const Models::TracerMeshFileHeader& GetHeader() const { return *_header; }
+        inline uint32_t GetPartCount() const { return _header->PartCount; }
+
+        Models::ArrayView<Models::TracerVertex> GetVertices(uint32_t partIndex) const;
+        Models::ArrayView<uint32_t> GetIndices(uint32_t partIndex) const;
+
+        /// @brief Copies every part into an owning TracerMesh, one memcpy per block.
+        /// Throws when an index references a vertex outside its part, the views above are not checked.
+        Models::TracerMesh ToMesh() const;
+
+    private:
+        TracerMeshFile(std::unique_ptr<MappedFile> file);
+
+        std::unique_ptr<MappedFile> _file;
+        const Models::TracerMeshFileHeader* _header;
+        const Models::TracerMeshFilePart* _parts;
+    };
+}
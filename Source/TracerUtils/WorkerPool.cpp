@@ -0,0 +1,102 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+
+namespace TracerUtils
+{
+    WorkerPool& WorkerPool::GetShared()
+    {
+        static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    WorkerPool::WorkerPool(size_t workerCount)
+    {
+        _workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++)
+        {
+            _workers.emplace_back(&WorkerPool::WorkerLoop, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _jobStarted.notify_all();
+
+        for (auto& worker : _workers)
+        {
+            worker.join();
+        }
+    }
+
+    void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& func)
+    {
+        if(_workers.empty() || count <= 1)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                func(i);
+            }
+
+            return;
+        }
+
+        std::lock_guard<std::mutex> jobLock(_jobMutex);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _func = &func;
+            _count = count;
+            _nextIndex = 0;
+            _busyWorkers = _workers.size();
+            _jobGeneration++;
+        }
+        _jobStarted.notify_all();
+
+        RunJob(func, count);
+
+        //every worker takes part in every job, so the fields are not reused while one still reads them
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobFinished.wait(lock, [&]() { return _busyWorkers == 0; });
+        _func = nullptr;
+    }
+
+    void WorkerPool::WorkerLoop()
+    {
+        uint64_t finishedGeneration = 0;
+        while (true)
+        {
+            const std::function<void(size_t)>* func;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _jobStarted.wait(lock, [&]() { return _stop || _jobGeneration != finishedGeneration; });
+                if(_stop)
+                    return;
+
+                finishedGeneration = _jobGeneration;
+                func = _func;
+                count = _count;
+            }
+
+            RunJob(*func, count);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(--_busyWorkers == 0)
+            {
+                _jobFinished.notify_one();
+            }
+        }
+    }
+
+    void WorkerPool::RunJob(const std::function<void(size_t)>& func, size_t count)
+    {
+        for (size_t i = _nextIndex++; i < count; i = _nextIndex++)
+        {
+            func(i);
+        }
+    }
+}
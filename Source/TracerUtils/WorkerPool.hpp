@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TracerUtils
+{
+    /// @brief Fixed set of worker threads that run ParallelFor jobs, created once instead of per job.
+    class WorkerPool
+    {
+    public:
+        /// @brief Pool with one worker less than the hardware threads, the calling thread works as well.
+        static WorkerPool& GetShared();
+
+        explicit WorkerPool(size_t workerCount);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool &operator=(const WorkerPool&) = delete;
+
+        /// @brief Runs func for every index in [0, count) on the workers and the calling thread, returns when all are done.
+        void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+    private:
+        void WorkerLoop();
+        void RunJob(const std::function<void(size_t)>& func, size_t count);
+
+        std::vector<std::thread> _workers;
+
+        // one job at a time, the job fields below belong to it
+        std::mutex _jobMutex;
+        std::mutex _mutex;
+        std::condition_variable _jobStarted;
+        std::condition_variable _jobFinished;
+        const std::function<void(size_t)>* _func = nullptr;
+        size_t _count = 0;
+        std::atomic<size_t> _nextIndex = 0;
+        uint64_t _jobGeneration = 0;
+        size_t _busyWorkers = 0;
+        bool _stop = false;
+    };
+}